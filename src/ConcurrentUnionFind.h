@@ -0,0 +1,74 @@
+/*
+ * ConcurrentUnionFind.h
+ *
+ * An equivalence relation on 0..n-1 that many threads can join at once, in
+ * place of equiv_rel where the joins are found in parallel.
+ */
+
+#ifndef CONCURRENTUNIONFIND_H_
+#define CONCURRENTUNIONFIND_H_
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+// Lock-free union-find.  Each class is a tree whose root is its smallest
+// member: join() hangs the larger root under the smaller with a
+// compare-and-swap, and retries if another thread got there first.  find()
+// halves the path it walks, racing harmlessly with other finds, since every
+// pointer it writes still leads to the root.  The result of a set of joins
+// doesn't depend on their order or interleaving.
+class ConcurrentUnionFind
+{
+public:
+    explicit ConcurrentUnionFind( int n ) : mParent(n)
+    {
+        #pragma omp parallel for
+        for ( int i = 0; i < n; ++i )
+            mParent[i].store(i,std::memory_order_relaxed);
+    }
+
+    ConcurrentUnionFind( ConcurrentUnionFind const& ) = delete;
+    ConcurrentUnionFind& operator=( ConcurrentUnionFind const& ) = delete;
+
+    int size() const { return mParent.size(); }
+
+    int find( int x )
+    {
+        int parent = mParent[x].load(std::memory_order_relaxed);
+        while ( parent != x )
+        {
+            int grandparent = mParent[parent].load(std::memory_order_relaxed);
+            if ( grandparent != parent )
+                mParent[x].compare_exchange_weak(parent,grandparent,
+                                                 std::memory_order_relaxed);
+            x = parent;
+            parent = mParent[x].load(std::memory_order_relaxed);
+        }
+        return x;
+    }
+
+    void join( int x, int y )
+    {
+        while ( true )
+        {
+            x = find(x);
+            y = find(y);
+            if ( x == y )
+                return;
+            if ( x < y )
+                std::swap(x,y);
+            int expected = x;
+            if ( mParent[x].compare_exchange_strong(expected,y,
+                                                    std::memory_order_acq_rel) )
+                return;
+        }
+    }
+
+    bool equiv( int x, int y ) { return find(x) == find(y); }
+
+private:
+    std::vector<std::atomic<int>> mParent;
+};
+
+#endif /* CONCURRENTUNIONFIND_H_ */
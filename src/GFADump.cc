@@ -6,7 +6,8 @@
 #include "GFADump.h"
 
 void GFADump (std::string filename, const HyperBasevector &hb, const vec<int> &inv, const
-ReadPathVec &paths, const int MAX_CELL_PATHS, const int MAX_DEPTH, bool find_lines){
+ReadPathVec &paths, const int MAX_CELL_PATHS, const int MAX_DEPTH, bool find_lines,
+const vec<vec<vec<vec<int>>>> * precomputed_lines){
 
     std::vector<std::string> colour_names={
             "aliceblue",
@@ -151,15 +152,17 @@ ReadPathVec &paths, const int MAX_CELL_PATHS, const int MAX_DEPTH, bool find_lin
     };
     std::cout<<std::endl<<std::endl<<std::endl<<"============GFA DUMP STARTING============"<<std::endl;
     std::cout<<"Graph has "<< hb.EdgeObjectCount() <<" edges"<<std::endl;
-    vec<vec<vec<vec<int>>>> lines;
+    vec<vec<vec<vec<int>>>> found_lines;
     vec<int> to_left, to_right;
     hb.ToLeft(to_left), hb.ToRight(to_right);
     std::vector<int64_t> colour(hb.EdgeObjectCount(), -1);
 
     if (find_lines) {
         Ofstream(gfa_out, filename + "_lines.gfa");
-        FindLines(hb, inv, lines, MAX_CELL_PATHS, MAX_DEPTH);
-        SortLines(lines, hb, inv);
+        if (precomputed_lines==NULL) FindLines(hb, inv, found_lines, MAX_CELL_PATHS, MAX_DEPTH);
+        const vec<vec<vec<vec<int>>>> &lines = (precomputed_lines!=NULL ? *precomputed_lines : found_lines);
+        vec<int> line_order;
+        SortedLineOrder(lines, hb, inv, line_order);
 
 
         gfa_out << "H\tVN:Z:1.0" << std::endl;
@@ -168,11 +171,12 @@ ReadPathVec &paths, const int MAX_CELL_PATHS, const int MAX_DEPTH, bool find_lin
         int64_t current_colour = 1;
         //TODO: Dump the overlaps correctly
         //First step, mark Edges as used if they appear in a line
-        for (auto line : lines) {
+        for (auto li : line_order) {
+            const vec<vec<vec<int>>> &line = lines[li];
             std::vector<std::pair<uint64_t, bool>> prev_segment_end_edges;
-            for (auto segment : line) {//or cell, or bubble
+            for (auto const &segment : line) {//or cell, or bubble
                 std::vector<std::pair<uint64_t, bool>> end_edges;
-                for (auto path : segment) {//or unitig?-ish
+                for (auto const &path : segment) {//or unitig?-ish
                     if (path.empty()) {//empty path (i.e., gap!)
                         end_edges = prev_segment_end_edges;//HACK to not disconnect
                     }
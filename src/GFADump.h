@@ -5,7 +5,11 @@
 #ifndef W2RAP_CONTIGGER_GFADUMP_H
 #define W2RAP_CONTIGGER_GFADUMP_H
 
+// If precomputed_lines is given (e.g. the lines found for the same graph in step
+// 6 or by FinalFiles), they are used instead of calling FindLines again.
+
 void GFADump (std::string filename, const HyperBasevector &hb, const vec<int> &inv, const
-ReadPathVec &paths, const int MAX_CELL_PATHS, const int MAX_DEPTH, bool find_lines);
+ReadPathVec &paths, const int MAX_CELL_PATHS, const int MAX_DEPTH, bool find_lines,
+const vec<vec<vec<vec<int>>>> * precomputed_lines = NULL);
 
 #endif //W2RAP_CONTIGGER_GFADUMP_H
@@ -250,97 +250,121 @@ bool BAMbuf::readBlock()
 #endif
 
 // a streambuf that grabs the next decompressed BGZF block on underflow.
-// this version uses one thread to unzip while the main thread reads aligns.
-// it appears that unzipping is just a bit slower than processing aligns.
+// a helper thread reads the file a batch of blocks at a time, and unzips the
+// blocks of each batch in parallel while the main thread reads the aligns in
+// the previous batch.  unzipping one block at a time on one thread was the
+// bottleneck.
 class BAMbuf : public std::streambuf
 {
 public:
     BAMbuf( String const& bamFile )
     : mFR(bamFile), mBlockNo(0), mBufAvailable(mLock), mBufConsumed(mLock),
-      mBeg(nullptr), mNext(nullptr), mEnd(nullptr), mQuit(false),
+      mpCur(nullptr), mCurBlock(0), mpReady(nullptr), mQuit(false),
       mUnzipThread([this](){unzipBlocks();})
-    { char* end = &mInfBuf[0].back(); setg(&mInfBuf[0].front(),end,end); }
+    { static char dummy[2]; setg(dummy,dummy+1,dummy+1); }
 
     BAMbuf( BAMbuf const& )=delete;
 
     ~BAMbuf()
     { if ( true )
-      { Locker locker(mLock); mQuit = true; mBeg = nullptr; }
+      { Locker locker(mLock); mQuit = true; mpReady = nullptr; }
       mBufConsumed.signal(); mUnzipThread.join(); }
 
     BAMbuf& operator=( BAMbuf const& )=delete;
 
 private:
+    static size_t const FIL_BUF_SIZ = 64*1024ul;
+    static size_t const INF_BUF_SIZ = 256*1024ul;
+    static size_t const BATCH_BLOCKS = 64;
+
+    // a batch of blocks.  block i of the file data is at mFil[i*FIL_BUF_SIZ],
+    // and unzips to mInf[i*INF_BUF_SIZ+1], leaving a byte for putback.
+    struct Batch
+    {
+        Batch() : mFil(BATCH_BLOCKS*FIL_BUF_SIZ), mInf(BATCH_BLOCKS*INF_BUF_SIZ),
+                  mBeg(BATCH_BLOCKS), mEnd(BATCH_BLOCKS), mInfLen(BATCH_BLOCKS),
+                  mBlockNo(BATCH_BLOCKS), mNBlocks(0) {}
+
+        std::vector<char> mFil;
+        std::vector<char> mInf;
+        std::vector<size_t> mBeg; // start of deflated data in block
+        std::vector<size_t> mEnd; // end of deflated data in block
+        std::vector<size_t> mInfLen;
+        std::vector<size_t> mBlockNo; // for error messages
+        size_t mNBlocks; // 0 at end of file
+    };
+
     int_type underflow() override;
     void unzipBlocks();
-    bool offerBuf( char* beg, char* next, char* end )
+    bool readBatch( Batch& batch );
+    void unzipBatch( Batch& batch );
+    bool offerBatch( Batch* pBatch )
     {
         Locker locker(mLock);
-        while ( mBeg )
+        while ( mpReady )
             locker.wait(mBufConsumed);
         if ( mQuit )
             return true;
-        mNext = next;
-        mEnd = end;
-        mBeg = beg;
+        mpReady = pBatch;
         return false;
     }
 
-    static size_t const FIL_BUF_SIZ = 64*1024ul;
-    static size_t const INF_BUF_SIZ = 256*1024ul;
-
     FileReader mFR;
     size_t mBlockNo;
-    std::array<char,FIL_BUF_SIZ> mFilBuf;
-    std::array<char,INF_BUF_SIZ> mInfBuf[3];
+    Batch mBatch[3];
     LockedData mLock;
     Condition mBufAvailable;
     Condition mBufConsumed;
-    char* mBeg;
-    char* mNext;
-    char* mEnd;
+    Batch* mpCur;
+    size_t mCurBlock;
+    Batch* mpReady;
     bool mQuit;
     std::thread mUnzipThread;
 };
 
 std::streambuf::int_type BAMbuf::underflow()
 {
-    if ( gptr() == egptr() )
+    while ( gptr() == egptr() )
     {
         char putBackChr = gptr()[-1];
-        if ( true )
+        if ( !mpCur || mCurBlock == mpCur->mNBlocks )
         {
-            Locker locker(mLock);
-            while ( !mBeg )
-                locker.wait(mBufAvailable);
-            if ( mNext == mEnd )
+            if ( mpCur && !mpCur->mNBlocks )
+                return traits_type::eof();
+            if ( true )
+            {
+                Locker locker(mLock);
+                while ( !mpReady )
+                    locker.wait(mBufAvailable);
+                mpCur = mpReady;
+                mpReady = nullptr;
+            }
+            mBufConsumed.signal();
+            mCurBlock = 0;
+            if ( !mpCur->mNBlocks )
                 return traits_type::eof();
-            setg(mBeg,mNext,mEnd);
-            mBeg = nullptr;
         }
-        mBufConsumed.signal();
+        char* beg = &mpCur->mInf[mCurBlock*INF_BUF_SIZ];
+        setg(beg,beg+1,beg+1+mpCur->mInfLen[mCurBlock]);
+        ++mCurBlock;
         *eback() = putBackChr;
     }
     return traits_type::to_int_type(*gptr());
 }
 
-void BAMbuf::unzipBlocks()
+// read up to BATCH_BLOCKS blocks, checking their headers.
+// returns false if there are none left.
+bool BAMbuf::readBatch( Batch& batch )
 {
-    size_t bufId = 0;
-    while ( true )
+    batch.mNBlocks = 0;
+    while ( batch.mNBlocks < BATCH_BLOCKS )
     {
-        char* infBuf = &mInfBuf[bufId].front();
         size_t nRead;
-        char* filBuf = &mFilBuf.front();
+        char* filBuf = &batch.mFil[batch.mNBlocks*FIL_BUF_SIZ];
         GZipHeader const& hdr = *reinterpret_cast<GZipHeader*>(filBuf);
         if ( (nRead = mFR.readSome(filBuf,sizeof(hdr))) != sizeof(hdr) )
         {
-            if ( !nRead )
-            {
-                if ( !offerBuf(infBuf,infBuf,infBuf) )
-                    mBufAvailable.signal();
-                break;
-            }
+            if ( !nRead ) break;
             BAMERR(mFR.getFilename(),
                     " is corrupt.  Partial GZIP header at block " << mBlockNo+1);
         }
@@ -364,14 +388,30 @@ void BAMbuf::unzipBlocks()
         else if ( itr > end )
             BAMERR(mFR.getFilename(),
                     " has bogus block length at block " << mBlockNo);
+        batch.mBeg[batch.mNBlocks] = itr - filBuf;
+        batch.mEnd[batch.mNBlocks] = end - filBuf;
+        batch.mBlockNo[batch.mNBlocks] = mBlockNo;
+        batch.mNBlocks += 1;
+    }
+    return batch.mNBlocks;
+}
 
+void BAMbuf::unzipBatch( Batch& batch )
+{
+    std::vector<char> bad(batch.mNBlocks,false);
+    #pragma omp parallel for schedule(dynamic)
+    for ( size_t blk = 0; blk < batch.mNBlocks; ++blk )
+    {
+        char* filBuf = &batch.mFil[blk*FIL_BUF_SIZ];
+        char* infBuf = &batch.mInf[blk*INF_BUF_SIZ];
+        char* end = filBuf + batch.mEnd[blk];
         z_stream zs;
         zs.zalloc = nullptr;
         zs.zfree = nullptr;
         zs.opaque = nullptr;
         zs.data_type = Z_BINARY;
-        zs.next_in = reinterpret_cast<uint8_t*>(itr);
-        zs.avail_in = end-itr;
+        zs.next_in = reinterpret_cast<uint8_t*>(filBuf+batch.mBeg[blk]);
+        zs.avail_in = batch.mEnd[blk]-batch.mBeg[blk];
         zs.next_out = reinterpret_cast<uint8_t*>(infBuf+1);
         zs.avail_out = INF_BUF_SIZ-1;
 
@@ -380,16 +420,29 @@ void BAMbuf::unzipBlocks()
                 ::inflateEnd(&zs) != Z_OK ||
                 GZipFooter(end) != GZipFooter(zs) ||
                 zs.avail_in )
+            bad[blk] = true;
+        batch.mInfLen[blk] = zs.total_out;
+    }
+
+    for ( size_t blk = 0; blk < batch.mNBlocks; ++blk )
+        if ( bad[blk] )
             BAMERR(mFR.getFilename(),
-                    " can't be unzipped at block " << mBlockNo);
+                    " can't be unzipped at block " << batch.mBlockNo[blk]);
+}
 
-        if ( zs.total_out )
-        {
-            char* next = reinterpret_cast<char*>(zs.next_out-zs.total_out);
-            if ( offerBuf(infBuf,next,next+zs.total_out) ) break;
-            mBufAvailable.signal();
-            if ( ++bufId == 3 ) bufId = 0;
-        }
+void BAMbuf::unzipBlocks()
+{
+    size_t bufId = 0;
+    while ( true )
+    {
+        Batch& batch = mBatch[bufId];
+        bool more = readBatch(batch);
+        if ( more )
+            unzipBatch(batch);
+        if ( offerBatch(&batch) ) break;
+        mBufAvailable.signal();
+        if ( !more ) break;
+        if ( ++bufId == 3 ) bufId = 0;
     }
 }
 
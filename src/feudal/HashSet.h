@@ -19,6 +19,7 @@
 #include "feudal/Iterator.h"
 #include "math/PowerOf2.h"
 #include "system/Assert.h"
+#include "system/HugePages.h"
 #include "system/SpinLockedData.h"
 #include "system/WorklistN.h"
 #include <algorithm>
@@ -26,11 +27,15 @@
 #include <cstddef>
 #include <cstring>
 #include <functional>
+#include <new>
+#include <omp.h>
 #include <utility>
+#include <vector>
 
 /// Hopscotch hash set needs an abstract way of producing an array of values
 /// that can be used when T doesn't have a default constructor.
 /// This implementation is for the simple case where you can use new and delete.
+/// Big arrays are put on huge pages if that's been asked for.
 template <class T>
 class TFactory
 {
@@ -38,8 +43,15 @@ public:
     template <class X>
     std::allocator<X> alloc(X*) const { return std::allocator<X>(); }
 
-    T* create( size_t nTs ) const { return new T[nTs]; }
-    void destroy( T* pTs, size_t nTs ) const { delete [] pTs; }
+    // the advice has to come before the constructors touch the pages
+    T* create( size_t nTs ) const
+    { T* pTs = static_cast<T*>(::operator new(nTs*sizeof(T)));
+      HugePages::advise(pTs,nTs*sizeof(T));
+      for ( T* pT = pTs; pT != pTs+nTs; ++pT ) new (pT) T;
+      return pTs; }
+    void destroy( T* pTs, size_t nTs ) const
+    { for ( T* pT = pTs; pT != pTs+nTs; ++pT ) pT->~T();
+      ::operator delete(pTs); }
 };
 
 // Ignore this little helper class.
@@ -294,6 +306,12 @@ protected:
     const_pointer lookup( key_type val, size_t hash ) const
     { return find(val,hash%capacity()); }
 
+    // start fetching the home slot of a value with this hash
+    void prefetch( size_t hash ) const
+    { size_type offset = hash%capacity();
+      __builtin_prefetch(mBktInfo+offset);
+      __builtin_prefetch(mBuckets+offset); }
+
     template <class Comp>
     const_pointer lookup( key_type val, size_t hash, Comp const& comp ) const
     { // Check home slot.
@@ -683,6 +701,15 @@ public:
     const_pointer lookup( size_t hash, key_type val, Comp const& comp ) const
     { return findHHSC(hash)->lookup(val,hash,comp); }
 
+    /// As above, for a value whose hash is already known.
+    const_pointer lookup( size_t hash, key_type val ) const
+    { return findHHSC(hash)->lookup(val,hash); }
+
+    /// Starts pulling the slot for a value with this hash into cache, so that
+    /// a lookup a little later doesn't stall.  Same rules as lookup.
+    void prefetch( size_t hash ) const
+    { findHHSC(hash)->prefetch(hash); }
+
     /// Returns true if the value was added (otherwise, it was already present).
     bool add( key_type val )
     { size_t hash = mHCF.hash(val);
@@ -732,6 +759,43 @@ public:
       { try  { pHHS->insertV(val,hash); pHHS->unlock(); break; }
         catch ( NoRoomException const& ) { pHHS = split(hash); } } }
 
+    /// Specialized inserter:  Inserts the values that gen(idx,val) produces for
+    /// each idx in [0,nnn), skipping those for which it returns false.  The
+    /// values must be novel and distinct, as for insertUniqueValue.  The work
+    /// is done by all threads, a block of values at a time:  each thread takes
+    /// the values that hash to its own range of the HopscotchHashSets, so the
+    /// threads mostly keep to their own parts of the table.  A split during a
+    /// block can move values out of the range they were assigned, so inserts
+    /// still take the lock.  Call it from outside any parallel region, with
+    /// no other writers:  a nested region would get just one thread, so from
+    /// inside one the values are simply inserted by the calling thread.
+    template <class Gen>
+    void insertUniqueValues( size_t nnn, Gen gen, size_t blockSize = 1ul<<22 )
+    { if ( omp_in_parallel() )
+      { value_type val;
+        for ( size_t idx = 0; idx != nnn; ++idx )
+          if ( gen(idx,val) ) insertUniqueValue(val);
+        return; }
+      std::vector<unsigned> slots;
+      for ( size_t beg = 0; beg < nnn; beg += blockSize )
+      { size_t end = std::min(nnn,beg+blockSize);
+        size_t capacity = mCapacity;
+        slots.resize(end-beg);
+        #pragma omp parallel for schedule(static)
+        for ( size_t idx = beg; idx < end; ++idx )
+        { value_type val;
+          slots[idx-beg] = gen(idx,val) ? findHHSIdx(mHCF.hash(val)) : ~0u; }
+        #pragma omp parallel
+        { size_t nThreads = omp_get_num_threads();
+          size_t thread = omp_get_thread_num();
+          size_t lo = capacity*thread/nThreads;
+          size_t hi = capacity*(thread+1)/nThreads;
+          value_type val;
+          for ( size_t idx = beg; idx != end; ++idx )
+          { unsigned slot = slots[idx-beg];
+            if ( slot >= lo && slot < hi && gen(idx,val) )
+              insertUniqueValue(val); } } } }
+
     /// Specialized inserter:  No locking, inserts value_type rather than key,
     /// does not check for uniqueness.  This is dangerous, and would typically
     /// be used only when copying values known to comprise a set into a
@@ -857,6 +921,12 @@ private:
     void init( size_t cap, double maxLoadFactor )
     { int capCeilLg2 = PowerOf2::ceilLg2(cap/maxLoadFactor);
       int innerCapLg2 = std::max(10,(capCeilLg2+1)/2);
+      // on huge pages, make the inner tables of a big set big enough to span
+      // a few of them, but keep enough inner tables for the locking to scale
+      if ( HugePages::enabled() )
+        while ( (sizeof(T) << innerCapLg2) < 4*HugePages::PAGE_BYTES &&
+                capCeilLg2-innerCapLg2 > 7 )
+          innerCapLg2 += 1;
       int outerCapLg2 = std::max(7,capCeilLg2-innerCapLg2);
       mCapacity = 1ul << outerCapLg2;
       mppHHS = allocArray(mCapacity);
@@ -879,6 +949,14 @@ private:
       while ( !(result = ppHHS[hash&mask]) ) mask >>= 1;
       return result; }
 
+    // the index of the HHS that findHHSC would return
+    size_t findHHSIdx( size_t hash ) const
+    { size_t mask = mCapacity - 1;
+      hash ^= hash >> 32;
+      PPHHS ppHHS = mppHHS;
+      while ( !ppHHS[hash&mask] ) mask >>= 1;
+      return hash&mask; }
+
     // return with HHS locked
     HHS* findHHS( size_t hash )
     { hash ^= hash >> 32;
@@ -19,6 +19,7 @@
 #include "feudal/BinaryStream.h"
 #include "feudal/Iterator.h"
 #include "system/Assert.h"
+#include "system/HugePages.h"
 #include <algorithm>
 #include <cstddef>
 #include <cstring>
@@ -85,7 +86,8 @@ public:
     HugeBVec( char const* fileName )
     { BinaryReader::readFile(fileName,this); }
 
-    HugeBVec( size_type size ) : mSize(size), mVec(physSize()) {}
+    HugeBVec( size_type size ) : mSize(size)
+    { physReserve(physSize()); mVec.resize(physSize()); }
 
     HugeBVec() : mSize(0) {}
 
@@ -126,7 +128,7 @@ public:
     { return const_rc_iterator(this,end,end); }
 
     HugeBVec& reserve( size_type nBases )
-    { mVec.reserve( (nBases+3)/4 ); return *this; }
+    { physReserve( (nBases+3)/4 ); return *this; }
 
     HugeBVec& resize( size_type siz )
     { mSize = siz; mVec.resize(physSize()); return *this; }
@@ -134,7 +136,7 @@ public:
     HugeBVec& push_back( value_type val )
     { AssertLt(val,4u);
       size_type idx = mSize++;
-      if ( physSize() > mVec.capacity() ) mVec.reserve(2*physSize());
+      if ( physSize() > mVec.capacity() ) physReserve(2*physSize());
       mVec.resize(physSize());
       mVec[idx>>2] |= ((val&3) << 2*(~idx&3));
       return *this; }
@@ -143,7 +145,7 @@ public:
     HugeBVec& append( Itr itr, Itr const& end )
     { using std::distance;
       size_type idx = mSize; mSize += distance(itr,end);
-      if ( physSize() > mVec.capacity() ) mVec.reserve(2*physSize());
+      if ( physSize() > mVec.capacity() ) physReserve(2*physSize());
       mVec.resize(physSize());
       value_type* ppp = &mVec[idx>>2];
       value_type vvv = *ppp;
@@ -163,6 +165,7 @@ public:
 
     void readBinary( BinaryReader& br )
     { br.read(&mSize);
+      physReserve(physSize());
       mVec.resize(physSize());
       if ( mSize )
       { value_type* ppp = &mVec[0];
@@ -226,6 +229,12 @@ public:
 private:
     size_t physSize() const { return (mSize+3)/4; }
 
+    // reserve, and have a newly allocated array put on huge pages if asked
+    void physReserve( size_t nBytes )
+    { if ( nBytes <= mVec.capacity() ) return;
+      mVec.reserve(nBytes);
+      HugePages::advise(mVec.data(),mVec.capacity()); }
+
     size_type mSize;
     container mVec;
 };
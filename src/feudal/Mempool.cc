@@ -15,6 +15,8 @@
  */
 #include "feudal/Mempool.h"
 //#include "feudal/TrackingAllocator.h"
+#include "system/HugePages.h"
+#include "system/NumaPolicy.h"
 #include <iostream>
 
 using std::cout;
@@ -29,7 +31,10 @@ void* Mempool::allocate( size_t siz, size_t alignmentReq )
 #ifdef TRACK_MEMUSE
         mpMemUse->alloc(siz);
 #endif
-        return new char[siz];
+        char* result = new char[siz];
+        HugePages::advise(result,siz);
+        NumaPolicy::touch(result,siz);
+        return result;
     }
 
     SpinLocker locker(*this);
@@ -105,6 +110,8 @@ void Mempool::free( void* ppp, size_t siz )
 void Mempool::preAllocate( size_t nBytes )
 {
     char* ppp = new char[nBytes+sizeof(Chunk)];
+    HugePages::advise(ppp,nBytes+sizeof(Chunk));
+    NumaPolicy::touch(ppp,nBytes+sizeof(Chunk));
 #ifdef TRACK_MEMUSE
     mpMemUse->alloc(nBytes);
 #endif
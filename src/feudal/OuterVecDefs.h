@@ -17,6 +17,8 @@
 #define FEUDAL_OUTERVECDEFS_H_
 
 #include "feudal/OuterVec.h"
+#include "system/HugePages.h"
+#include "system/NumaPolicy.h"
 #include <cstddef>
 
 template <class T, class S, class A>
@@ -85,6 +87,8 @@ void OuterVec<T,S,A>::realloc( OuterVec<T,S,A>::size_type nElements )
 {
     ForceAssertLe(nElements,max_size());
     T* elements = nElements ? mAllocator.allocate(nElements,0) : 0;
+    HugePages::advise(elements,nElements*sizeof(T));
+    NumaPolicy::touch(elements,nElements*sizeof(T));
     T* last = elements + size();
     T* src = dataEnd();
 
@@ -51,6 +51,8 @@ public:
     static void decode( byte const* pqBuf, byte* pQs );
 
 private:
+    template <class> friend class PQVecA;
+
     struct Block
     { Block( byte nQs, byte bits, byte minQ )
       : mNQs(nQs), mBits(bits), mMinQ(minQ) {}
@@ -6,10 +6,13 @@
 //   Institute is not responsible for its use, misuse, or functionality.     //
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <queue>
 
 #include "Bitvector.h"
+#include "ConcurrentUnionFind.h"
 #include "CoreTools.h"
 #include "Equiv.h"
 #include "Set.h"
@@ -439,60 +442,88 @@ void digraph::ComponentRelation( equiv_rel& e ) const
           {    int w = From(v)[j];
                e.Join(v, w);    }    }    }
 
-void digraph::Components( vec< vec<int> >& comp, const vec<Bool>* invisible ) const
+namespace
+{
+
+// Find the weakly connected components of G in parallel.  The result is the
+// same as a serial search: components in order of their smallest vertex, each
+// a sorted list of vertices.  Invisible vertices are ignored.
+
+template<class G_t>
+void ParallelComponents( const G_t& G, vec< vec<int> >& comp,
+     const vec<Bool>* invisible )
 {    comp.clear( );
-     vec<Bool> used( N( ), False );
-     if ( invisible != NULL ) used = *invisible;
-     vec<int> C, Cnext;
-     for ( int v = 0; v < N( ); v++ ) 
-     {    if ( used[v] ) continue;
-          C.clear( ), Cnext.clear( );
-          Cnext.push_back(v);
-          while( Cnext.nonempty( ) ) 
-          {    int w = Cnext.back( );
-               Cnext.pop_back( );
-               if ( used[w] ) continue;
-               used[w] = True;
-               C.push_back(w);
-               // Expand this component recursively
-               Cnext.append( From(w) );
-               Cnext.append( To(w) );    }
-         Sort(C);
-         comp.push_back(C);    }    }
+     const int n = G.N( );
+     ConcurrentUnionFind uf(n);
+     #pragma omp parallel for schedule(dynamic,10000)
+     for ( int v = 0; v < n; v++ )
+     {    if ( invisible != NULL && (*invisible)[v] ) continue;
+          for ( int j = 0; j < (int) G.From(v).size( ); j++ )
+          {    int w = G.From(v)[j];
+               if ( invisible != NULL && (*invisible)[w] ) continue;
+               uf.join( v, w );    }    }
+     vec<int> root(n);
+     #pragma omp parallel for schedule(dynamic,10000)
+     for ( int v = 0; v < n; v++ )
+          root[v] = uf.find(v);
+
+     // Number the components in order of their root, which is their smallest
+     // vertex, then fill them in vertex order so each comes out sorted.
+
+     vec<int> id( n, -1 );
+     int ncomps = 0;
+     for ( int v = 0; v < n; v++ )
+     {    if ( invisible != NULL && (*invisible)[v] ) continue;
+          if ( root[v] == v ) id[v] = ncomps++;    }
+     vec<int> sizes( ncomps, 0 );
+     for ( int v = 0; v < n; v++ )
+     {    if ( invisible != NULL && (*invisible)[v] ) continue;
+          sizes[ id[ root[v] ] ]++;    }
+     comp.resize(ncomps);
+     #pragma omp parallel for schedule(dynamic,10000)
+     for ( int c = 0; c < ncomps; c++ )
+          comp[c].reserve( sizes[c] );
+     for ( int v = 0; v < n; v++ )
+     {    if ( invisible != NULL && (*invisible)[v] ) continue;
+          comp[ id[ root[v] ] ].push_back(v);    }    }
+
+} // end of anonymous namespace
+
+void digraph::Components( vec< vec<int> >& comp, const vec<Bool>* invisible ) const
+{    ParallelComponents( *this, comp, invisible );    }
 
 void digraphX::Components( vec< vec<int> >& comp, const vec<Bool>* invisible ) const
-{    comp.clear( );
-     vec<Bool> used( N( ), False );
-     if ( invisible != NULL ) used = *invisible;
-     vec<int> C, Cnext;
-     for ( int v = 0; v < N( ); v++ ) 
-     {    if ( used[v] ) continue;
-          C.clear( ), Cnext.clear( );
-          Cnext.push_back(v);
-          while( Cnext.nonempty( ) ) 
-          {    int w = Cnext.back( );
-               Cnext.pop_back( );
-               if ( used[w] ) continue;
-               used[w] = True;
-               C.push_back(w);
-               // Expand this component recursively
-               Cnext.append( From(w) );
-               Cnext.append( To(w) );    }
-         Sort(C);
-         comp.push_back(C);    }    }
+{    ParallelComponents( *this, comp, invisible );    }
 
 void digraph::ComponentsAlt( vec< vec<int> >& comp ) const
-{    comp.clear( );
-     equiv_rel e( N( ) );
-     for ( int v = 0; v < N( ); v++ )
-     {    for ( int j = 0; j < From(v).isize( ); j++ )
-               e.Join( v, From(v)[j] );    }
-     for ( int x = 0; x < N( ); x++ )
-     {    if ( e.Representative(x) )
-          {    vec<int> o;
-               e.Orbit( x, o );
-               Sort(o);
-               comp.push_back(o);    }    }    }
+{    
+     // The order here is that of the representatives of an equiv_rel built by
+     // joining v to each of From(v), for v in increasing order.  Joining a to b
+     // makes every element of b's class take the representative of a's class,
+     // so we replay the joins on a union-find that carries the representative
+     // of each class as a label.  Joins never cross components, and each
+     // component lists its vertices in increasing order, so the replay is done
+     // per component, in parallel.
+
+     ParallelComponents( *this, comp, NULL );
+     vec<int> parent( N( ), vec<int>::IDENTITY ), label( N( ), vec<int>::IDENTITY );
+     auto find = [&parent]( int v )
+     {    while ( parent[v] != v ) v = parent[v] = parent[ parent[v] ];
+          return v;    };
+     vec<int> rep( comp.size( ) );
+     #pragma omp parallel for schedule(dynamic,100)
+     for ( int c = 0; c < comp.isize( ); c++ )
+     {    for ( int i = 0; i < comp[c].isize( ); i++ )
+          {    int v = comp[c][i];
+               for ( int j = 0; j < From(v).isize( ); j++ )
+               {    int a = find(v), b = find( From(v)[j] );
+                    if ( a == b ) continue;
+                    int r = label[a];
+                    if ( a < b ) std::swap( a, b );
+                    parent[a] = b;
+                    label[b] = r;    }    }
+          rep[c] = label[ find( comp[c][0] ) ];    }
+     SortSync( rep, comp );    }
 
 
 size_t digraph::NComponents() const
@@ -938,123 +969,198 @@ Bool digraph::Acyclic( ) const
 // this is a non-recursive implementation of Tarjan's Strongly Connected Components algoritm 
 // you can find a recursive pseudocode implementation of the algorithm on wikipedia
 
-void digraph::StronglyConnectedComponents( vec< vec<int> >& SCCs ) const
+namespace
 {
-  enum State { start, 
-               run_iteration, 
-               next_iteration,
-               end, 
-               finished };  // type defining the various states of the algorithm
-
-  SCCs.clear(); // vector of Strongly Connected Components
-
-  vec<int> Iv(N(), -1);  // index   of vertex v
-  vec<int> LLv(N(), -1); // lowlink of vertex v
-
-  vec<int> S;            // vec and set 
-  std::set<int> vStk;           //  representing the vertex stack
-
-  int iv = 0;              // the vertex ID 
-  int iw = -1;             // the ID of a neighboring vertex to iv  
-  int iv_neig;             // the index of a neighboring vertex of iv (0..n_neig-1) 
-
-  vec<int> iv_stack;       // iv stack for mimicking a recursive call
-  vec<int> iv_neig_stack;  // iv_neig stack for mimicking a recursive call
-
-  State state = start;
-  int I = 0;             // vertex index in order of visit
-
-  while (state != finished) {  
-
-    if (state == start) {
-
-      if (iv != N()) { // still have vertices to visit
-        Iv[iv] = LLv[iv] = I;
-        I++;
-        S.push_back(iv), vStk.insert(iv); // add iv to the stack
-        
-        iv_neig = 0;              // prepare iteration over 'to' neighbors
-        state = run_iteration;
-      }
-      else {
-        state = finished;
-      }
-    }
 
+// Set colors for the forward-backward search.  While one set is being searched,
+// other sets recolor their own vertices, and a search may look at those
+// vertices across an edge, so all reads and writes go through relaxed atomics.
+// A vertex only ever moves from one set to a subset of it, so a search never
+// sees its own color appear on a vertex outside its set.
 
-    if (state == run_iteration) {
-
-      if (iv_neig != this->From(iv).isize()) { // still have 'to' neighbors to visit
-        iw = this->From(iv)[iv_neig];  // vertex ID of neighbor
-        
-        if (Iv[iw] < 0) { // iw has not been visited yet
-          iv_stack.push_back(iv);          // push to recursive stack
-          iv_neig_stack.push_back(iv_neig);
-          iv = iw;
-          iv_neig = -1;
-          iw = -1;
-
-          state = start; // recursive call
-        }
-        else {
-          if (Member(vStk, iw))  // vertex in the stack
-            LLv[iv] = Min(LLv[iv], Iv[iw]);
-          
-          state = next_iteration;
-        }
-      }
-      else {  // no more neighbors
-        state = end;
-      }
-    }
-    
-
-    if (state == end) {
-
-      if (LLv[iv] == Iv[iv]) { // vertex iv is the root of a SCC; remove it from the atack
-        vec<int> SCC;
-        int jv;
-        do {
-          jv = S.back();
-          S.pop_back(), vStk.erase(jv);
-          SCC.push_back(jv);
-        } while (iv != jv);
-        Sort(SCC);
-        SCCs.push_back(SCC);  // add the SCC to the SCCs
-      }
-
-      if (iv_stack.size()) {   // if iv_stack is not empty this was a recursive call
-
-        iw = iv;
-        iv = iv_stack.back(); 
-        iv_neig = iv_neig_stack.back();
-
-        iv_stack.pop_back();
-        iv_neig_stack.pop_back();
-        
-        LLv[iv] = Min(LLv[iv], LLv[iw]);
-
-        state = next_iteration;
-      }
-      else {  // not a recursive call; go on to the next unvisited vertex
-
-        while (iv < N() && Iv[iv] >= 0)
-          iv++;
-        
-        state = start; 
-      }
-    }
-
-
-    if (state == next_iteration) {  // next 'to' neighbor
-      iv_neig ++;       
-      state = run_iteration;
-    }
-
-  }
-  Sort(SCCs);
+class VertexColors
+{
+public:
+     explicit VertexColors( const int n ) : mColor(new std::atomic<int>[n])
+     {    for ( int v = 0; v < n; v++ )
+               mColor[v].store( 0, std::memory_order_relaxed );    }
+
+     int operator[]( const int v ) const
+     {    return mColor[v].load( std::memory_order_relaxed );    }
+
+     void Set( const int v, const int c )
+     {    mColor[v].store( c, std::memory_order_relaxed );    }
+
+     bool Claim( const int v, int from, const int to )
+     {    return mColor[v].compare_exchange_strong( from, to );    }
+
+private:
+     std::unique_ptr<std::atomic<int>[]> mColor;
+};
+
+// Tarjan's algorithm, restricted to the vertices v having color[v] == c.
+// Index, lowlink and on-stack state live in caller-provided arrays indexed by
+// vertex, so that disjoint vertex sets can be processed concurrently.
+
+void TarjanOnColor( const digraph& G, const vec<int>& verts, const VertexColors& color,
+     const int c, vec<int>& Iv, vec<int>& LLv, vec<Bool>& onstack,
+     vec< vec<int> >& SCCs )
+{    int I = 0;
+     vec<int> S, call_v, call_j;
+     for ( int s = 0; s < verts.isize( ); s++ )
+     {    if ( Iv[ verts[s] ] >= 0 ) continue;
+          call_v.push_back( verts[s] ), call_j.push_back(0);
+          Iv[ verts[s] ] = LLv[ verts[s] ] = I++;
+          S.push_back( verts[s] ), onstack[ verts[s] ] = True;
+          while ( call_v.nonempty( ) )
+          {    int v = call_v.back( ), &j = call_j.back( );
+               if ( j < G.From(v).isize( ) )
+               {    int w = G.From(v)[j++];
+                    if ( color[w] != c ) continue;
+                    if ( Iv[w] < 0 )
+                    {    Iv[w] = LLv[w] = I++;
+                         S.push_back(w), onstack[w] = True;
+                         call_v.push_back(w), call_j.push_back(0);    }
+                    else if ( onstack[w] ) LLv[v] = Min( LLv[v], Iv[w] );
+                    continue;    }
+               call_v.pop_back( ), call_j.pop_back( );
+               if ( call_v.nonempty( ) )
+                    LLv[ call_v.back( ) ] = Min( LLv[ call_v.back( ) ], LLv[v] );
+               if ( LLv[v] != Iv[v] ) continue;
+               vec<int> SCC;
+               int w;
+               do
+               {    w = S.back( );
+                    S.pop_back( ), onstack[w] = False;
+                    SCC.push_back(w);    }
+               while ( w != v );
+               Sort(SCC);
+               SCCs.push_back(SCC);    }    }    }
+
+// Search from v along edges (forward or backward), staying within color c,
+// and set the given bit in mark for every vertex reached.
+
+void MarkReachable( const digraph& G, const int v, const VertexColors& color, 
+     const int c, const Bool forward, const unsigned char bit, 
+     vec<unsigned char>& mark )
+{    vec<int> stack = {v};
+     mark[v] |= bit;
+     while ( stack.nonempty( ) )
+     {    int x = stack.back( );
+          stack.pop_back( );
+          const vec<int>& next = ( forward ? G.From(x) : G.To(x) );
+          for ( int j = 0; j < next.isize( ); j++ )
+          {    int y = next[j];
+               if ( color[y] != c || ( mark[y] & bit ) ) continue;
+               mark[y] |= bit;
+               stack.push_back(y);    }    }    }
+
+} // end of anonymous namespace
+
+// Strongly connected components are found in three phases:
+// 1. Trimming.  A vertex with no remaining predecessors or successors is an
+//    SCC by itself.  This is applied in parallel until nothing changes, and
+//    disposes of all acyclic parts of the graph.
+// 2. Forward-backward decomposition.  For a set of vertices, the vertices both
+//    reachable from and reaching a pivot form an SCC; the remaining vertices
+//    split into three sets that can be processed independently.  Sets are
+//    identified by a color per vertex and processed level by level in parallel.
+// 3. Sets that are small enough are finished with Tarjan's algorithm.
 
-}
+void digraph::StronglyConnectedComponents( vec< vec<int> >& SCCs ) const
+{    SCCs.clear( );
+     const int n = N( );
+     const int max_tarjan = 10000;
+
+     // Trim.
+
+     VertexColors color(n);
+     std::unique_ptr<std::atomic<int>[]> nin( new std::atomic<int>[n] ),
+          nout( new std::atomic<int>[n] );
+     vec<int> frontier;
+     #pragma omp parallel
+     {    vec<int> local;
+          #pragma omp for schedule(dynamic,10000)
+          for ( int v = 0; v < n; v++ )
+          {    nin[v].store( To(v).size( ), std::memory_order_relaxed );
+               nout[v].store( From(v).size( ), std::memory_order_relaxed );
+               if ( To(v).empty( ) || From(v).empty( ) )
+               {    color.Set( v, -1 );
+                    local.push_back(v);    }    }
+          #pragma omp critical
+          {    frontier.append(local);    }    }
+     vec<int> trimmed;
+     while ( frontier.nonempty( ) )
+     {    trimmed.append(frontier);
+          vec<int> next;
+          #pragma omp parallel
+          {    vec<int> local;
+               #pragma omp for schedule(dynamic,1000)
+               for ( int i = 0; i < frontier.isize( ); i++ )
+               {    int v = frontier[i];
+                    for ( int j = 0; j < From(v).isize( ); j++ )
+                    {    int w = From(v)[j];
+                         if ( nin[w].fetch_sub(1) != 1 ) continue;
+                         if ( color.Claim( w, 0, -1 ) )
+                              local.push_back(w);    }
+                    for ( int j = 0; j < To(v).isize( ); j++ )
+                    {    int u = To(v)[j];
+                         if ( nout[u].fetch_sub(1) != 1 ) continue;
+                         if ( color.Claim( u, 0, -1 ) )
+                              local.push_back(u);    }    }
+               #pragma omp critical
+               {    next.append(local);    }    }
+          frontier.swap(next);    }
+     nin.reset( ), nout.reset( );
+     SCCs.reserve( trimmed.size( ) );
+     for ( int i = 0; i < trimmed.isize( ); i++ )
+          SCCs.push_back( vec<int>{ trimmed[i] } );
+     Destroy(trimmed);
+
+     // Forward-backward decomposition of what is left.  Colors: -1 = done,
+     // otherwise the id of the set a vertex currently belongs to.
+
+     vec<vec<int>> sets(1);
+     for ( int v = 0; v < n; v++ )
+          if ( color[v] == 0 ) sets[0].push_back(v);
+     if ( sets[0].empty( ) ) sets.clear( );
+     std::atomic<int> next_color(1);
+     vec<unsigned char> mark( n, 0 );
+     vec<int> Iv( n, -1 ), LLv( n, -1 );
+     vec<Bool> onstack( n, False );
+     while ( sets.nonempty( ) )
+     {    vec< vec< vec<int> > > found( sets.size( ) ), children( sets.size( ) );
+          #pragma omp parallel for schedule(dynamic,1)
+          for ( int s = 0; s < sets.isize( ); s++ )
+          {    const vec<int>& verts = sets[s];
+               const int c = color[ verts[0] ];
+               if ( verts.isize( ) <= max_tarjan )
+               {    TarjanOnColor( *this, verts, color, c, Iv, LLv, onstack, 
+                         found[s] );
+                    continue;    }
+               const int pivot = verts[0];
+               MarkReachable( *this, pivot, color, c, True, 1, mark );
+               MarkReachable( *this, pivot, color, c, False, 2, mark );
+               vec<int> scc, parts[3];
+               for ( int i = 0; i < verts.isize( ); i++ )
+               {    int v = verts[i];
+                    if ( mark[v] == 3 ) scc.push_back(v);
+                    else parts[ mark[v] ].push_back(v);
+                    mark[v] = 0;    }
+               found[s].push_back(scc);
+               for ( int p = 0; p < 3; p++ )
+               {    if ( parts[p].empty( ) ) continue;
+                    int cp = next_color++;
+                    for ( int i = 0; i < parts[p].isize( ); i++ )
+                         color.Set( parts[p][i], cp );
+                    children[s].push_back( parts[p] );    }    }
+          vec<vec<int>> next;
+          for ( int s = 0; s < sets.isize( ); s++ )
+          {    SCCs.append( found[s] );
+               for ( int j = 0; j < children[s].isize( ); j++ )
+                    next.push_back( std::move( children[s][j] ) );    }
+          sets.swap(next);    }
+     Sort(SCCs);    }
 
 template void digraphE<int>::DeleteEdgeFrom(int, int);
 template void digraphE<int>::DeleteEdges(vec<int> const&);
@@ -192,8 +192,9 @@ class digraph
      void Reverse( );
 
      // Components: find the connected components.  Each component is a sorted list
-     // of vertices.  If invisible vertices are provided, they are ignored.
-     // ComponentsAlt orders the components differently.
+     // of vertices, and components are ordered by their smallest vertex.  If
+     // invisible vertices are provided, they are ignored.  ComponentsAlt orders 
+     // the components differently.  Both use a parallel union-find.
      
      void Components( vec< vec<int> >& comp, const vec<Bool>* invisible = NULL ) 
           const;
@@ -204,9 +205,10 @@ class digraph
 
      Bool LoopAt( const int v ) const;
 
-     // Return the strongly connected components of a graph.  The code is an
-     // algorithm of Tarjan.  We borrowed pseudocode from Wikipedia.  The answer
-     // is a sorted vector of sorted vectors.
+     // Return the strongly connected components of a graph.  The code trims
+     // acyclic parts of the graph and splits the rest by forward-backward search
+     // in parallel, finishing small pieces with the algorithm of Tarjan.  The 
+     // answer is a sorted vector of sorted vectors.
 
      void StronglyConnectedComponents( vec< vec<int> >& SCC ) const;
 
@@ -119,90 +119,122 @@ BuildCell( const digraph & G, const int & v1, const int & vn,
 
 
 
-// For documentation, see FindCells.h
-void FindCells( const digraph& G, const size_t max_cell_size, vec< vec<int> >& cells )
+// FindCellFrom: A helper function for FindCells, below.
+// Find the minimal cell starting at v1, if there is one.  Returns an empty
+// vec if there is none.
+vec<int>
+FindCellFrom( const digraph& G, const int v1, const size_t max_cell_size )
 {
-  cells.clear();
+  vec<int> empty_cell(0);
+  
+  // Ignore v1 if it is a self-loop.
+  if ( BinPosition( G.To( v1 ), v1 ) != -1 ) return empty_cell;
   
-  // Loop over every possible value of v1 - the starting vertex of the cell.
-  for ( int v1 = 0; v1 < G.N( ); v1++ ) {
+  // Find candidate choices for vn - the endpoint of the cell.
+  // This means doing a breadth-first search from v1, going as many as
+  // max_cell_size steps.
+  vec<int> growth_spots( 1, v1 );
+  vec<int> candidates;
+  for ( size_t i = 0; i < max_cell_size; i++ ) {
     
-    // Ignore v1 if it is a self-loop.
-    if ( BinPosition( G.To( v1 ), v1 ) != -1 ) continue;
+    // Step forward in the search.
+    vec<int> next_growth_spots;
+    for ( size_t j = 0; j < growth_spots.size(); j++ )
+      next_growth_spots.append( G.From( growth_spots[j] ) );
     
-    // Find candidate choices for vn - the endpoint of the cell.
-    // This means doing a breadth-first search from v1, going as many as
-    // max_cell_size steps.
-    vec<int> growth_spots( 1, v1 );
-    vec<int> candidates;
-    for ( size_t i = 0; i < max_cell_size; i++ ) {
-      
-      // Step forward in the search.
-      vec<int> next_growth_spots;
-      for ( size_t j = 0; j < growth_spots.size(); j++ )
-	next_growth_spots.append( G.From( growth_spots[j] ) );
-      
-      candidates.append( growth_spots );
-      growth_spots = next_growth_spots;
-    }
-    UniqueSort( candidates );
+    candidates.append( growth_spots );
+    growth_spots = next_growth_spots;
+  }
+  UniqueSort( candidates );
+  
+  // Remove from the candidates list any vertices v which contain predecessors
+  // not in the candidates list.  (By design this includes v1, which until now
+  // is in the list.)  These vertices cannot possibly create cells.
+  // Note that this excludes "hairs" that branch backwards.
+  vec<Bool> erase( candidates.size(), False );
+  for ( size_t i = 0; i < candidates.size(); i++ ) {
+    vec<int> tos = G.To( candidates[i] );
+    for ( size_t j = 0; j < tos.size(); j++ )
+      if ( BinPosition( candidates, tos[j] ) == -1 ) {
+	//if ( G.From( tos[j] ).solo() && G.To( tos[j] ).empty() ) continue;
+	erase[i] = True;
+	break;
+      }
+  }
+  EraseIf( candidates, erase );
+  
+  
+  // Go through each candidate vn, and consider the possibility that it is
+  // the tail end of a cell.  If we find a cell, return it.
+  for ( size_t i = 0; i < candidates.size( ); i++ ) {
     
-    // Remove from the candidates list any vertices v which contain predecessors
-    // not in the candidates list.  (By design this includes v1, which until now
-    // is in the list.)  These vertices cannot possibly create cells.
-    // Note that this excludes "hairs" that branch backwards.
-    vec<Bool> erase( candidates.size(), False );
-    for ( size_t i = 0; i < candidates.size(); i++ ) {
-      vec<int> tos = G.To( candidates[i] );
-      for ( size_t j = 0; j < tos.size(); j++ )
-	if ( BinPosition( candidates, tos[j] ) == -1 ) {
-	  //if ( G.From( tos[j] ).solo() && G.To( tos[j] ).empty() ) continue;
-	  erase[i] = True;
-	  break;
-	}
-    }
-    EraseIf( candidates, erase );
+    // Ignore vn if it is a self-loop.
+    int vn = candidates[i];
+    if ( BinPosition( G.To( vn ), vn ) != -1 ) continue;
     
+    // Attempt to build a cell from v1 to vn.
+    vec<int> cell = BuildCell( G, v1, vn, candidates, max_cell_size );
+    if ( cell.empty() ) continue;
     
-    // Go through each candidate vn, and consider the possibility that it is
-    // the tail end of a cell.  If we find a cell, add it to the list.
-    for ( size_t i = 0; i < candidates.size( ); i++ ) {
-      
-      // Ignore vn if it is a self-loop.
-      int vn = candidates[i];
-      if ( BinPosition( G.To( vn ), vn ) != -1 ) continue;
-      
-      // Attempt to build a cell from v1 to vn.
-      vec<int> cell = BuildCell( G, v1, vn, candidates, max_cell_size );
-      if ( cell.empty() ) continue;
-      
-      // If the cell contains only two elements (v1 and vn), require them to
-      // have multiple links between them.
-      if ( cell.size() == 2 ) {
-	vec<int> froms = G.From( cell[0] );
-	if ( froms.CountValue( cell[1] ) < 2 ) continue;
-      }
-      
-      // Note that v1 can only have one minimal cell coming out of it.  Hence if
-      // we find a vn that completes a cell, there's no need to keep looking
-      // at other vn's for this v1.
-      cells.push_back( cell );
-      break;
+    // If the cell contains only two elements (v1 and vn), require them to
+    // have multiple links between them.
+    if ( cell.size() == 2 ) {
+      vec<int> froms = G.From( cell[0] );
+      if ( froms.CountValue( cell[1] ) < 2 ) continue;
     }
+    
+    // Note that v1 can only have one minimal cell coming out of it.  Hence if
+    // we find a vn that completes a cell, there's no need to keep looking
+    // at other vn's for this v1.
+    return cell;
   }
+  return empty_cell;
 }
 
-void FindSomeCells( const digraph& G, const int max_cell_size,
-     const int max_depth, vec< std::pair<int,int> >& bounds )
+
+
+
+// For documentation, see FindCells.h
+void FindCells( const digraph& G, const size_t max_cell_size, vec< vec<int> >& cells )
+{
+  vec< vec<int> > comps;
+  G.Components( comps );
+  FindCells( G, max_cell_size, comps, cells );
+}
+
+void FindCells( const digraph& G, const size_t max_cell_size,
+     const vec< vec<int> >& comps, vec< vec<int> >& cells )
+{
+  cells.clear();
+  
+  // Cells never cross component boundaries, so each component is searched
+  // independently.  Results are put back in order of opening vertex, which is
+  // the order the serial loop over v1 produced.
+  vec< vec< vec<int> > > comp_cells( comps.size() );
+  #pragma omp parallel for schedule(dynamic,1)
+  for ( size_t c = 0; c < comps.size(); c++ ) {
+    for ( size_t i = 0; i < comps[c].size(); i++ ) {
+      vec<int> cell = FindCellFrom( G, comps[c][i], max_cell_size );
+      if ( cell.nonempty() ) comp_cells[c].push_back( cell );
+    }
+  }
+  for ( size_t c = 0; c < comps.size(); c++ )
+    cells.append( comp_cells[c] );
+  std::sort( cells.begin(), cells.end(),
+	     []( const vec<int>& c1, const vec<int>& c2 )
+	     { return c1.front() < c2.front(); } );
+}
+
+// FindSomeCellFrom: A helper function for FindSomeCells, below.  Returns the
+// exit vertex of the cell entered at v, or -1 if there is none.
+
+int FindSomeCellFrom( const digraph& G, const int v, const int max_cell_size,
+     const int max_depth )
 {
-     bounds.clear( );
-     #pragma omp parallel for
-     for ( int v = 0; v < G.N( ); v++ )
-     {    
           // Consider only canonical cell entry vertices v.
 
-          if ( !G.To(v).solo( ) || G.From(v).size( ) <= 1 ) continue;
-          if ( Member( G.From(v), v ) ) continue;
+          if ( !G.To(v).solo( ) || G.From(v).size( ) <= 1 ) return -1;
+          if ( Member( G.From(v), v ) ) return -1;
           
           // Find vertices a bit downstream of the immediate successors of v.
 
@@ -286,13 +318,38 @@ void FindSomeCells( const digraph& G, const int max_cell_size,
 
           // Pick smallest.
 
-          if ( ex2.empty( ) ) continue;
+          if ( ex2.empty( ) ) return -1;
           vec<int> len( xs.size( ) ), ids( xs.size( ), vec<int>::IDENTITY );
           for ( int i = 0; i < xs.isize( ); i++ )
                len[i] = xs[i].size( );
           SortSync( len, ids );
-          if ( ex2.size( ) >= 2 && len[0] == len[1] ) continue; // possible???
-          int w = ex2[ ids[0] ];
+          if ( ex2.size( ) >= 2 && len[0] == len[1] ) return -1; // possible???
+          return ex2[ ids[0] ];    }
+
+void FindSomeCells( const digraph& G, const int max_cell_size,
+     const int max_depth, vec< std::pair<int,int> >& bounds )
+{
+     bounds.clear( );
+     #pragma omp parallel for
+     for ( int v = 0; v < G.N( ); v++ )
+     {    int w = FindSomeCellFrom( G, v, max_cell_size, max_depth );
+          if ( w < 0 ) continue;
           #pragma omp critical
           {    bounds.push( v, w );    }    }
      Sort(bounds);    }
+
+void FindSomeCells( const digraph& G, const int max_cell_size,
+     const int max_depth, const vec< vec<int> >& comps,
+     vec< std::pair<int,int> >& bounds )
+{
+     bounds.clear( );
+     vec< vec< std::pair<int,int> > > comp_bounds( comps.size( ) );
+     #pragma omp parallel for schedule(dynamic,1)
+     for ( int c = 0; c < comps.isize( ); c++ )
+     {    for ( int i = 0; i < comps[c].isize( ); i++ )
+          {    int v = comps[c][i];
+               int w = FindSomeCellFrom( G, v, max_cell_size, max_depth );
+               if ( w >= 0 ) comp_bounds[c].push( v, w );    }    }
+     for ( int c = 0; c < comps.isize( ); c++ )
+          bounds.append( comp_bounds[c] );
+     Sort(bounds);    }
@@ -30,6 +30,13 @@
 void FindCells( const digraph& G, const size_t max_cell_size, 
      vec< vec<int> >& cells );
 
+// As above, but using a precomputed weakly connected component decomposition
+// (as returned by digraph::Components).  Components are searched in parallel;
+// cells are returned in order of their opening vertex.
+
+void FindCells( const digraph& G, const size_t max_cell_size, 
+     const vec< vec<int> >& comps, vec< vec<int> >& cells );
+
 // Another algorithm to find some cells, different in several ways from FindCells,
 // including that it does not return simple bubbles.  This returns only the 
 // bounding vertices v and w.
@@ -37,4 +44,11 @@ void FindCells( const digraph& G, const size_t max_cell_size,
 void FindSomeCells( const digraph& G, const int max_cell_size,
      const int max_depth, vec< std::pair<int,int> >& bounds );
 
+// As above, but working one weakly connected component at a time, so that
+// callers that already have the components (e.g. FindLines) can share them.
+
+void FindSomeCells( const digraph& G, const int max_cell_size,
+     const int max_depth, const vec< vec<int> >& comps,
+     vec< std::pair<int,int> >& bounds );
+
 #endif
@@ -0,0 +1,151 @@
+/*
+ * SvgPlot.cc
+ */
+
+#include "graphics/SvgPlot.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+
+int const WIDTH = 640, HEIGHT = 400;
+int const LEFT = 80, RIGHT = 20, TOP = 40, BOTTOM = 60;
+
+std::string escape( std::string const& text )
+{
+    std::string result;
+    for ( char c : text )
+    {
+        switch ( c )
+        {
+        case '&': result += "&amp;"; break;
+        case '<': result += "&lt;"; break;
+        case '>': result += "&gt;"; break;
+        case '"': result += "&quot;"; break;
+        default: result += c; break;
+        }
+    }
+    return result;
+}
+
+// Round numbers spanning [lo,hi]: multiples of 1, 2 or 5 times a power of ten,
+// about five of them.
+std::vector<double> ticks( double lo, double hi )
+{
+    std::vector<double> result;
+    if ( !(hi > lo) )
+    {
+        result.push_back(lo);
+        return result;
+    }
+    double step = std::pow(10.,std::floor(std::log10((hi-lo)/5.)));
+    double span = (hi-lo)/step;
+    if ( span > 20. ) step *= 5.;
+    else if ( span > 8. ) step *= 2.;
+    for ( double t = std::ceil(lo/step)*step; t <= hi+step*1e-9; t += step )
+        result.push_back(std::abs(t) < step*1e-9 ? 0. : t);
+    return result;
+}
+
+std::string label( double value )
+{
+    std::ostringstream os;
+    os << value;
+    return os.str();
+}
+
+}
+
+std::string WriteSvgHistogram( std::string const& file, std::string const& title,
+                               std::string const& xLabel, std::string const& yLabel,
+                               std::vector<double> const& x,
+                               std::vector<double> const& y, bool logY )
+{
+    if ( x.empty() || x.size() != y.size() )
+        return "nothing to plot";
+
+    // Data ranges, with half a bin either side on x.
+    double binWidth = x.size() > 1 ? (x.back()-x.front())/(x.size()-1) : 1.;
+    double xLo = x.front() - binWidth/2., xHi = x.back() + binWidth/2.;
+    double yHi = 0.;
+    for ( double v : y )
+        yHi = std::max(yHi,logY ? std::log10(std::max(v,1.)) : v);
+    if ( logY ) yHi = std::ceil(yHi);
+    if ( yHi <= 0. ) yHi = 1.;
+
+    double plotW = WIDTH - LEFT - RIGHT, plotH = HEIGHT - TOP - BOTTOM;
+    auto px = [&]( double v ) { return LEFT + (v-xLo)/(xHi-xLo)*plotW; };
+    auto py = [&]( double v ) { return TOP + plotH - v/yHi*plotH; };
+
+    std::ofstream out(file);
+    if ( !out )
+        return "can't open " + file + " for writing";
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << WIDTH
+        << "\" height=\"" << HEIGHT << "\" font-family=\"sans-serif\" "
+           "font-size=\"12\">\n"
+        << "<rect width=\"100%\" height=\"100%\" fill=\"white\"/>\n"
+        << "<text x=\"" << WIDTH/2 << "\" y=\"" << TOP/2+5
+        << "\" text-anchor=\"middle\" font-size=\"15\" font-weight=\"bold\">"
+        << escape(title) << "</text>\n";
+
+    // Bars.
+    out << "<g fill=\"steelblue\">\n";
+    for ( size_t i = 0; i != x.size(); ++i )
+    {
+        double h = y[i];
+        if ( logY )
+        {
+            if ( h < 1. ) continue;
+            h = std::log10(h);
+        }
+        if ( h <= 0. ) continue;
+        double x0 = px(x[i]-binWidth/2.), x1 = px(x[i]+binWidth/2.);
+        out << "<rect x=\"" << x0 << "\" y=\"" << py(h) << "\" width=\""
+            << std::max(x1-x0-1.,.5) << "\" height=\"" << py(0.)-py(h)
+            << "\"/>\n";
+    }
+    out << "</g>\n";
+
+    // Axes, ticks and labels.
+    out << "<g stroke=\"black\" fill=\"none\">\n"
+        << "<line x1=\"" << LEFT << "\" y1=\"" << py(0.) << "\" x2=\""
+        << LEFT+plotW << "\" y2=\"" << py(0.) << "\"/>\n"
+        << "<line x1=\"" << LEFT << "\" y1=\"" << TOP << "\" x2=\"" << LEFT
+        << "\" y2=\"" << py(0.) << "\"/>\n";
+    std::vector<double> xTicks = ticks(xLo,xHi), yTicks = ticks(0.,yHi);
+    if ( logY ) // powers of ten only
+    {
+        yTicks.clear();
+        int stride = std::ceil(yHi/6.);
+        for ( int t = 0; t <= yHi; t += stride )
+            yTicks.push_back(t);
+    }
+    for ( double t : xTicks )
+        out << "<line x1=\"" << px(t) << "\" y1=\"" << py(0.) << "\" x2=\""
+            << px(t) << "\" y2=\"" << py(0.)+5 << "\"/>\n";
+    for ( double t : yTicks )
+        out << "<line x1=\"" << LEFT-5 << "\" y1=\"" << py(t) << "\" x2=\""
+            << LEFT << "\" y2=\"" << py(t) << "\"/>\n";
+    out << "</g>\n";
+    for ( double t : xTicks )
+        out << "<text x=\"" << px(t) << "\" y=\"" << py(0.)+18
+            << "\" text-anchor=\"middle\">" << label(t) << "</text>\n";
+    for ( double t : yTicks )
+        out << "<text x=\"" << LEFT-8 << "\" y=\"" << py(t)+4
+            << "\" text-anchor=\"end\">"
+            << label(logY ? std::pow(10.,t) : t) << "</text>\n";
+    out << "<text x=\"" << LEFT+plotW/2 << "\" y=\"" << HEIGHT-15
+        << "\" text-anchor=\"middle\">" << escape(xLabel) << "</text>\n"
+        << "<text transform=\"translate(18," << TOP+plotH/2
+        << ") rotate(-90)\" text-anchor=\"middle\">" << escape(yLabel)
+        << "</text>\n"
+        << "</svg>\n";
+
+    out.close();
+    if ( !out )
+        return "can't write " + file;
+    return "";
+}
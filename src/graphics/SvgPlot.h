@@ -0,0 +1,23 @@
+/*
+ * SvgPlot.h
+ *
+ * Histograms written directly as SVG, for the plots the pipeline makes along
+ * the way.  Unlike RenderGraphics, nothing runs outside the process.
+ */
+
+#ifndef GRAPHICS_SVGPLOT_H_
+#define GRAPHICS_SVGPLOT_H_
+
+#include <string>
+#include <vector>
+
+// Write a bar for each x, of height y, with labelled axes and a title.  The x
+// values are bin centers, evenly spaced and increasing.  With logY, the y axis
+// is logarithmic, and bars of height below 1 are left out.  Returns an error
+// message, or an empty string on success.
+std::string WriteSvgHistogram( std::string const& file, std::string const& title,
+                               std::string const& xLabel, std::string const& yLabel,
+                               std::vector<double> const& x,
+                               std::vector<double> const& y, bool logY = false );
+
+#endif /* GRAPHICS_SVGPLOT_H_ */
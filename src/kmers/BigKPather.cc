@@ -20,7 +20,11 @@
 #include "paths/long/LargeKDispatcher.h"
 #include "system/SpinLockedData.h"
 #include "system/WorklistN.h"
+#include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <vector>
+#include <omp.h>
 
 namespace
 {
@@ -29,11 +33,11 @@ template <unsigned BIGK>
 using BigDict = HashSet<BigKMer<BIGK>,typename BigKMer<BIGK>::hasher>;
 
 
-template <unsigned BIGK>
+template <unsigned BIGK, class Dict=BigDict<BIGK>>
 class BigKMerizer
 {
 public:
-    typedef BigDict<BIGK> BigKDict;
+    typedef Dict BigKDict;
     BigKMerizer( BigKDict* pDict ) : mDict(*pDict) {}
 
     void kmerize( bvec const& bv )
@@ -53,6 +57,11 @@ public:
       kmer.successor(hash,KMerContext::finalContext(itr[-1]));
       add(kmer); }
 
+    // Takes the kmers still in the cache to the dictionary.
+    void flush()
+    { for ( size_t slot = 0; slot != mCache.size(); ++slot )
+        if ( mCached[slot] ) dictAdd(mCache[slot]), mCached[slot] = false; }
+
     template <class OItr>
     void map( vecbvec::const_iterator iItr, OItr oItr )
     { bvec const& bv = *iItr;
@@ -99,21 +108,94 @@ private:
     void update( BigKMer<BIGK> const& kmer )
     { const_cast<BigKMer<BIGK>*>(mDict.lookup(kmer))->updateLocation(kmer); }
 
-    void canonicalAdd( BigKMer<BIGK> const& kmer ) const
+    // Repeats hit the same entries, and so the same locks, again and again
+    // from every thread.  So the contexts of recent kmers are combined in a
+    // small cache of our own, and a kmer only goes to the dictionary when it's
+    // evicted, or at the flush.
+    void canonicalAdd( BigKMer<BIGK> const& kmer )
+    { if ( mCache.empty() ) mCache.resize(CACHE_SIZE), mCached.resize(CACHE_SIZE);
+      size_t slot = typename BigKMer<BIGK>::hasher()(kmer) % CACHE_SIZE;
+      BigKMer<BIGK>& cached = mCache[slot];
+      if ( mCached[slot] )
+      { if ( cached == kmer ) { cached.addContext(kmer.getContext()); return; }
+        dictAdd(cached); }
+      cached = kmer;
+      mCached[slot] = true; }
+
+    void dictAdd( BigKMer<BIGK> const& kmer ) const
     { mDict.apply(kmer,
         [&kmer]( BigKMer<BIGK> const& entry )
         { const_cast<BigKMer<BIGK>&>(entry).addContext(kmer.getContext()); }); }
 
+    static size_t const CACHE_SIZE = 1021;
     BigKDict& mDict;
+    std::vector<BigKMer<BIGK>> mCache;
+    std::vector<bool> mCached;
 };
 
+// A dictionary for small read sets, like those of local assemblies.  It's a
+// sorted vector, built by one thread in a single map/reduce pass, so there's
+// no hash table to size and no locking.  It has just enough of the HashSet
+// interface for the edge builder and the pather.
 template <unsigned BIGK>
+class SmallBigDict
+{
+public:
+    typedef BigKMer<BIGK> BigKmer;
+    typedef std::vector<BigKmer> HHS;
+
+    explicit SmallBigDict( vecbvec const& reads )
+    { BigKMerizer<BIGK,SmallBigDict> kmerizer(this);
+      for ( auto itr=reads.begin(),end=reads.end(); itr != end; ++itr )
+        kmerizer.map(itr,std::back_inserter(mEntries));
+      std::sort(mEntries.begin(),mEntries.end(),hashLess);
+
+      // each run of equal hashes is nearly always a single kmer seen many
+      // times, so merge duplicates within runs without comparing bases
+      // except to confirm a match
+      auto out = mEntries.begin();
+      for ( auto itr=mEntries.begin(),end=mEntries.end(); itr != end; )
+      { auto runEnd = itr + 1;
+        while ( runEnd != end && hash(*runEnd) == hash(*itr) )
+          ++runEnd;
+        auto runBeg = out;
+        for ( ; itr != runEnd; ++itr )
+        { auto dup = std::find(runBeg,out,*itr);
+          if ( dup != out ) dup->addContext(itr->getContext());
+          else *out++ = *itr; } }
+      mEntries.erase(out,mEntries.end()); }
+
+    size_t size() const { return mEntries.size(); }
+
+    BigKmer const* lookup( BigKmer const& kmer ) const
+    { auto end = mEntries.end();
+      auto itr = std::lower_bound(mEntries.begin(),end,kmer,hashLess);
+      for ( ; itr != end && hash(*itr) == hash(kmer); ++itr )
+        if ( *itr == kmer ) return &*itr;
+      return nullptr; }
+
+    template <class Func>
+    void parallelForEachHHS( Func func ) const { func(mEntries); }
+
+    HHS const* begin() const { return &mEntries; }
+    HHS const* end() const { return &mEntries + 1; }
+
+private:
+    static size_t hash( BigKmer const& kmer )
+    { return typename BigKmer::hasher()(kmer); }
+
+    static bool hashLess( BigKmer const& kmer1, BigKmer const& kmer2 )
+    { return hash(kmer1) < hash(kmer2); }
+
+    HHS mEntries;
+};
+
+template <unsigned BIGK, class Dict=BigDict<BIGK>>
 class BigKEdgeBuilder
 {
 public:
     typedef BigKMer<BIGK> BigKmer;
-    typedef BigKMerizer<BIGK> BigKmerizer;
-    typedef BigDict<BIGK> BigKDict;
+    typedef Dict BigKDict;
 
     static void buildEdges( BigKDict const& dict, vecbvec* pEdges )
     {
@@ -308,11 +390,11 @@ private:
     bvec mEdgeSeq;
 };
 
-template <unsigned BIGK>
+template <unsigned BIGK, class Dict=BigDict<BIGK>>
 class Pather
 {
 public:
-    typedef BigDict<BIGK> BigKDict;
+    typedef Dict BigKDict;
 
     Pather( vecbvec const& reads, BigKDict const& dict, vecbvec const& edges,
                 std::vector<int> const& fwdXlat, std::vector<int> const& revXlat,
@@ -458,41 +540,18 @@ void ValidatePaths( vecbvec const& reads, ReadPathVec const& readPaths,
 }
 #endif
 
-template <unsigned BIGK>
-void readsToHBV( vecbvec const& reads, unsigned coverage,
+// Reads with fewer kmers than this, passed from within a parallel region, are
+// handled serially with a SmallBigDict.
+size_t const MAX_SMALL_DICT_KMERS = 1000000;
+
+template <unsigned BIGK, class Dict>
+void dictToHBV( vecbvec const& reads, Dict& dict, bool parallel,
                     HyperBasevector* pHBV, ReadPathVec* pReadPaths,
                     HyperKmerPath* pHKP, vecKmerPath* pKmerPaths ) {
-    if (pReadPaths) {
-        pReadPaths->clear();
-        pReadPaths->resize(reads.size());
-    }
-    if (pKmerPaths) {
-        pKmerPaths->clear();
-        pKmerPaths->resize(reads.size());
-    }
-
-    size_t nKmers = reads.getKmerCount(BIGK);
-    if (!nKmers) {
-        pHBV->Clear();
-        if (pHKP) pHKP->Clear();
-        return;
-    }
-    BigDict<BIGK> bigDict(nKmers / coverage);
-
-
-    #pragma omp parallel
-    {
-        BigKMerizer<BIGK> tkmerizer(&bigDict);
-        #pragma omp for schedule (dynamic, 1)
-        for (auto i = 0; i < reads.size(); i++) {
-            tkmerizer.kmerize(reads[i]);
-        }
-    }
-
     vecbvec edges;
-    edges.reserve(bigDict.size()/100);
-    BigKEdgeBuilder<BIGK>::buildEdges(bigDict,&edges);
-    AssertEq(edges.getKmerCount(BIGK),bigDict.size());
+    edges.reserve(dict.size()/100);
+    BigKEdgeBuilder<BIGK,Dict>::buildEdges(dict,&edges);
+    AssertEq(edges.getKmerCount(BIGK),dict.size());
     std::vector<int> fwdXlat;
     std::vector<int> revXlat;
     if ( !pReadPaths && !pKmerPaths )
@@ -504,9 +563,9 @@ void readsToHBV( vecbvec const& reads, unsigned coverage,
     }
     else
     {
-        #pragma omp parallel
+        #pragma omp parallel if(parallel)
         {
-            BigKMerizer<BIGK> tkmerizer(&bigDict);
+            BigKMerizer<BIGK,Dict> tkmerizer(&dict);
             #pragma omp for schedule (dynamic, 1)
             for (auto i = 0; i < edges.size(); i++) {
                 tkmerizer.updateDict(edges[i]);
@@ -523,10 +582,10 @@ void readsToHBV( vecbvec const& reads, unsigned coverage,
 
 
         //TODO: change for OMP, it only updates preadPaths and pKmerPaths
-        Pather<BIGK> pather(reads, bigDict, edges, fwdXlat, revXlat,
+        Pather<BIGK,Dict> pather(reads, dict, edges, fwdXlat, revXlat,
                             pReadPaths, pHKP, pKmerPaths);
         //parallelForBatch(0ul, reads.size(), 10000, pather);
-#pragma omp parallel
+#pragma omp parallel if(parallel)
         {
             auto p=pather;
 #pragma omp for
@@ -536,6 +595,52 @@ void readsToHBV( vecbvec const& reads, unsigned coverage,
     }
 }
 
+template <unsigned BIGK>
+void readsToHBV( vecbvec const& reads, unsigned coverage,
+                    HyperBasevector* pHBV, ReadPathVec* pReadPaths,
+                    HyperKmerPath* pHKP, vecKmerPath* pKmerPaths ) {
+    if (pReadPaths) {
+        pReadPaths->clear();
+        pReadPaths->resize(reads.size());
+    }
+    if (pKmerPaths) {
+        pKmerPaths->clear();
+        pKmerPaths->resize(reads.size());
+    }
+
+    size_t nKmers = reads.getKmerCount(BIGK);
+    if (!nKmers) {
+        pHBV->Clear();
+        if (pHKP) pHKP->Clear();
+        return;
+    }
+
+    // Local assemblies pass a few hundred reads at a time, from within a
+    // parallel loop over blobs, so skip the hash table and threading.  The
+    // graph is the same either way, but its edges are numbered in a different
+    // order, so top-level callers keep the hash table.
+    if ( omp_in_parallel() && nKmers <= MAX_SMALL_DICT_KMERS ) {
+        SmallBigDict<BIGK> smallDict(reads);
+        dictToHBV<BIGK>(reads,smallDict,false,pHBV,pReadPaths,pHKP,pKmerPaths);
+        return;
+    }
+
+    BigDict<BIGK> bigDict(nKmers / coverage);
+
+
+    #pragma omp parallel
+    {
+        BigKMerizer<BIGK> tkmerizer(&bigDict);
+        #pragma omp for schedule (dynamic, 1)
+        for (auto i = 0; i < reads.size(); i++) {
+            tkmerizer.kmerize(reads[i]);
+        }
+        tkmerizer.flush();
+    }
+
+    dictToHBV<BIGK>(reads,bigDict,true,pHBV,pReadPaths,pHKP,pKmerPaths);
+}
+
 template <int BIGK>
 struct SillyFunctor
 {
@@ -27,6 +27,8 @@
 #include <limits>
 #include <ostream>
 
+template <unsigned K, class Itr, class S = unsigned long> class KMerRoller;
+
 // S must be some type of unsigned integer
 template <unsigned K, class S = unsigned long>
 class KMer
@@ -166,9 +168,15 @@ public:
     /// On return, the form will be FWD or PALINDROME.  The return value
     /// is the form of the kmer before canonicalization.
     CanonicalForm canonicalize()
-    { CanonicalForm result = getCanonicalForm();
-      if ( result == CanonicalForm::REV ) rc();
-      return result; }
+    { if ( K&1 )
+      { CanonicalForm result = getCanonicalForm();
+        if ( result == CanonicalForm::REV ) rc();
+        return result; }
+      // for even K, the bases compare as the words do
+      KMer krc(*this); krc.rc();
+      int cmp = compare(*this,krc);
+      if ( cmp > 0 ) { *this = krc; return CanonicalForm::REV; }
+      return cmp ? CanonicalForm::FWD : CanonicalForm::PALINDROME; }
 
     bool isFwd() const { return CF<K>::isFwd(begin()); }
     bool isRev() const { return CF<K>::isRev(begin()); }
@@ -206,12 +214,8 @@ public:
     { storage_type* beg(mVal);
       storage_type* end(beg+STORAGE_UNITS_PER_KMER);
       if ( STORAGE_UNITS_PER_KMER != 1 ) std::reverse(beg,end);
-      while ( beg != end )
-      { unsigned char* i1(reinterpret_cast<unsigned char*>(beg));
-        unsigned char* e1(reinterpret_cast<unsigned char*>(++beg));
-        while ( i1 != e1 )
-        { unsigned char tmp = Base::rcByte(*--e1);
-          *e1 = Base::rcByte(*i1); *i1++ = tmp; } }
+      for ( storage_type* itr(beg); itr != end; ++itr )
+        *itr = rcUnit(*itr);
       if ( UNUSED_TRAILING_BITS )
       { if ( STORAGE_UNITS_PER_KMER == 1 )
           mVal[0] = mVal[0] << UNUSED_TRAILING_BITS;
@@ -239,19 +243,8 @@ public:
 
     template <class Itr, class OItr>
     static void kmerize( Itr beg, Itr const& end, OItr out )
-    { using std::distance;
-      if ( distance(beg, end) >= K )
-      { KMer kkk(beg);
-        KMer krc(kkk); krc.rc();
-        Itr itr(beg + K);
-        if ( K&1 ) *out = kkk.isRev() ? krc : kkk;
-        else *out = krc < kkk ? krc : kkk;
-        while ( itr != end )
-        { kkk.toSuccessor(*itr); krc.toPredecessor(*itr ^ 3);
-          ++itr; ++out;
-          if ( K&1 ) *out = kkk.isRev() ? krc : kkk;
-          else *out = krc < kkk ? krc : kkk; }
-        ++out; } }
+    { for ( KMerRoller<K,Itr,S> roller(beg,end); roller; ++roller )
+      { *out = roller.getCanonical(); ++out; } }
 
     template <class Itr, class OItr>
     static void kmerizeNonCanonically( Itr beg, Itr const& end,
@@ -341,6 +334,21 @@ private:
     static unsigned const SHIFT_LSBASE_TO_MSBASE =
             BITS_PER_BASE*(BASES_PER_STORAGE_UNIT-1u);
 
+    // Reverse-complements the bases of a storage unit in registers:
+    // complement, swap the bases in each nibble and the nibbles in each byte,
+    // and then reverse the bytes.
+    static storage_type rcUnit( storage_type val )
+    { storage_type const PAIRS = ~storage_type(0)/15*3; // 0x33...
+      storage_type const NIBBLES = ~storage_type(0)/17; // 0x0f...
+      val = ~val;
+      val = ((val >> 2) & PAIRS) | ((val & PAIRS) << 2);
+      val = ((val >> 4) & NIBBLES) | ((val & NIBBLES) << 4);
+      switch ( sizeof(storage_type) )
+      { case 8: return __builtin_bswap64(val);
+        case 4: return __builtin_bswap32(val);
+        case 2: return __builtin_bswap16(val); }
+      return val; }
+
     void unused()
     {
         STATIC_ASSERT(K > 0u);
@@ -364,4 +372,58 @@ template <unsigned K, class S>
 struct Serializability< KMer<K,S> >
 { typedef TriviallySerializable type; };
 
+/// Walks the kmers of a sequence, keeping both the kmer and its reverse
+/// complement up to date a base at a time, so that neither has to be rebuilt
+/// from K bases at each step.  Use like this:
+///   for ( KMerRoller<K,Itr> roller(beg,end); roller; ++roller )
+///     doSomething(roller.getCanonical());
+template <unsigned K, class Itr, class S>
+class KMerRoller
+{
+public:
+    typedef KMer<K,S> kmer_type;
+
+    KMerRoller( Itr beg, Itr const& end )
+    : mNext(beg), mEnd(end), mOffset(0)
+    { using std::distance;
+      mValid = distance(beg,end) >= K;
+      if ( mValid )
+      { mFwd.assign(mNext); mRC = mFwd; mRC.rc(); mNext += K; setRev(); } }
+
+    // compiler-supplied copying and destructor are OK
+
+    /// False when we've walked off the end of the sequence.
+    explicit operator bool() const { return mValid; }
+
+    KMerRoller& operator++()
+    { if ( mNext == mEnd ) mValid = false;
+      else
+      { unsigned char base = *mNext; ++mNext; ++mOffset;
+        mFwd.toSuccessor(base); mRC.toPredecessor(base^3); setRev(); }
+      return *this; }
+
+    kmer_type const& getFwd() const { return mFwd; }
+    kmer_type const& getRC() const { return mRC; }
+
+    /// True if the reverse complement is the canonical form.  For even K this
+    /// agrees with getCanonicalForm() because the bases compare as the words
+    /// do, and palindromes count as forward.
+    bool isRev() const { return mRev; }
+    kmer_type const& getCanonical() const { return mRev ? mRC : mFwd; }
+
+    /// Offset of the current kmer in the sequence.
+    size_t getOffset() const { return mOffset; }
+
+private:
+    void setRev() { mRev = (K&1) ? mFwd.isRev() : mRC < mFwd; }
+
+    kmer_type mFwd;
+    kmer_type mRC;
+    Itr mNext;
+    Itr mEnd;
+    size_t mOffset;
+    bool mRev;
+    bool mValid;
+};
+
 #endif /* KMER_H_ */
@@ -200,6 +200,28 @@ public:
                             KMer<K>(kmer).rc() :
                             kmer ); }
 
+    /// Looks up each kmer of the sequence [beg,end) in turn, and calls
+    /// func(pEntry,isRev) with a null pEntry if it isn't in the dictionary,
+    /// until func returns false.  A few kmers ahead are hashed and their slots
+    /// prefetched, so that a run of lookups doesn't stall on each one.
+    template <class Itr, class Func>
+    void findEntries( Itr beg, Itr const& end, Func func ) const
+    { unsigned const AHEAD = 8;
+      KMer<K> kmers[AHEAD]; size_t hashes[AHEAD]; bool revs[AHEAD];
+      KMerRoller<K,Itr> roller(beg,end);
+      unsigned nIn = 0, nOut = 0;
+      auto stage = [&]( unsigned slot )
+      { kmers[slot] = roller.getCanonical(); revs[slot] = roller.isRev();
+        hashes[slot] = kmers[slot].hash(); mKSet.prefetch(hashes[slot]);
+        ++roller; };
+      for ( ; nIn != AHEAD && roller; ++nIn ) stage(nIn);
+      while ( nOut != nIn )
+      { unsigned slot = nOut++ % AHEAD;
+        Entry const* pEnt = mKSet.lookup(hashes[slot],kmers[slot]);
+        bool rev = revs[slot];
+        if ( roller ) stage(nIn++ % AHEAD);
+        if ( !func(pEnt,rev) ) break; } }
+
     /// Applies functor to entry, which will be added if not present.
     template <class Func>
     void applyCanonical( KMer<K> const& kmer, Func const& func )
@@ -233,6 +255,12 @@ public:
     void insertEntryNoLocking( Entry const& entry )
     { mKSet.insertUniqueValueNoLocking(entry); }
 
+    /// Inserts canonical, novel entries from all threads:  gen(idx,entry)
+    /// makes the idx'th of nnn entries, or returns false to skip it.
+    template <class Gen>
+    void insertEntries( size_t nnn, Gen const& gen )
+    { mKSet.insertUniqueValues(nnn,gen); }
+
     class BadKmerCountFunctor
     {
     public:
@@ -0,0 +1,338 @@
+//
+// w2rap-bench: runs the contigger's steps on a synthetic genome with a fixed
+// seed, and reports the time, throughput and peak memory of each step and of
+// its main kernels, so performance changes can be measured without real data.
+//
+#include <paths/long/large/Repath.h>
+#include <paths/long/large/Clean200.h>
+#include <paths/long/large/Simplify.h>
+#include <paths/long/large/MakeGaps.h>
+#include "MainTools.h"
+#include "ParallelVecUtilities.h"
+#include "feudal/PQVec.h"
+#include "paths/HyperBasevector.h"
+#include "paths/long/BuildReadQGraph.h"
+#include "paths/long/LargeKDispatcher.h"
+#include "paths/long/large/AssembleGaps.h"
+#include "paths/long/large/ExtractReads.h"
+#include "paths/simulation/SyntheticGenome.h"
+#include "system/HugePages.h"
+#include "system/MemoryGovernor.h"
+#include "system/NumaPolicy.h"
+#include "tclap/CmdLine.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <fstream>
+#include "GFADump.h"
+
+// Times one kernel from construction to report(), which prints a line
+//   BENCH <kernel> <wall s> <cpu s> <items> <unit> <items per s> <peak GB>
+// to stdout and to the report file.  The peak is the process's high-water
+// mark so far, as the kernel can't be reset.
+class bench_timer
+{
+public:
+    bench_timer( std::ostream& report, std::string const& kernel )
+    : mReport(report), mKernel(kernel), mWall(WallClockTime()),
+      mCPU(double(clock())/CLOCKS_PER_SEC)
+    {}
+
+    void report( int64_t items, std::string const& unit )
+    {
+        double wall = WallClockTime()-mWall;
+        double cpu = double(clock())/CLOCKS_PER_SEC-mCPU;
+        std::ostringstream line;
+        line << "BENCH\t" << mKernel << std::fixed << std::setprecision(3)
+             << '\t' << wall << '\t' << cpu << '\t' << items << '\t' << unit
+             << '\t' << std::setprecision(1) << (wall > 0 ? items/wall : 0.)
+             << '\t' << std::setprecision(3) << PeakMemUsageGB()
+             << '\t' << HugePages::backedBytes()/(1024.*1024.*1024.);
+        std::cout << line.str() << std::endl;
+        mReport << line.str() << std::endl;
+    }
+
+    static void header( std::ostream& report )
+    {
+        std::string line = "BENCH\tkernel\twall_s\tcpu_s\titems\tunit\titems_per_s\tpeak_gb\thuge_gb";
+        std::cout << line << std::endl;
+        report << line << std::endl;
+    }
+
+private:
+    std::ostream& mReport;
+    std::string mKernel;
+    double mWall;
+    double mCPU;
+};
+
+// Writes the simulated pairs as the two FASTQ files of a paired library.
+void WriteFastqPairs( vecbvec const& bases, vecqvec const& quals,
+                      std::string const& r1, std::string const& r2 )
+{
+    std::ofstream out[2] = { std::ofstream(r1), std::ofstream(r2) };
+    for ( size_t i = 0; i != bases.size(); ++i )
+    {
+        std::ofstream& os = out[i&1];
+        os << "@sim" << i/2 << '/' << (i&1)+1 << '\n' << bases[i].ToString() << "\n+\n";
+        for ( auto q : quals[i] )
+            os << char(q+33);
+        os << '\n';
+    }
+    for ( auto& os : out )
+    {
+        os.close();
+        if ( !os ) FatalErr("Writing simulated reads to " << r1 << " and " << r2 << " failed.");
+    }
+}
+
+int64_t TotalBases( vecbvec const& bases )
+{
+    int64_t total = 0;
+    for ( auto const& b : bases ) total += b.size();
+    return total;
+}
+
+int main(const int argc, const char * argv[]) {
+
+    std::string out_dir;
+    std::string tmp_dir;
+    unsigned int threads, seed, to_step, disk_batches, pair_sample;
+    unsigned int large_K, small_K = 60, minFreq = 4, minQual = 7, min_size = 0;
+    int max_mem;
+    NumaPolicy::Policy numa;
+    bool huge_pages;
+    genome_params gp;
+    read_params rp;
+
+    //========== Command Line Option Parsing ==========
+    for (auto i=0;i<argc;i++) std::cout<<argv[i]<<" ";
+    std::cout<<std::endl<<std::endl;
+    std::cout << "Welcome to w2rap-bench" << std::endl;
+
+    try {
+        TCLAP::CmdLine cmd("", ' ', "0.1");
+        TCLAP::ValueArg<unsigned int> threadsArg("t", "threads",
+             "Number of threads on parallel sections (default: 4)", false, 4, "int", cmd);
+        TCLAP::ValueArg<unsigned int> max_memArg("m", "max_mem",
+             "Maximum memory in GB (soft limit, impacts performance, default 10000)", false, 10000, "int", cmd);
+        TCLAP::ValueArg<std::string> out_dirArg("o", "out_dir", "Work dir for the simulated reads and the assembly", true, "", "string", cmd);
+        TCLAP::ValueArg<std::string> tmp_dirArg("", "tmp_dir",
+             "tmp dir for disk batches and spilled intermediates (default: workdir)", false, "", "string", cmd);
+        TCLAP::ValueArg<unsigned int> seedArg("", "seed", "Seed for the genome and the reads (default: 1)", false, 1, "int", cmd);
+        std::vector<unsigned int> allowed_steps = {1,2,3,4,5,6,7};
+        TCLAP::ValuesConstraint<unsigned int> steps(allowed_steps);
+        TCLAP::ValueArg<unsigned int> toStep_Arg("", "to_step", "Stop after step (default: 7)", false, 7, &steps, cmd);
+        std::vector<unsigned int> allowed_k = BigK::values(60, 640);
+        TCLAP::ValuesConstraint<unsigned int> largeKconst(allowed_k);
+        TCLAP::ValueArg<unsigned int> large_KArg("K", "large_k", "Large k (default: 200)", false, 200, &largeKconst, cmd);
+        TCLAP::ValueArg<unsigned int> disk_batchesArg("d", "disk_batches",
+             "number of disk batches for step2 (default: 0, in memory)", false, 0, "int", cmd);
+        TCLAP::ValueArg<unsigned int> pairSampleArg("", "pair_sample",
+             "max number of read pairs to use in local assemblies on step 5 (default: 200)", false, 200, "int", cmd);
+        TCLAP::ValueArg<std::string> numaArg("", "numa",
+             "NUMA memory policy: default, interleave or first_touch (default: default)", false, "default", "string", cmd);
+        TCLAP::ValueArg<bool> hugePagesArg("", "huge_pages",
+             "Put the big arrays on transparent huge pages (default: 0)", false, false, "bool", cmd);
+
+        TCLAP::ValueArg<size_t> genomeSizeArg("g", "genome_size", "Bases in each haplotype (default: 2000000)", false, gp.size, "int", cmd);
+        TCLAP::ValueArg<double> repeatFracArg("", "repeat_frac", "Fraction of the genome in repeats (default: .05)", false, gp.repeat_frac, "float", cmd);
+        TCLAP::ValueArg<int> repeatLenArg("", "repeat_len", "Length of a repeat unit (default: 1000)", false, gp.repeat_len, "int", cmd);
+        TCLAP::ValueArg<int> repeatCopiesArg("", "repeat_copies", "Copies of each repeat unit (default: 4)", false, gp.repeat_copies, "int", cmd);
+        TCLAP::ValueArg<double> repeatDivArg("", "repeat_div", "Divergence between repeat copies (default: .005)", false, gp.repeat_div, "float", cmd);
+        TCLAP::ValueArg<double> hetArg("", "het", "SNP rate between haplotypes (default: .001)", false, gp.het, "float", cmd);
+        TCLAP::ValueArg<int> ploidyArg("", "ploidy", "Number of haplotypes (default: 2)", false, gp.ploidy, "int", cmd);
+
+        TCLAP::ValueArg<double> coverageArg("c", "coverage", "Read coverage of one haplotype (default: 30)", false, rp.coverage, "float", cmd);
+        TCLAP::ValueArg<int> readLenArg("", "read_len", "Read length (default: 150)", false, rp.read_len, "int", cmd);
+        TCLAP::ValueArg<int> insertMeanArg("", "insert_mean", "Mean fragment length (default: 450)", false, rp.insert_mean, "int", cmd);
+        TCLAP::ValueArg<int> insertSdArg("", "insert_sd", "Fragment length sd (default: 50)", false, rp.insert_sd, "int", cmd);
+        TCLAP::ValueArg<double> errorRateArg("", "error_rate", "Per-base substitution rate (default: .002)", false, rp.error_rate, "float", cmd);
+
+        cmd.parse(argc, argv);
+        out_dir = out_dirArg.getValue();
+        tmp_dir = tmp_dirArg.getValue();
+        threads = threadsArg.getValue();
+        max_mem = max_memArg.getValue();
+        seed = seedArg.getValue();
+        to_step = toStep_Arg.getValue();
+        large_K = large_KArg.getValue();
+        disk_batches = disk_batchesArg.getValue();
+        pair_sample = pairSampleArg.getValue();
+        gp.size = genomeSizeArg.getValue();
+        gp.repeat_frac = repeatFracArg.getValue();
+        gp.repeat_len = repeatLenArg.getValue();
+        gp.repeat_copies = repeatCopiesArg.getValue();
+        gp.repeat_div = repeatDivArg.getValue();
+        gp.het = hetArg.getValue();
+        gp.ploidy = ploidyArg.getValue();
+        rp.coverage = coverageArg.getValue();
+        rp.read_len = readLenArg.getValue();
+        rp.insert_mean = insertMeanArg.getValue();
+        rp.insert_sd = insertSdArg.getValue();
+        rp.error_rate = errorRateArg.getValue();
+        if (disk_batches>=AUTO_DISK_BATCHES)
+            throw TCLAP::ArgException("must be below "+std::to_string(AUTO_DISK_BATCHES),"disk_batches");
+        if (!NumaPolicy::parse(numaArg.getValue(), numa))
+            throw TCLAP::ArgException("must be default, interleave or first_touch","numa");
+        huge_pages = hugePagesArg.getValue();
+    } catch (TCLAP::ArgException &e)  // catch any exceptions
+    {
+        std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+        return 1;
+    }
+
+    struct stat info;
+    if (stat(out_dir.c_str(), &info) != 0 || !(info.st_mode & S_IFDIR)) {
+        std::cout << "Output directory doesn't exist, or is not a directory: " << out_dir << std::endl;
+        return 1;
+    }
+
+    SetThreads(threads, False);
+    SetMaxMemory(int64_t(round(max_mem * 1024.0 * 1024.0 * 1024.0)));
+    MemoryGovernor::setSpillDir(tmp_dir.empty() ? out_dir : tmp_dir);
+    numa = NumaPolicy::set(numa);
+    huge_pages = HugePages::enable(huge_pages);
+
+    std::ofstream report(out_dir + "/bench.tsv");
+    std::ostringstream setup;
+    setup << "# threads " << threads << ", numa policy " << NumaPolicy::name(numa)
+          << " on " << NumaPolicy::nNodes() << " node(s), huge pages "
+          << (huge_pages ? "on" : "off");
+    std::cout << setup.str() << std::endl;
+    report << setup.str() << std::endl;
+    bench_timer::header(report);
+
+    int MAX_CELL_PATHS = 50;
+    int MAX_DEPTH = 10;
+    vec<String> subsam_names = {"C"};
+    vec<int64_t> subsam_starts = {0};
+
+    //== Simulate the genome and the reads, and write them as FASTQ ======
+    std::string const r1 = out_dir + "/bench_R1.fastq", r2 = out_dir + "/bench_R2.fastq";
+    {
+        RNGen rng(seed);
+        vecbvec haplotypes;
+        bench_timer genome(report, "SimulateGenome");
+        SimulateGenome(gp, rng, haplotypes);
+        genome.report(TotalBases(haplotypes), "bases");
+
+        vecbvec simBases;
+        vecqvec simQuals;
+        bench_timer reads(report, "SimulatePairs");
+        SimulatePairs(haplotypes, rp, rng, simBases, simQuals);
+        reads.report(simBases.size(), "reads");
+        WriteFastqPairs(simBases, simQuals, r1, r2);
+    }
+
+    //== Step 1 ======
+    vecbvec bases;
+    VecPQVec quals;
+    bench_timer step1(report, "step1.ExtractReads");
+    ExtractReads(r1 + "," + r2, out_dir, subsam_names, subsam_starts, &bases, &quals);
+    int64_t readBases = TotalBases(bases);
+    step1.report(readBases, "bases");
+
+    vec<int> inv;
+    HyperBasevector hbvr;
+    ReadPathVec pathsr;
+    VecULongVec paths_inv;
+
+    //== Steps 2 and 3 ======
+    if (to_step>=2) {
+        HyperBasevector hbv;
+        ReadPathVec paths;
+        bench_timer step2(report, "step2.buildReadQGraph");
+        buildReadQGraph(bases, quals, False, False, minQual, minFreq, .75, 0, &hbv, &paths, small_K, out_dir, tmp_dir, disk_batches);
+        step2.report(readBases, "bases");
+        bench_timer fix(report, "step2.FixPaths");
+        FixPaths(hbv, paths);
+        fix.report(paths.size(), "paths");
+
+        if (to_step>=3) {
+            bench_timer invSmall(report, "step3.invert");
+            VecULongVec small_inv;
+            invert(paths, small_inv, hbv.EdgeObjectCount());
+            invSmall.report(paths.size(), "paths");
+
+            bench_timer step3(report, "step3.RepathInMemory");
+            vecbvec edges(hbv.Edges().begin(), hbv.Edges().end());
+            inv.clear();
+            hbv.Involution(inv);
+            pathsr.resize(paths.size());
+            RepathInMemory(hbv, edges, inv, paths, hbv.K(), large_K, hbvr, pathsr, True, True, False);
+            step3.report(paths.size(), "paths");
+        }
+    }
+
+    //== Step 4 ======
+    if (to_step>=4) {
+        bench_timer step4(report, "step4.Clean200x");
+        int64_t edges = hbvr.EdgeObjectCount();
+        inv.clear();
+        hbvr.Involution(inv);
+        Clean200x(hbvr, inv, pathsr, bases, quals, 0, 3, min_size);
+        step4.report(edges, "edges");
+    }
+
+    //== Step 5 ======
+    if (to_step>=5) {
+        bench_timer invLarge(report, "step5.invert");
+        invert(pathsr, paths_inv, hbvr.EdgeObjectCount());
+        invLarge.report(pathsr.size(), "paths");
+
+        vecbvec new_stuff;
+        std::vector<int> k2floor_sequence={0, 100, 128, 144, 172, 200};
+        bench_timer gaps(report, "step5.AssembleGaps2");
+        int64_t edges = hbvr.EdgeObjectCount();
+        AssembleGaps2(hbvr, inv, pathsr, paths_inv, bases, quals, out_dir, k2floor_sequence,
+                      new_stuff, True, 5, 400, 400, 100000, pair_sample);
+        gaps.report(edges, "edges");
+
+        const vec<int> TRACE_PATHS;
+        bench_timer addNew(report, "step5.AddNewStuff");
+        int64_t patches = new_stuff.size();
+        AddNewStuff(new_stuff, hbvr, inv, pathsr, bases, quals, 5, TRACE_PATHS, out_dir, 1);
+        PartnersToEnds(hbvr, pathsr, bases, quals);
+        addNew.report(patches, "patches");
+    }
+
+    //== Step 6 ======
+    vec<vec<vec<vec<int>>>> lines;
+    if (to_step>=6) {
+        const vec<int> PULL_APART_TRACE;
+        bench_timer step6(report, "step6.Simplify");
+        int64_t edges = hbvr.EdgeObjectCount();
+        Simplify(out_dir, hbvr, inv, pathsr, bases, quals, 0, True, 8, 200, False, "", True, True, 1,
+                 False, PULL_APART_TRACE, 1, 2.5, True, False, True, True, False, False);
+        step6.report(edges, "edges");
+
+        for (size_t i = 0; i < pathsr.size(); i++) {
+            Bool bad = False;
+            for (size_t j = 0; j < pathsr[i].size(); j++)
+                if (pathsr[i][j] < 0) bad = True;
+            if (bad) pathsr[i].resize(0);
+        }
+        paths_inv.clear();
+        invert(pathsr, paths_inv, hbvr.EdgeObjectCount());
+
+        bench_timer findLines(report, "step6.FindLines");
+        FindLines(hbvr, inv, lines, MAX_CELL_PATHS, MAX_DEPTH);
+        findLines.report(hbvr.EdgeObjectCount(), "edges");
+
+        bench_timer gfa(report, "step6.GFADump");
+        GFADump(out_dir + "/bench_contigs", hbvr, inv, pathsr, MAX_CELL_PATHS, MAX_DEPTH, true, &lines);
+        gfa.report(hbvr.EdgeObjectCount(), "edges");
+    }
+
+    //== Step 7 ======
+    if (to_step>=7) {
+        bench_timer step7(report, "step7.MakeGaps");
+        int64_t edges = hbvr.EdgeObjectCount();
+        MakeGaps(hbvr, inv, pathsr, paths_inv, 5000, 3, out_dir, "bench", False, True);
+        step7.report(edges, "edges");
+    }
+
+    report.close();
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <paths/long/large/Simplify.h>
 #include <paths/long/large/MakeGaps.h>
 #include <paths/long/large/FinalFiles.h>
+#include <paths/long/large/PathStats.h>
 #include "FastIfstream.h"
 #include "FetchReads.h"
 #include "MainTools.h"
@@ -15,15 +16,22 @@
 #include "paths/HyperBasevector.h"
 #include "paths/RemodelGapTools.h"
 #include "paths/long/BuildReadQGraph.h"
+#include "paths/long/LargeKDispatcher.h"
 //#include "paths/long/PlaceReads0.h"
 #include "paths/long/SupportedHyperBasevector.h"
 #include "paths/long/large/AssembleGaps.h"
 #include "paths/long/large/ExtractReads.h"
+#include "system/BackgroundWriter.h"
+#include "system/HugePages.h"
+#include "system/MemoryGovernor.h"
+#include "system/NumaPolicy.h"
 #include "tclap/CmdLine.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <sys/time.h>
+#include <memory>
+#include <thread>
 #include <paths/PathFinder.h>
 #include <paths/long/large/ImprovePath.h>
 #include "GFADump.h"
@@ -45,6 +53,40 @@ std::string checkpoint_perf_time(const std::string section_name){
     return "TIME, "+section_name+", "+std::to_string(wtime)+", "+std::to_string(cputime);
 }
 
+// Writes a graph and its read paths to prefix.hbv and prefix.paths.  Unless
+// this is the last step, they are copied and written by the background writer
+// while the next step runs, and true is returned.  If the copies won't fit in
+// memory, they are written before returning.
+bool DumpGraphAndPaths(BackgroundWriter &writer, HyperBasevector const &hbv, ReadPathVec const &paths,
+                       std::string const &prefix, bool last_step) {
+    size_t bytes = sizeof(hbv) + paths.size() * (sizeof(ReadPath) + 16);
+    for (auto const &e : hbv.Edges()) bytes += sizeof(e) + e.size() / 4;
+    for (auto const &p : paths) bytes += p.size() * sizeof(int);
+    if (last_step || !MemoryGovernor::fits(bytes)) {
+        BinaryWriter::writeFile(prefix + ".hbv", hbv);
+        WriteReadPathVec(paths, (prefix + ".paths").c_str());
+        return false;
+    }
+    auto hbv_copy = std::make_shared<HyperBasevector>(hbv);
+    auto paths_copy = std::make_shared<ReadPathVec>(paths);
+    writer.add(prefix + ".hbv", [hbv_copy, prefix]() { BinaryWriter::writeFile(prefix + ".hbv", *hbv_copy); });
+    writer.add(prefix + ".paths", [paths_copy, prefix]() {
+        WriteReadPathVec(*paths_copy, (prefix + ".paths").c_str());
+    });
+    return true;
+}
+
+// Reads prefix.hbv and prefix.paths, one on each of two threads.
+void LoadGraphAndPaths(HyperBasevector &hbv, ReadPathVec &paths, std::string const &prefix) {
+    #pragma omp parallel sections num_threads(2)
+    {
+        #pragma omp section
+        BinaryReader::readFile(prefix + ".hbv", &hbv);
+        #pragma omp section
+        LoadReadPathVec(paths, (prefix + ".paths").c_str());
+    }
+}
+
 int main(const int argc, const char * argv[]) {
 
     std::string out_prefix;
@@ -57,11 +99,12 @@ int main(const int argc, const char * argv[]) {
     unsigned int minQual;
     int max_mem;
     unsigned int small_K, large_K, min_size,from_step,to_step, pair_sample, disk_batches;
-    std::vector<unsigned int> allowed_k = {60, 64, 72, 80, 84, 88, 96, 100, 108, 116, 128, 136, 144, 152, 160, 168, 172,
-                                           180, 188, 192, 196, 200, 208, 216, 224, 232, 240, 260, 280, 300, 320, 368,
-                                           400, 440, 460, 500, 544, 640};
+    // the large K must have a BigK dispatch, be at least the small K, and be
+    // shorter than the reads
+    std::vector<unsigned int> allowed_k = BigK::values(60, 640);
     std::vector<unsigned int> allowed_steps = {1,2,3,4,5,6,7};
-    bool extend_paths,run_pathfinder,dump_all,dump_perf,dump_pf;
+    bool extend_paths,run_pathfinder,dump_all,dump_perf,dump_pf,huge_pages;
+    NumaPolicy::Policy numa;
 
     //========== Command Line Option Parsing ==========
     for (auto i=0;i<argc;i++) std::cout<<argv[i]<<" ";
@@ -95,10 +138,14 @@ int main(const int argc, const char * argv[]) {
         TCLAP::ValueArg<unsigned int> toStep_Arg("", "to_step",
                                                    "Stop after step (default: 7)", false, 7, &steps, cmd);
 
-        TCLAP::ValueArg<unsigned int> disk_batchesArg("d", "disk_batches",
-                                                 "number of disk batches for step2 (default: 0, 0->in memory)", false, 0, "int", cmd);
+        TCLAP::ValueArg<std::string> disk_batchesArg("d", "disk_batches",
+                                                 "number of disk batches for step2 (default: 0, 0->in memory, auto->chosen from max_mem)", false, "0", "int|auto", cmd);
         TCLAP::ValueArg<std::string> tmp_dirArg("", "tmp_dir",
-                                                      "tmp dir for step2 disk batches (default: workdir)", false, "", "string", cmd);
+                                                      "tmp dir for disk batches and spilled intermediates (default: workdir)", false, "", "string", cmd);
+        TCLAP::ValueArg<std::string> numaArg("", "numa",
+                                             "NUMA memory policy: default, interleave or first_touch (default: default)", false, "default", "string", cmd);
+        TCLAP::ValueArg<bool> hugePagesArg("", "huge_pages",
+                                           "Put the big arrays on transparent huge pages (default: 0)", false, false, "bool", cmd);
         TCLAP::ValueArg<unsigned int> minSizeArg("s", "min_size",
              "Min size of disconnected elements on large_k graph (in kmers, default: 0=no min)", false, 0, "int", cmd);
         TCLAP::ValueArg<unsigned int> minFreqArg("", "min_freq",
@@ -142,8 +189,17 @@ int main(const int argc, const char * argv[]) {
         pair_sample=pairSampleArg.getValue();
         minFreq=minFreqArg.getValue();
         minQual=minQualArg.getValue();
-        disk_batches=disk_batchesArg.getValue();
+        if (disk_batchesArg.getValue()=="auto") disk_batches=AUTO_DISK_BATCHES;
+        else {
+            std::string const& db=disk_batchesArg.getValue();
+            if (db.empty() or db.find_first_not_of("0123456789")!=std::string::npos or std::stoul(db)>=AUTO_DISK_BATCHES)
+                throw TCLAP::ArgException("must be auto or a number below "+std::to_string(AUTO_DISK_BATCHES),"disk_batches");
+            disk_batches=std::stoul(db);
+        }
         tmp_dir=tmp_dirArg.getValue();
+        if (!NumaPolicy::parse(numaArg.getValue(), numa))
+            throw TCLAP::ArgException("must be default, interleave or first_touch","numa");
+        huge_pages=hugePagesArg.getValue();
 
     } catch (TCLAP::ArgException &e)  // catch any exceptions
     {
@@ -183,6 +239,11 @@ int main(const int argc, const char * argv[]) {
     //== Set computational resources ===
     SetThreads(threads, False);
     SetMaxMemory(int64_t(round(max_mem * 1024.0 * 1024.0 * 1024.0)));
+    MemoryGovernor::setSpillDir(tmp_dir.empty() ? out_dir : tmp_dir);
+    numa = NumaPolicy::set(numa);
+    std::cout << "NUMA policy: " << NumaPolicy::name(numa) << " on " << NumaPolicy::nNodes() << " node(s)" << std::endl;
+    if (huge_pages && HugePages::enable(true)) std::cout << "Big arrays on transparent huge pages" << std::endl;
+    BackgroundWriter writer;
     //TODO: try to find out max memory on the system to default to.
 
     //== Handle "special cases" to test on development==
@@ -276,13 +337,18 @@ int main(const int argc, const char * argv[]) {
 
             // XXX TODO: Solve the {} thingy, check if has any influence in the new code to run that integrated
             {
-                vec<int> llens, npairs;
+                vec<int> tol;
+                GetTol(hbvr, lines, tol);
+                LinePairStat line_pairs(inv, tol, lines.size(), subsam_starts);
+                ScanPairs(pathsr, {&line_pairs});
+                vec<int> llens, npairs = line_pairs.total();
                 GetLineLengths(hbvr, lines, llens);
-                GetLineNpairs(hbvr, inv, pathsr, lines, npairs);
                 BinaryWriter::writeFile(out_dir + "/" + out_prefix + ".fin.lines.npairs", npairs);
 
+                VecULongVec paths_index;
+                invert(pathsr, paths_index, hbvr.EdgeObjectCount());
                 vec<vec<covcount>> covs;
-                ComputeCoverage(hbvr, inv, pathsr, lines, subsam_starts, covs);
+                ComputeCoverage(hbvr, inv, pathsr, paths_index, lines, subsam_starts, line_pairs.npairs(), covs);
 
             }
 
@@ -291,7 +357,7 @@ int main(const int argc, const char * argv[]) {
             BinaryWriter::writeFile(out_dir + "/" + out_prefix + ".contig.hbv", hbvr);
             WriteReadPathVec(pathsr,(out_dir + "/" + out_prefix + ".contig.paths").c_str());
             std::cout << "   DONE!" << std::endl;
-            GFADump(out_dir +"/"+ out_prefix + "_contigs", hbvr, inv, pathsr, MAX_CELL_PATHS, MAX_DEPTH, true);
+            GFADump(out_dir +"/"+ out_prefix + "_contigs", hbvr, inv, pathsr, MAX_CELL_PATHS, MAX_DEPTH, true, &lines);
 
         }
     }
@@ -303,31 +369,49 @@ int main(const int argc, const char * argv[]) {
     }
     if (dump_perf) checkpoint_perf_time(""); //initialisation!
 
+    // The reads are written out while step 2 builds the first graph from
+    // them; both only read them.  Joined once step 2 is done.
+    std::thread dump_reads;
     if (from_step==1)
     {
         std::cout << "--== Step 1: Reading input files ==--" << std::endl;
+        MemoryGovernor::Phase mem_phase("step 1");
         ExtractReads(read_files, out_dir, subsam_names, subsam_starts, &bases, &quals);
         std::cout << "Reading input files DONE!" << std::endl << std::endl << std::endl;
         if (dump_perf) perf_file << checkpoint_perf_time("ExtractReads") << std::endl;
         //TODO: add an option to dump the reads
         if (dump_all || to_step<6) {
-            std::cout << "Dumping reads in fastb/qualp format..." << std::endl;
-            bases.WriteAll(out_dir + "/frag_reads_orig.fastb");
-            quals.WriteAll(out_dir + "/frag_reads_orig.qualp");
-            std::cout << "   DONE!" << std::endl;
-            if (dump_perf) perf_file << checkpoint_perf_time("DumpReads") << std::endl;
+            std::cout << "Dumping reads in fastb/qualp format in the background..." << std::endl;
+            dump_reads = std::thread([&bases, &quals, &out_dir]() {
+                bases.WriteAll(out_dir + "/frag_reads_orig.fastb");
+                quals.WriteAll(out_dir + "/frag_reads_orig.qualp");
+            });
         }
     }
 
     //== Read QGraph, and repath (k=60, k=200 (and saves in binary format) ======
 
+    // Reads are loaded in the background while the graph is loaded and step 3,
+    // which doesn't use them, runs.  Joined before the first step that does.
+    std::thread load_reads;
     if (from_step>1 && from_step<7 and not (from_step==3 and to_step==3)){
-        std::cout << "Loading reads in fastb/qualp format..." << std::endl;
-        bases.ReadAll(out_dir + "/frag_reads_orig.fastb");
-        quals.ReadAll(out_dir + "/frag_reads_orig.qualp");
-        std::cout << "   DONE!" << std::endl;
-        if (dump_perf) perf_file << checkpoint_perf_time("LoadReads") << std::endl;
+        std::cout << "Loading reads in fastb/qualp format in the background..." << std::endl;
+        load_reads = std::thread([&bases, &quals, &out_dir]() {
+            #pragma omp parallel sections num_threads(2)
+            {
+                #pragma omp section
+                bases.ReadAll(out_dir + "/frag_reads_orig.fastb");
+                #pragma omp section
+                quals.ReadAll(out_dir + "/frag_reads_orig.qualp");
+            }
+        });
     }
+    auto wait_for_reads = [&]() {
+        if (!load_reads.joinable()) return;
+        load_reads.join();
+        std::cout << "Loading reads in fastb/qualp format DONE!" << std::endl;
+        if (dump_perf) perf_file << checkpoint_perf_time("LoadReads") << std::endl;
+    };
     {//This scope-trick to invalidate old data is dirty
 
         HyperBasevector hbv;
@@ -335,6 +419,8 @@ int main(const int argc, const char * argv[]) {
         if (from_step<=2 and to_step>=2) {
             bool FILL_JOIN = False;
             std::cout << "--== Step 2: Building first (small K) graph ==--" << std::endl;
+            wait_for_reads();
+            MemoryGovernor::Phase mem_phase("step 2");
             buildReadQGraph(bases, quals, FILL_JOIN, FILL_JOIN, minQual, minFreq, .75, 0, &hbv, &paths, small_K, out_dir,tmp_dir,disk_batches);
             if (dump_perf) perf_file << checkpoint_perf_time("buildReadQGraph") << std::endl;
             FixPaths(hbv, paths); //TODO: is this even needed?
@@ -342,22 +428,26 @@ int main(const int argc, const char * argv[]) {
             std::cout << "Building first graph DONE!" << std::endl << std::endl << std::endl;
             if (dump_all || to_step ==2){
                 std::cout << "Dumping small_K graph and paths..." << std::endl;
-                BinaryWriter::writeFile(out_dir + "/" + out_prefix + ".small_K.hbv", hbv);
-                WriteReadPathVec(paths,(out_dir + "/" + out_prefix + ".small_K.paths").c_str());
-                std::cout << "   DONE!" << std::endl;
+                bool queued = DumpGraphAndPaths(writer, hbv, paths, out_dir + "/" + out_prefix + ".small_K", to_step == 2);
+                std::cout << (queued ? "   queued." : "   DONE!") << std::endl;
                 if (dump_perf) perf_file << checkpoint_perf_time("SmallKDump") << std::endl;
             }
         }
+        if (dump_reads.joinable()) {
+            dump_reads.join();
+            std::cout << "Dumping reads in fastb/qualp format DONE!" << std::endl;
+            if (dump_perf) perf_file << checkpoint_perf_time("DumpReads") << std::endl;
+        }
 
         if (from_step==3){
             std::cout << "Reading small_K graph and paths..." << std::endl;
-            BinaryReader::readFile(out_dir + "/" + out_prefix + ".small_K.hbv", &hbv);
-            LoadReadPathVec(paths,(out_dir + "/" + out_prefix + ".small_K.paths").c_str());
+            LoadGraphAndPaths(hbv, paths, out_dir + "/" + out_prefix + ".small_K");
             std::cout << "   DONE!" << std::endl;
             if (dump_perf) perf_file << std::endl << checkpoint_perf_time("SmallKLoad") << std::endl;
         }
         if (from_step<=3 and to_step>=3) {
             std::cout << "--== Step 3: Repathing to second (large K) graph ==--" << std::endl;
+            MemoryGovernor::Phase mem_phase("step 3");
             vecbvec edges(hbv.Edges().begin(), hbv.Edges().end());
             inv.clear();
             hbv.Involution(inv);
@@ -373,25 +463,26 @@ int main(const int argc, const char * argv[]) {
             std::cout << "Repathing to second graph DONE!" << std::endl << std::endl << std::endl;
             if (dump_all || to_step ==3){
                 std::cout << "Dumping large_K graph and paths..." << std::endl;
-                BinaryWriter::writeFile(out_dir + "/" + out_prefix + ".large_K.hbv", hbvr);
-                WriteReadPathVec(pathsr,(out_dir + "/" + out_prefix + ".large_K.paths").c_str());
-                std::cout << "   DONE!" << std::endl;
+                bool queued = DumpGraphAndPaths(writer, hbvr, pathsr, out_dir + "/" + out_prefix + ".large_K", to_step == 3);
+                std::cout << (queued ? "   queued." : "   DONE!") << std::endl;
                 if (dump_perf) perf_file << checkpoint_perf_time("LargeKDump") << std::endl;
             }
         }
 
     }
 
+    wait_for_reads();
+
     //== Clean ======
     if (from_step==4){
         std::cout << "Reading large_K graph and paths..." << std::endl;
-        BinaryReader::readFile(out_dir + "/" + out_prefix + ".large_K.hbv", &hbvr);
-        LoadReadPathVec(pathsr,(out_dir + "/" + out_prefix + ".large_K.paths").c_str());
+        LoadGraphAndPaths(hbvr, pathsr, out_dir + "/" + out_prefix + ".large_K");
         std::cout << "   DONE!" << std::endl;
         if (dump_perf) perf_file << std::endl << checkpoint_perf_time("LargeKLoad") << std::endl;
     }
     if (from_step<=4 and to_step>=4) {
         std::cout << "--== Step 4: Cleaning graph ==--" << std::endl;
+        MemoryGovernor::Phase mem_phase("step 4");
         inv.clear();
         hbvr.Involution(inv);
         int CLEAN_200_VERBOSITY = 0;
@@ -401,9 +492,8 @@ int main(const int argc, const char * argv[]) {
         std::cout << "Cleaning graph DONE!" << std::endl<< std::endl<< std::endl;
         if (dump_all || to_step ==4){
             std::cout << "Dumping large_K clean graph and paths..." << std::endl;
-            BinaryWriter::writeFile(out_dir + "/" + out_prefix + ".large_K.clean.hbv", hbvr);
-            WriteReadPathVec(pathsr,(out_dir + "/" + out_prefix + ".large_K.clean.paths").c_str());
-            std::cout << "   DONE!" << std::endl;
+            bool queued = DumpGraphAndPaths(writer, hbvr, pathsr, out_dir + "/" + out_prefix + ".large_K.clean", to_step == 4);
+            std::cout << (queued ? "   queued." : "   DONE!") << std::endl;
             if (dump_perf) perf_file << checkpoint_perf_time("LargeKCleanDump") << std::endl;
         }
     }
@@ -414,8 +504,7 @@ int main(const int argc, const char * argv[]) {
 
     if (from_step==5){
         std::cout << "Reading large_K clean graph and paths..." << std::endl;
-        BinaryReader::readFile(out_dir + "/" + out_prefix + ".large_K.clean.hbv", &hbvr);
-        LoadReadPathVec(pathsr,(out_dir + "/" + out_prefix + ".large_K.clean.paths").c_str());
+        LoadGraphAndPaths(hbvr, pathsr, out_dir + "/" + out_prefix + ".large_K.clean");
         inv.clear();
         hbvr.Involution(inv);
         std::cout << "   DONE!" << std::endl;
@@ -423,6 +512,7 @@ int main(const int argc, const char * argv[]) {
     }
     if (from_step<=5 and to_step>=5) {
         std::cout << "--== Step 5: Assembling gaps ==--" << std::endl;
+        MemoryGovernor::Phase mem_phase("step 5");
         std::cout << Date() <<": inverting paths"<<std::endl;
         invert(pathsr, paths_inv, hbvr.EdgeObjectCount());
         if (dump_perf) perf_file << checkpoint_perf_time("Invert") << std::endl;
@@ -450,9 +540,8 @@ int main(const int argc, const char * argv[]) {
         std::cout << "Assembling gaps DONE!" << std::endl << std::endl << std::endl;
         if (dump_all || to_step ==5){
             std::cout << "Dumping large_K final graph and paths..." << std::endl;
-            BinaryWriter::writeFile(out_dir + "/" + out_prefix + ".large_K.final.hbv", hbvr);
-            WriteReadPathVec(pathsr,(out_dir + "/" + out_prefix + ".large_K.final.paths").c_str());
-            std::cout << "   DONE!" << std::endl;
+            bool queued = DumpGraphAndPaths(writer, hbvr, pathsr, out_dir + "/" + out_prefix + ".large_K.final", to_step == 5);
+            std::cout << (queued ? "   queued." : "   DONE!") << std::endl;
             if (dump_perf) perf_file << checkpoint_perf_time("LargeKFinalDump") << std::endl;
         }
 
@@ -462,8 +551,7 @@ int main(const int argc, const char * argv[]) {
 
     if (from_step==6){
         std::cout << "Reading large_K final graph and paths..." << std::endl;
-        BinaryReader::readFile(out_dir + "/" + out_prefix + ".large_K.final.hbv", &hbvr);
-        LoadReadPathVec(pathsr,(out_dir + "/" + out_prefix + ".large_K.final.paths").c_str());
+        LoadGraphAndPaths(hbvr, pathsr, out_dir + "/" + out_prefix + ".large_K.final");
         inv.clear();
         hbvr.Involution(inv);
         std::cout << "   DONE!" << std::endl;
@@ -471,6 +559,7 @@ int main(const int argc, const char * argv[]) {
     }
     if (from_step<=6 and to_step>=6) {
         std::cout << "--== Step 6: Graph simplification and path finding ==--" << std::endl;
+        MemoryGovernor::Phase mem_phase("step 6");
 
 
         //==Simplify
@@ -518,15 +607,23 @@ int main(const int argc, const char * argv[]) {
         if (dump_perf) perf_file << checkpoint_perf_time("FindLines") << std::endl;
         BinaryWriter::writeFile(out_dir + "/" + out_prefix + ".fin.lines", lines);
 
+        // One pass over the pairs gives the line pair counts and the fragment
+        // size histogram.
+        vec<int> tol;
+        GetTol(hbvr, lines, tol);
+        LinePairStat line_pairs(inv, tol, lines.size(), subsam_starts);
+        FragSizeStat frag_sizes(hbvr, inv);
+        ScanPairs(pathsr, {&line_pairs, &frag_sizes});
+        if (dump_perf) perf_file << checkpoint_perf_time("PairStats") << std::endl;
+
         // XXX TODO: Solve the {} thingy, check if has any influence in the new code to run that integrated
         {
-            vec<int> llens, npairs;
+            vec<int> llens, npairs = line_pairs.total();
             GetLineLengths(hbvr, lines, llens);
-            GetLineNpairs(hbvr, inv, pathsr, lines, npairs);
             BinaryWriter::writeFile(out_dir + "/" + out_prefix + ".fin.lines.npairs", npairs);
 
             vec<vec<covcount>> covs;
-            ComputeCoverage(hbvr, inv, pathsr, lines, subsam_starts, covs);
+            ComputeCoverage(hbvr, inv, pathsr, paths_inv, lines, subsam_starts, line_pairs.npairs(), covs);
             //BinaryWriter::writeFile( work_dir + "/" +prefix+ ".fin.covs", covs );
             //WriteLineStats( work_dir, lines, llens, npairs, covs );
 
@@ -539,27 +636,25 @@ int main(const int argc, const char * argv[]) {
 
         // TestLineSymmetry( lines, inv2 );
         // Compute fragment distribution.
-        FragDist(hbvr, inv, pathsr, out_dir + "/" + out_prefix + ".fin.frags.dist");
+        FragDist(frag_sizes.counts(), out_dir + "/" + out_prefix + ".fin.frags.dist");
         if (dump_perf) perf_file << checkpoint_perf_time("FragDist") << std::endl;
         //TODO: add contig fasta dump.
         std::cout << "Contigging DONE!" << std::endl << std::endl << std::endl;
         if (dump_all || to_step == 6){
             std::cout << "Dumping contig graph and paths..." << std::endl;
-            BinaryWriter::writeFile(out_dir + "/" + out_prefix + ".contig.hbv", hbvr);
-            WriteReadPathVec(pathsr,(out_dir + "/" + out_prefix + ".contig.paths").c_str());
-            std::cout << "   DONE!" << std::endl;
+            bool queued = DumpGraphAndPaths(writer, hbvr, pathsr, out_dir + "/" + out_prefix + ".contig", to_step == 6);
+            std::cout << (queued ? "   queued." : "   DONE!") << std::endl;
             if (dump_perf) perf_file << checkpoint_perf_time("ContigGraphDump") << std::endl;
         }
         //vecbasevector G;
         //FinalFiles(hbvr, inv, pathsr, subsam_names, subsam_starts, out_dir, out_prefix + "_contigs", MAX_CELL_PATHS, MAX_DEPTH, G);
-        GFADump(out_dir +"/"+ out_prefix + "_contigs", hbvr, inv, pathsr, MAX_CELL_PATHS, MAX_DEPTH, true);
+        GFADump(out_dir +"/"+ out_prefix + "_contigs", hbvr, inv, pathsr, MAX_CELL_PATHS, MAX_DEPTH, true, &lines);
         PathFinder(hbvr,inv,pathsr,paths_inv).classify_forks();
 
     }
     if (from_step==7){
         std::cout << "Reading contig graph and paths..." << std::endl;
-        BinaryReader::readFile(out_dir + "/" + out_prefix + ".contig.hbv", &hbvr);
-        LoadReadPathVec(pathsr,(out_dir + "/" + out_prefix + ".contig.paths").c_str());
+        LoadGraphAndPaths(hbvr, pathsr, out_dir + "/" + out_prefix + ".contig");
         inv.clear();
         hbvr.Involution(inv);
         paths_inv.clear();
@@ -570,6 +665,7 @@ int main(const int argc, const char * argv[]) {
     if (from_step<=7 and to_step>=7) {
         //== Scaffolding
         std::cout << "--== Step 7: PE-Scaffolding ==--" << std::endl;
+        MemoryGovernor::Phase mem_phase("step 7");
         int MIN_LINE = 5000;
         int MIN_LINK_COUNT = 3; //XXX TODO: this variable is the same as -w in soap??
 
@@ -595,12 +691,14 @@ int main(const int argc, const char * argv[]) {
         // Carry out final analyses and write final assembly files.
 
         vecbasevector G;
-        FinalFiles(hbvr, inv, pathsr, subsam_names, subsam_starts, out_dir, out_prefix+ "_assembly", MAX_CELL_PATHS, MAX_DEPTH, G);
-        GFADump(out_dir +"/"+ out_prefix + "_assembly", hbvr, inv, pathsr, MAX_CELL_PATHS, MAX_DEPTH, true);
+        vec<vec<vec<vec<int>>>> lines;
+        FinalFiles(hbvr, inv, pathsr, subsam_names, subsam_starts, out_dir, out_prefix+ "_assembly", MAX_CELL_PATHS, MAX_DEPTH, G, &lines);
+        GFADump(out_dir +"/"+ out_prefix + "_assembly", hbvr, inv, pathsr, MAX_CELL_PATHS, MAX_DEPTH, true, &lines);
         if (dump_perf) perf_file << checkpoint_perf_time("FinalFiles") << std::endl;
 
 
     }
+    writer.finish();
     if (dump_perf) perf_file.close();
     return 0;
 }
@@ -25,6 +25,7 @@
 #include "dna/Bases.h"
 #include "feudal/BinaryStream.h"
 #include "feudal/VirtualMasterVec.h"
+#include "graphics/SvgPlot.h"
 //#include "kmers/BigKPather.h"
 #include "kmers/ReadPatherDefs.h"
 #include "math/Functions.h"
@@ -33,6 +34,7 @@
 #include "paths/long/HBVFromEdges.h"
 #include "paths/long/KmerCount.h"
 #include "system/SortInPlace.h"
+#include "system/MemoryGovernor.h"
 #include "system/SpinLockedData.h"
 #include "system/WorklistN.h"
 #include <algorithm>
@@ -65,6 +67,8 @@ namespace
             count=other.count;
             kc=other.kc;
         }
+        KMerNodeFreq( BRQ_Kmer const& kmer, KMerContext context )
+        : BRQ_Kmer(kmer), count(1), kc(context) {}
         KMerNodeFreq (const KMerNodeFreq &other, bool rc){
             *this=other;
             count=other.count;
@@ -511,18 +515,17 @@ namespace
                 BRQ_Kmer kmer(itr);
                 BRQ_Entry const *pEnt = mDict.findEntry(kmer);
                 if (!pEnt) {
+                    // a run of misses:  look up the following kmers in a batch
                     unsigned gapLen = 1u;
-                    auto itr2 = itr + K;
                     ++itr;
-                    auto end2 = read.end();
-                    while (itr2 != end2) {
-                        kmer.toSuccessor(*itr2);
-                        ++itr2;
-                        if ((pEnt = mDict.findEntry(kmer)))
-                            break;
-                        ++gapLen;
-                        ++itr;
-                    }
+                    mDict.findEntries(itr, read.end(),
+                            [&](BRQ_Entry const *pEntry, bool) {
+                                if ((pEnt = pEntry))
+                                    return false;
+                                ++gapLen;
+                                ++itr;
+                                return true;
+                            });
                     mPathParts.emplace_back(gapLen);
                 }
                 if (pEnt) {
@@ -928,6 +931,21 @@ namespace
 
     }
 
+// Write the k-mer frequency histogram, hist[1] to hist[n-1], and a plot of it.
+void writeKmerFreqs(std::string const& workdir, uint64_t const* hist, int n){
+    std::ofstream kff(workdir + "/small_K.freqs");
+    std::vector<double> freqs, counts;
+    for (auto i = 1; i < n; i++) {
+        kff << i << ", " << hist[i] << std::endl;
+        freqs.push_back(i);
+        counts.push_back(hist[i]);
+    }
+    kff.close();
+    std::string err=WriteSvgHistogram(workdir + "/small_K.freqs.svg", "Small K k-mer frequencies",
+                                      "occurrences", "k-mers", freqs, counts, true);
+    if (!err.empty()) std::cout << Date() << ": couldn't plot small_K.freqs: " << err << std::endl;
+}
+
 } // end of anonymous namespace
 
 
@@ -1012,7 +1030,7 @@ void collapse_entries(std::vector<KMerNodeFreq> &kmer_list){
     kmer_list.resize(okItr - kmer_list.begin());
 }
 
-std::vector<KMerNodeFreq> createDictOMPRecursive(BRQ_Dict ** dict, vecbvec const& reads, VecPQVec const& quals, uint64_t from, uint64_t to, uint64_t batch_size, unsigned minQual, unsigned minFreq, std::string workdir=""){
+std::vector<KMerNodeFreq> createDictOMPRecursive(bool top, vecbvec const& reads, VecPQVec const& quals, uint64_t from, uint64_t to, uint64_t batch_size, unsigned minQual, unsigned minFreq, std::string workdir=""){
     std::vector<KMerNodeFreq> kmer_list;
     //If size larger than batch (or still not enough cpus used, or whatever), Lauch 2 tasks to sort the 2 halves, with minFreq=0
     if (to - from > batch_size) {
@@ -1021,10 +1039,10 @@ std::vector<KMerNodeFreq> createDictOMPRecursive(BRQ_Dict ** dict, vecbvec const
         uint64_t mid_point = from + (to - from) / 2;
         std::vector<KMerNodeFreq> entries1, entries2; //TODO: need to not copy but mode the reference.
         #pragma omp task shared(reads,quals,entries1)
-        { entries1 = createDictOMPRecursive(NULL, reads, quals, from, mid_point, batch_size, minQual,
+        { entries1 = createDictOMPRecursive(false, reads, quals, from, mid_point, batch_size, minQual,
                                               minFreq);}
         #pragma omp task shared(reads,quals,entries2)
-        { entries2 = createDictOMPRecursive(NULL, reads, quals, mid_point, to, batch_size, minQual, minFreq); }
+        { entries2 = createDictOMPRecursive(false, reads, quals, mid_point, to, batch_size, minQual, minFreq); }
         #pragma omp taskwait
         kmer_list.reserve(entries1.size() + entries2.size());
         auto end1=entries1.end(),end2=entries2.end();
@@ -1062,20 +1080,15 @@ std::vector<KMerNodeFreq> createDictOMPRecursive(BRQ_Dict ** dict, vecbvec const
         for (auto readId = from; readId < to; ++readId) {
             unsigned len = good_lenghts[readId - from];
             if (len > K) {
-                auto beg = reads[readId].begin(), itr=beg+K, last=beg+(len-1);
-                KMerNodeFreq kkk(beg);
-                kkk.kc = KMerContext::initialContext(*itr);
-                kkk.count=1;
-                kmer_list.push_back( kkk.isRev() ? KMerNodeFreq(kkk,true) : kkk);
-                while ( itr != last )
-                { unsigned char pred = kkk.front();
-                    kkk.toSuccessor(*itr); ++itr;
-                    kkk.kc = KMerContext(pred,*itr);
-                    kmer_list.push_back( kkk.isRev() ? KMerNodeFreq(kkk,true) : kkk);
+                auto beg = reads[readId].begin();
+                for (KMerRoller<K,bvec::const_iterator> roller(beg,beg+len); roller; ++roller) {
+                    size_t off = roller.getOffset();
+                    KMerContext kc = !off ? KMerContext::initialContext(beg[K]) :
+                                     off+K == len ? KMerContext::finalContext(beg[off-1]) :
+                                     KMerContext(beg[off-1],beg[off+K]);
+                    kmer_list.push_back( roller.isRev() ? KMerNodeFreq(roller.getRC(),kc.rc()) :
+                                                          KMerNodeFreq(roller.getFwd(),kc) );
                 }
-                kkk.kc = KMerContext::finalContext(kkk.front());
-                kkk.toSuccessor(*last);
-                kmer_list.push_back( kkk.isRev() ? KMerNodeFreq(kkk,true) : kkk);
             }
         }
         std::sort(kmer_list.begin(), kmer_list.end());
@@ -1087,16 +1100,14 @@ std::vector<KMerNodeFreq> createDictOMPRecursive(BRQ_Dict ** dict, vecbvec const
     //          << std::endl;
 
 
-    if (NULL != dict) { //merge sort and return that
+    if (top) { //report, and return the lot to be filtered into the dictionary
         std::cout << Date() << ": " << kmer_list.size() << " kmers counted, filtering..." << std::endl;
-        (*dict) = new BRQ_Dict(kmer_list.size());
         uint64_t used = 0,not_used=0;
         uint64_t hist[101];
         for (auto &h:hist) h=0;
         for (auto &knf:kmer_list) {
             ++hist[std::min(100,(int)knf.count)];
             if (knf.count >= minFreq) {
-                (*dict)->insertEntryNoLocking(BRQ_Entry((BRQ_Kmer)knf,knf.kc));
                 used++;
             } else {
                 not_used++;
@@ -1104,11 +1115,8 @@ std::vector<KMerNodeFreq> createDictOMPRecursive(BRQ_Dict ** dict, vecbvec const
 
         }
         std::cout << Date() << ": " << used << " / " << kmer_list.size() << " kmers with Freq >= " << minFreq << std::endl;
-        kmer_list.clear();
         if (""!=workdir) {
-            std::ofstream kff(workdir + "/small_K.freqs");
-            for (auto i = 1; i < 101; i++) kff << i << ", " << hist[i] << std::endl;
-            kff.close();
+            writeKmerFreqs(workdir, hist, 101);
         }
 
     }
@@ -1117,7 +1125,7 @@ std::vector<KMerNodeFreq> createDictOMPRecursive(BRQ_Dict ** dict, vecbvec const
 }
 
 
-void createDictOMPDiskBased(BRQ_Dict ** dict, vecbvec const& reads, VecPQVec const& quals, unsigned char disk_batches, uint64_t batch_size, unsigned minQual, unsigned minFreq, std::string workdir="", std::string tmpdir=""){
+std::vector<KMerNodeFreq> createDictOMPDiskBased(vecbvec const& reads, VecPQVec const& quals, unsigned char disk_batches, uint64_t batch_size, unsigned minQual, unsigned minFreq, std::string workdir="", std::string tmpdir=""){
     //If size larger than batch (or still not enough cpus used, or whatever), Lauch 2 tasks to sort the 2 halves, with minFreq=0
     std::cout<<Date()<<": disk-based kmer counting with "<<(int) disk_batches<<" batches"<<std::endl;
     uint64_t total_kmers_in_batches=0;
@@ -1130,9 +1138,9 @@ void createDictOMPDiskBased(BRQ_Dict ** dict, vecbvec const& reads, VecPQVec con
         uint64_t mid_point = from + (to - from) / 2;
         std::vector<KMerNodeFreq> entries1, entries2; //TODO: need to not copy but move the reference.
 #pragma omp task shared(reads,quals,entries1)
-        { entries1 = createDictOMPRecursive(NULL, reads, quals, from, mid_point, batch_size, minQual, minFreq);}
+        { entries1 = createDictOMPRecursive(false, reads, quals, from, mid_point, batch_size, minQual, minFreq);}
 #pragma omp task shared(reads,quals,entries2)
-        { entries2 = createDictOMPRecursive(NULL, reads, quals, mid_point, to, batch_size, minQual, minFreq); }
+        { entries2 = createDictOMPRecursive(false, reads, quals, mid_point, to, batch_size, minQual, minFreq); }
 #pragma omp taskwait
         auto end1=entries1.end(),end2=entries2.end();
         auto itr1=entries1.begin(),itr2=entries2.begin();
@@ -1198,7 +1206,7 @@ void createDictOMPDiskBased(BRQ_Dict ** dict, vecbvec const& reads, VecPQVec con
     current_kmer=next_knf_from_dbf[min];
     current_kmer.count=0;
     uint64_t used = 0,not_used=0;
-    uint64_t hist[256];
+    uint64_t hist[256]{};
     std::vector<KMerNodeFreq> kmerlist;
 
     while (finished_files<disk_batches) {
@@ -1238,18 +1246,41 @@ void createDictOMPDiskBased(BRQ_Dict ** dict, vecbvec const& reads, VecPQVec con
         dbf[i].close();
         std::remove((tmpdir + "/kmer_count_batch_" +std::to_string((int)i)).c_str());
     }
-    (*dict)=new BRQ_Dict(kmerlist.size());
-    for (auto &knf: kmerlist) (*dict)->insertEntryNoLocking(BRQ_Entry((BRQ_Kmer) knf, knf.kc));
     std::cout << Date() << ": " << used << " / " << used+not_used << " kmers with Freq >= " << minFreq << std::endl;
     if (""!=workdir) {
-        std::ofstream kff(workdir + "/small_K.freqs");
-        for (auto i = 1; i < 256; i++) kff << i << ", " << hist[i] << std::endl;
-        kff.close();
+        writeKmerFreqs(workdir, hist, 256);
     }
+    return kmerlist;
+}
 
+// Fill the dictionary with the kmers seen at least minFreq times.  Call this
+// from outside any parallel region, so that all the threads do the inserting.
+BRQ_Dict* fillDict(std::vector<KMerNodeFreq> const& kmer_list, unsigned minFreq){
+    BRQ_Dict* dict = new BRQ_Dict(kmer_list.size());
+    dict->insertEntries(kmer_list.size(),
+                        [&kmer_list,minFreq](size_t idx, BRQ_Entry& entry) {
+                            KMerNodeFreq const& knf = kmer_list[idx];
+                            if (knf.count < minFreq) return false;
+                            entry = BRQ_Entry((BRQ_Kmer) knf, knf.kc);
+                            return true;
+                        });
+    return dict;
 }
 
 
+// Pick the number of disk batches for k-mer counting from the memory budget.
+// Counting holds every k-mer occurrence of a batch, and the merges need about
+// as much again, so a batch that fits the budget is about half of it.
+unsigned char chooseDiskBatches(vecbvec const& reads, unsigned k){
+    uint64_t nkmers=0;
+    for (auto const& read:reads) if (read.size()>=k) nkmers+=read.size()-k+1;
+    size_t bytes=2*nkmers*sizeof(KMerNodeFreq);
+    size_t nbatches=MemoryGovernor::nBatches(bytes,AUTO_DISK_BATCHES-1);
+    std::cout << Date() << ": "<<nkmers<<" kmer occurrences need about "<<bytes/(1024*1024*1024)<<" GB to count, using "
+              << nbatches << (nbatches>1 ? " disk batches" : " in-memory batch") << std::endl;
+    return (unsigned char) nbatches;
+}
+
 void buildReadQGraph( vecbvec const& reads, VecPQVec const& quals,
                       bool doFillGaps, bool doJoinOverlaps,
                       unsigned minQual, unsigned minFreq,
@@ -1258,22 +1289,26 @@ void buildReadQGraph( vecbvec const& reads, VecPQVec const& quals,
 {
     std::cout << Date() << ": creating kmers from reads..." << std::endl;
     //BRQ_Dict* pDict = createDictOMP(reads,quals,minQual,minFreq);
-    BRQ_Dict * pDict;
+    std::vector<KMerNodeFreq> kmer_list;
+    if (AUTO_DISK_BATCHES==disk_batches) disk_batches=chooseDiskBatches(reads,_K);
     if (1>=disk_batches) {
-        #pragma omp parallel shared(pDict,reads,quals)
+        #pragma omp parallel shared(kmer_list,reads,quals)
         {
             #pragma omp single
-            createDictOMPRecursive(&pDict, reads, quals, 0, reads.size(), 1000000, minQual, minFreq, workdir);
+            kmer_list = createDictOMPRecursive(true, reads, quals, 0, reads.size(), 1000000, minQual, minFreq, workdir);
         }
     }
     else {
+        if (""==tmpdir) tmpdir=MemoryGovernor::spillDir();
         if (""==tmpdir) tmpdir=workdir;
-        #pragma omp parallel shared(pDict,reads,quals)
+        #pragma omp parallel shared(kmer_list,reads,quals)
         {
             #pragma omp single
-            createDictOMPDiskBased(&pDict, reads, quals, disk_batches, 1000000, minQual, minFreq, workdir, tmpdir);
+            kmer_list = createDictOMPDiskBased(reads, quals, disk_batches, 1000000, minQual, minFreq, workdir, tmpdir);
         }
     }
+    BRQ_Dict * pDict = fillDict(kmer_list, minFreq);
+    std::vector<KMerNodeFreq>().swap(kmer_list);
     std::cout << Date() << ": updating adjacencies" <<std::endl;
     pDict->recomputeAdjacencies();
     std::cout << Date() << ": dict finished" <<std::endl;
@@ -21,6 +21,11 @@
 #include "paths/HyperBasevector.h"
 #include "paths/long/ReadPath.h"
 
+// disk_batches: 0 or 1 counts k-mers in memory, more than 1 spills sorted
+// batches to tmpdir, and AUTO_DISK_BATCHES picks the number of batches from the
+// memory budget.
+unsigned char const AUTO_DISK_BATCHES = 255;
+
 void buildReadQGraph( vecbvec const& reads, VecPQVec const& quals,
                         bool doFillGaps, bool doJoinOverlaps,
                         unsigned minQual, unsigned minFreq,
@@ -20,6 +20,7 @@
 #include "paths/long/FriendAligns.h"
 #include "paths/long/MakeKmerStuff.h"
 #include "paths/long/ReadStack.h"
+#include "system/SpareThreads.h"
 #include "util/w2rap_timers.h"
 
 TIMELOG_CREATE_GLOBAL(C1P_Align);
@@ -91,10 +92,13 @@ void Correct1Pre( const int K,
      //PART3---------
      TIMELOG_START_LOCAL(C1P_Correct,in);
 
-     // Do the corrections.
+     // Do the corrections.  Each batch has its own stack, so the batches can
+     // run on whatever threads the enclosing loop has to spare.
 
      const int batch = 100;
-     //#pragma omp parallel for schedule(dynamic, 1)
+     SpareThreads::Loan loan( ( use.size( ) + batch - 1 ) / batch );
+     #pragma omp parallel for schedule(dynamic, 1) num_threads(loan.threads()) \
+          if(loan.threads() > 1)
      for ( int64_t id1a = 0; id1a < (int64_t) use.size( ); id1a += batch )
      {    readstack stack;
           vec<Bool> suspect;
@@ -123,7 +127,7 @@ void Correct1Pre( const int K,
                if ( BinMember( trace_ids, id1 ) )
                {    vec<basevector> cons;
                     cons.push_back( currentBaseVec );
-                    //#pragma omp critical
+                    #pragma omp critical
                     {    std::cout << "\nCorrect1Pre, K = " << K 
                               << ", initial stack, tracing read " << id1 << std::endl;
                          std::cout << "stack:\n";
@@ -154,7 +158,7 @@ void Correct1Pre( const int K,
                if ( BinMember( trace_ids, id1 ) )
                {    vec<basevector> cons;
                     cons.push_back( currentBaseVec );
-                    //#pragma omp critical
+                    #pragma omp critical
                     {    std::cout << "\nCorrect1Pre, K = " << K 
                               << ", final stack, tracing read " << id1 << std::endl;
                          std::cout << "stack:\n";
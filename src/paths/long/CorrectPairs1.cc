@@ -25,6 +25,7 @@
 #include "paths/long/MakeKmerStuff.h"
 #include "paths/long/ReadStack.h"
 #include "random/Bernoulli.h"
+#include "system/SpareThreads.h"
 #include "util/w2rap_timers.h"
 TIMELOG_CREATE_GLOBAL(CP1_Align);
 TIMELOG_CREATE_GLOBAL(CP1_MakeStacks);
@@ -66,9 +67,14 @@ void CorrectPairs1( const int K, const int max_freq, vecbasevector& bases,
      }
 
 
-     //int batch = (int64_t) use.size( ) / omp_get_max_threads( );
-     //batch = Min( 100, Max( 1, batch ) );
-     //#pragma omp parallel for schedule(dynamic, batch)
+     // Each pair builds its own stacks, so pairs can run on whatever threads
+     // the enclosing loop has to spare, as long as there are enough of them
+     // to be worth a team.
+
+     const int min_pairs_per_thread = 10;
+     SpareThreads::Loan loan( use.size( ) / min_pairs_per_thread );
+     #pragma omp parallel for schedule(dynamic, 1) num_threads(loan.threads()) \
+          if(loan.threads() > 1)
      for (int64_t id1x = 0; id1x < (int64_t) use.size(); id1x++) {
           TIMELOG_DECLARE_LOCAL(CP1_MakeStacks, Loop);
           TIMELOG_DECLARE_LOCAL(CP1_Correct, Loop);
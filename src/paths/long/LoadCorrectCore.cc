@@ -187,9 +187,15 @@ void CorrectionSuite(vecbasevector &gbases, vecqualvector &gquals, PairsManager
 
     const String sFragReadsOrig = "frag_reads_orig";
 
+    // The local reads pass through several states, which share storage
+    // rather than being copied from one to the next: gbases keeps the original
+    // bases, creads and cquals (taken over from gquals) are corrected in place,
+    // and creads_done overlays the final sequence of reads that are done,
+    // leaving every other row empty.
+
     vecqualvector cquals;
     creads = gbases;
-    cquals = gquals;
+    cquals.swap(gquals);
     size_t nReads = creads.size();
     ForceAssertEq(nReads, cquals.size());
     size_t nBases = 0, qualSum = 0;
@@ -223,22 +229,17 @@ void CorrectionSuite(vecbasevector &gbases, vecqualvector &gquals, PairsManager
     vec<Bool> done(nReads, False);
 
 
-    creads_done = creads;
-    vecbasevector filled;
-
-
     const int MIN_FREQ = 5;
-    FillPairs(creads, pairs, MIN_FREQ, filled, heur.FILL_PAIRS_ALT);
+    FillPairs(creads, pairs, MIN_FREQ, creads_done, heur.FILL_PAIRS_ALT);
 
 
     int64_t fill_count = 0;
-    for (int64_t id = 0; id < (int64_t) filled.size(); id++) {
-        if (filled[id].size() == 0) continue;
+    for (int64_t id = 0; id < (int64_t) creads_done.size(); id++) {
+        if (creads_done[id].size() == 0) continue;
         fill_count++;
         int n = creads[id].size();
-        creads_done[id] = filled[id];
         cquals[id].resize(0);
-        cquals[id].resize(filled[id].size(), 40);
+        cquals[id].resize(creads_done[id].size(), 40);
         creads[id] = creads_done[id];
         if (n < creads[id].isize()) {
             cquals[id].resize(n);
@@ -274,13 +275,16 @@ void CorrectionSuite(vecbasevector &gbases, vecqualvector &gquals, PairsManager
 
     unsigned const COVERAGE = 50u;
     const int K2 = 80; // SHOULD NOT BE HARDCODED!
-    vecbasevector correctedv(creads);
-    for (int64_t id = 0; id < (int64_t) creads.size(); id++)
-        correctedv[id].resize(trim_to[id]);
     HyperBasevector hb;
     HyperKmerPath h;
     vecKmerPath paths, paths_rc;
-    LongReadsToPaths(correctedv, K2, COVERAGE, &hb, &h, &paths, &paths_rc);
+    {
+        vecbasevector correctedv;
+        correctedv.reserve(nReads);
+        for (int64_t id = 0; id < (int64_t) creads.size(); id++)
+            correctedv.push_back(basevector(creads[id], 0, trim_to[id]));
+        LongReadsToPaths(correctedv, K2, COVERAGE, &hb, &h, &paths, &paths_rc);
+    }
     vecKmerPath hpaths;
     vec<tagged_rpint> hpathsdb;
     for (int e = 0; e < h.EdgeObjectCount(); e++)
@@ -362,8 +366,8 @@ void CorrectionSuite(vecbasevector &gbases, vecqualvector &gquals, PairsManager
             if (u[pass].nonempty()) { left[pass] = M.front().third.Start(); }
         }
         if (u[0].solo() && u[1].solo() && u[0][0] == u[1][0]) {
-            int b1siz = correctedv[id1].isize();
-            int b2siz = correctedv[id2].isize();
+            int b1siz = trim_to[id1];
+            int b2siz = trim_to[id2];
             int offset = left[1] - left[0];
             if (b1siz == creads[id1].isize()
                 && b2siz == creads[id2].isize() && offset >= 0) {
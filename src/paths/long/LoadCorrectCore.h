@@ -24,6 +24,8 @@ void CapQualityScores( vecqualvector& cquals, const vec<Bool>& done );
 void ZeroCorrectedQuals( vecbasevector const& readsFile, vecbvec const& creads,
                             vecqvec* pQuals );
 
+// Correct a local read set.  gquals is taken over as the working quality
+// scores, and is left empty.
 void CorrectionSuite( vecbasevector& gbases, vecqualvector& gquals, PairsManager& gpairs,
      const long_heuristics& heur,
      //const long_logging& logc, const long_logging_control& log_control,
@@ -30,34 +30,15 @@
 #include "paths/long/PairInfo.h"
 #include "paths/long/SupportedHyperBasevector.h"
 
-Bool LongHyper(const VecEFasta &correctede, const vec<pairing_info> &cpartner, SupportedHyperBasevector &shb,
-               const long_heuristics &heur, const long_logging_control &log_control, const long_logging &logc,
-               bool useOldLRPMethod) {
-
-    // Choose K2.
-
-    double K2frac_mult = 1.0;
-    double K2frac_to_use = heur.K2frac * K2frac_mult;//.22
-    int K2 = SelectK2(correctede, K2frac_to_use, logc, heur);
-    K2 = Max(K2, heur.K2_FLOOR);
-    if (heur.K2_FORCE >= 0) K2 = heur.K2_FORCE;
-    double fudge_mult = K2frac_mult;
-
-    // Setup for PERTURB_TRANSLATIONS.
-
-
-    const bool bUseOrgReads = false;
-    vecbasevector const &Bases = vecbasevector();
-    vecqualvector const &Quals = vecqualvector();
-    PairsManager const &Pairs = PairsManager();
+long_hyper_reads::long_hyper_reads(const VecEFasta &correctede, const long_heuristics &heur,
+                                   const long_logging &logc)
+        : selected_K2(SelectK2(correctede, heur.K2frac, logc, heur)) {
 
     // Expand correctede.  Note that this is exponential and thus totally unsound.
 
     double eclock = WallClockTime();
     if (logc.STATUS_LOGGING) ReportPeakMem();
     if (logc.STATUS_LOGGING) std::cout << Date() << ": making hyper" << std::endl;
-    vecbasevector correctedv;
-    vec<triple<int, int, int> > origin;
     for (size_t id = 0; id < correctede.size(); id++) {
         vec<basevector> b;
         correctede[id].ExpandTo(b);
@@ -67,9 +48,44 @@ Bool LongHyper(const VecEFasta &correctede, const vec<pairing_info> &cpartner, S
         }
     }
     REPORT_TIME(eclock, "used in expansion");
-    int64_t read_count = correctedv.size();
-    if (heur.INJECT_REF && log_control.G != 0)
-        correctedv.Append(*(log_control.G));
+}
+
+int long_hyper_reads::K2(const long_heuristics &heur) const {
+    if (heur.K2_FORCE >= 0) return heur.K2_FORCE;
+    return Max(selected_K2, heur.K2_FLOOR);
+}
+
+Bool LongHyper(const VecEFasta &correctede, const vec<pairing_info> &cpartner, SupportedHyperBasevector &shb,
+               const long_heuristics &heur, const long_logging_control &log_control, const long_logging &logc,
+               bool useOldLRPMethod) {
+    long_hyper_reads reads(correctede, heur, logc);
+    return LongHyper(correctede, reads, cpartner, shb, heur, log_control, logc, useOldLRPMethod);
+}
+
+Bool LongHyper(const VecEFasta &correctede, const long_hyper_reads &reads, const vec<pairing_info> &cpartner,
+               SupportedHyperBasevector &shb, const long_heuristics &heur,
+               const long_logging_control &log_control, const long_logging &logc, bool useOldLRPMethod) {
+
+    const int K2 = reads.K2(heur);
+    double fudge_mult = 1.0;
+
+    // Setup for PERTURB_TRANSLATIONS.
+
+
+    const bool bUseOrgReads = false;
+    vecbasevector const &Bases = vecbasevector();
+    vecqualvector const &Quals = vecqualvector();
+    PairsManager const &Pairs = PairsManager();
+
+    vec<triple<int, int, int> > const &origin = reads.origin;
+    int64_t read_count = reads.correctedv.size();
+    vecbasevector withRef;
+    vecbasevector const *pCorrectedv = &reads.correctedv;
+    if (heur.INJECT_REF && log_control.G != 0) {
+        withRef = reads.correctedv;
+        withRef.Append(*(log_control.G));
+        pCorrectedv = &withRef;
+    }
 
     // Make paths.
 
@@ -80,7 +96,7 @@ Bool LongHyper(const VecEFasta &correctede, const vec<pairing_info> &cpartner, S
     if (logc.STATUS_LOGGING)
         std::cout << Date() << ": calling LongReadsToPaths" << std::endl;
     unsigned const COVERAGE = 50u;
-    LongReadsToPaths(correctedv, K2, COVERAGE, &hb, &h, &paths, &paths_rc);
+    LongReadsToPaths(*pCorrectedv, K2, COVERAGE, &hb, &h, &paths, &paths_rc);
     REPORT_TIME(pclock, "used in pathing");
 
     // Trace reads through h.  Ignore reads that lie entirely on one edge.
@@ -17,8 +17,31 @@
 #include "paths/long/PairInfo.h"
 #include "paths/long/SupportedHyperBasevector.h"
 
+// The part of LongHyper that doesn't depend on K2: the corrected reads expanded
+// from EFASTA, and the K2 that SelectK2 picks for them.  Local assembly retries
+// the same reads with rising K2_FLOOR, and makes this once for all of them.
+
+class long_hyper_reads {
+public:
+    long_hyper_reads(const VecEFasta &correctede, const long_heuristics &heur, const long_logging &logc);
+
+    // The K2 that LongHyper uses, given heur.K2_FLOOR and heur.K2_FORCE.
+    int K2(const long_heuristics &heur) const;
+
+    vecbasevector correctedv;
+    vec<triple<int, int, int> > origin; // (read id, expansion, expansion count)
+
+private:
+    int selected_K2; // before the floor is applied
+};
+
 Bool LongHyper(const VecEFasta &correctede, const vec<pairing_info> &cpartner, SupportedHyperBasevector &shb,
                const long_heuristics &heur, const long_logging_control &log_control, const long_logging &logc,
                bool useOldLRPMethod);
 
+// As above, with the reads already expanded.
+Bool LongHyper(const VecEFasta &correctede, const long_hyper_reads &reads, const vec<pairing_info> &cpartner,
+               SupportedHyperBasevector &shb, const long_heuristics &heur,
+               const long_logging_control &log_control, const long_logging &logc, bool useOldLRPMethod);
+
 #endif
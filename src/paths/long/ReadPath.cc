@@ -2,6 +2,7 @@
 // Created by Bernardo Clavijo (TGAC) on 22/10/2016.
 //
 #include "ReadPath.h"
+#include "system/System.h"
 
 void WriteReadPathVec(const ReadPathVec &rpv, const char * filename){
     std::ofstream f(filename, std::ios::out | std::ios::trunc | std::ios::binary);
@@ -17,6 +18,7 @@ void WriteReadPathVec(const ReadPathVec &rpv, const char * filename){
         f.write((const char *) rp.data(),ps*sizeof(int));
     }
     f.close();
+    if (!f) FatalErr("Writing read paths to " << filename << " failed.");
 }
 
 
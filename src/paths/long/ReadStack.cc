@@ -89,23 +89,18 @@ private:
     double mVal[N][N];
 };*/
 
-double readstack::new_qual_LUT_s[1000];
+double readstack::new_qual_LUT[1000];
 
 void readstack::Initialize(const int nrows, const int ncols) {
     cols_ = ncols;
-    bases_.clear();
-    bases_.resize(nrows);
-    for (auto &read : bases_) read.assign(ncols, ' ');
-    quals_.clear();
-    quals_.resize(nrows);
-    for (auto &qual : quals_) qual.assign(ncols, -1);
+    bases_.assign(nrows, ncols, ' ');
+    quals_.assign(nrows, ncols, -1);
     id_.resize_and_set(nrows, -1);
     rc2_.resize_and_set(nrows, False);
     pid_.resize_and_set(nrows, -1);
     pair_pos_.resize_and_set(nrows, -1);
     offset_.resize_and_set(nrows, -1);
     len_.resize_and_set(nrows, -1);
-    memcpy(new_qual_LUT_l,new_qual_LUT_s, sizeof(double)*1000);
 }
 
 void readstack::Initialize(const int64_t id1, Friends const &aligns,
@@ -216,10 +211,10 @@ void readstack::Initialize(const int64_t id1, Friends const &aligns,
 void readstack::AddToStack(const vec<triple<int, int64_t, Bool> > &offset_id_rc2,
                            const vecbasevector &bases, const vecqualvector &quals,
                            const PairsManager &pairs) {
-    int oldlen = bases_.size();
-    int newlen = bases_.size() + offset_id_rc2.size();
-    bases_.resize(newlen);
-    quals_.resize(newlen);
+    int oldlen = Rows();
+    int newlen = Rows() + offset_id_rc2.size();
+    bases_.AppendRows(offset_id_rc2.size(), ' ');
+    quals_.AppendRows(offset_id_rc2.size(), -1);
     id_.resize(newlen);
     rc2_.resize(newlen);
     pid_.resize(newlen);
@@ -233,12 +228,6 @@ void readstack::AddToStack(const vec<triple<int, int64_t, Bool> > &offset_id_rc2
         int nm = oldlen + m;
         const basevector &b = bases[id];
         const qualvector &q = quals[id];
-        bases_[nm].resize(Cols());
-        quals_[nm].resize(Cols());
-        for (int j = 0; j < Cols(); j++) {
-            bases_[nm][j] = ' ';
-            quals_[nm][j] = -1;
-        }
         for (int p2 = 0; p2 < b.isize(); p2++) {
             int p1 = p2 + offset;
             if (p1 < 0) continue;
@@ -262,8 +251,8 @@ void readstack::AddToStack(const vec<triple<int, int64_t, Bool> > &offset_id_rc2
 }
 
 void readstack::Erase(const vec<Bool> &to_remove) {
-    bases_.EraseIf(to_remove);
-    quals_.EraseIf(to_remove);
+    bases_.EraseRows(to_remove);
+    quals_.EraseRows(to_remove);
     id_.EraseIf( to_remove);
     rc2_.EraseIf(to_remove);
     pid_.EraseIf(to_remove);
@@ -355,8 +344,8 @@ void readstack::SortByPid(const int64_t pid1, const int i1, const int i2) {
     }
     for (int i = 0; i < Rows(); i++)
         identr[ident[i]] = i;
-    PermuteVec(bases_, identr);
-    PermuteVec(quals_, identr);
+    bases_.PermuteRows(identr);
+    quals_.PermuteRows(identr);
     PermuteVec(id_, identr);
     PermuteVec(rc2_, identr);
     PermuteVec(pid_, identr);
@@ -366,12 +355,11 @@ void readstack::SortByPid(const int64_t pid1, const int i1, const int i2) {
 }
 
 void readstack::Reverse() {
+    bases_.ReverseRows();
+    quals_.ReverseRows();
     for (int i = 0; i < Rows(); i++) {
-        //bases_[i].ReverseMe();
-        std::reverse(bases_[i].begin(), bases_[i].end());
         for (int j = 0; j < Cols(); j++)
             if (bases_[i][j] != ' ') bases_[i][j] = 3 - bases_[i][j];
-        std::reverse(quals_[i].begin(),quals_[i].end());
         rc2_[i] = !rc2_[i];
         offset_[i] = -(offset_[i] + len_[i] - Cols());
     }
@@ -381,45 +369,11 @@ void readstack::Merge(const readstack &s, const int offset) {
     int rows1 = Rows(), rows2 = s.Rows(), cols1 = Cols(), cols2 = s.Cols();
     int left_ext1 = Max(0, -offset);
     int right_ext1 = Max(0, offset + cols2 - cols1);
-    for (int i = 0; i < rows1; i++) {
-        if (left_ext1 > 0) {
-            bases_[i].resize(left_ext1 + cols1);
-            quals_[i].resize(left_ext1 + cols1);
-            for (int j = left_ext1 + cols1 - 1; j >= left_ext1; j--) {
-                bases_[i][j] = bases_[i][j - left_ext1];
-                quals_[i][j] = quals_[i][j - left_ext1];
-            }
-            for (int j = 0; j < left_ext1; j++) {
-                bases_[i][j] = ' ';
-                quals_[i][j] = -1;
-            }
-        }
-        bases_[i].resize(bases_[i].size() + right_ext1, ' ');
-        quals_[i].resize(quals_[i].size() + right_ext1, -1);
-    }
-    //bases_.append(s.Bases().begin(), s.Bases().end());
-    bases_.insert(bases_.end(),s.Bases().begin(), s.Bases().end());
-    //quals_.append(s.Quals().begin(), s.Quals().end());
-    quals_.insert(quals_.end(), s.Quals().begin(), s.Quals().end());
+    bases_.Widen(left_ext1, right_ext1, ' ');
+    quals_.Widen(left_ext1, right_ext1, -1);
     int left_ext2 = Max(0, offset);
-    int right_ext2 = Max(0, cols1 - (offset + cols2));
-    for (int i = 0; i < rows2; i++) {
-        int ip = rows1 + i;
-        if (left_ext2 > 0) {
-            bases_[ip].resize(left_ext2 + cols2);
-            quals_[ip].resize(left_ext2 + cols2);
-            for (int j = left_ext2 + cols2 - 1; j >= left_ext2; j--) {
-                bases_[ip][j] = bases_[ip][j - left_ext2];
-                quals_[ip][j] = quals_[ip][j - left_ext2];
-            }
-            for (int j = 0; j < left_ext2; j++) {
-                bases_[ip][j] = ' ';
-                quals_[ip][j] = -1;
-            }
-        }
-        bases_[ip].resize(bases_[ip].size() + right_ext2, ' ');
-        quals_[ip].resize(quals_[ip].size() + right_ext2, -1);
-    }
+    bases_.AppendRows(s.Bases(), left_ext2, ' ');
+    quals_.AppendRows(s.Quals(), left_ext2, -1);
     offset_.insert(offset_.end(),s.offset_.begin(),s.offset_.end());
     for (int i = 0; i < rows1; i++)
         SetOffset(i, Offset(i) + left_ext1);
@@ -430,28 +384,58 @@ void readstack::Merge(const readstack &s, const int offset) {
     pid_.insert(pid_.end(),s.pid_.begin(),s.pid_.end());
     pair_pos_.insert(pair_pos_.end(),s.pair_pos_.begin(),s.pair_pos_.end());
     len_.insert(len_.end(),s.pair_pos_.begin(),s.pair_pos_.end());
-    cols_ = bases_[0].size();
+    cols_ = bases_.Cols();
+}
+
+void readstack::QualSums(const double q0, vec<double> &sums, vec<int> *top) const {
+    double weight[128];
+    weight[0] = q0, weight[1] = weight[2] = 0.2;
+    for (int q = 3; q < 128; q++)
+        weight[q] = q;
+    const int ncols = Cols();
+    sums.assign(4 * ncols, 0.);
+    if (top) top->assign(4 * ncols, 0);
+    double *sum = sums.data();
+    int *tp = top ? top->data() : nullptr;
+    for (int j = 0; j < Rows(); j++) {
+        char const *bs = bases_[j];
+        signed char const *qs = quals_[j];
+        for (int c = 0; c < ncols; c++) {
+            int q = qs[c];
+            if (q < 0) continue;
+            int k = 4 * c + bs[c];
+            sum[k] += weight[q];
+            if (tp) tp[k] = std::max(tp[k], q);
+        }
+    }
+}
+
+void readstack::ColumnConsensuses1(basevector &con) const {
+    vec<double> sums;
+    QualSums(0.1, sums);
+    con.resize(Cols());
+    for (int i = 0; i < Cols(); i++) {
+        double const *sum = &sums[4 * i];
+        con.Set(i, std::max_element(sum, sum + 4) - sum);
+    }
 }
 
 basevector readstack::Consensus1() const {
-    basevector con(Cols());
-    for (int i = 0; i < Cols(); i++)
-        con.Set(i, ColumnConsensus1(i));
+    basevector con;
+    ColumnConsensuses1(con);
     return con;
 }
 
 void readstack::Consensus1(basevector &con, qualvector &conq) const {
     con.resize(Cols()), conq.resize(Cols());
+    // Compute quality score sum for each base.  Count Q0 as 0.1, Q1 as 0.2,
+    // and Q2 as 0.2.
+    vec<double> sums;
+    QualSums(0.1, sums);
     for (int i = 0; i < Cols(); i++) {
-        // Compute quality score sum for each base.  Count Q0 as 0.1, Q1 as 0.2,
-        // and Q2 as 0.2.
         BaseMetrics<double> mx;
-        for (int j = 0; j < Rows(); j++) {
-            double q = Qual(j, i);
-            if (q <= 2) q = Min(q, 0.2);
-            if (q == 0) q = 0.1;
-            if (Qual(j, i) >= 0) mx.val(Base(j, i)) += q;
-        }
+        for (int b = 0; b < 4; b++)
+            mx.val(b) = sums[4 * i + b];
         mx.reverseSort();
         con.Set(i, mx.id(0));
         const int qual_cap = 50;
@@ -468,9 +452,8 @@ void readstack::Consensus1(basevector &con, qualvector &conq) const {
 
 void readstack::StrongConsensus1(basevector &con, qualvector &conq,
                                  const Bool raise_zero) const {
-    con.resize(Cols()), conq.resize(Cols());
-    for (int i = 0; i < Cols(); i++)
-        con.Set(i, ColumnConsensus1(i));
+    conq.resize(Cols());
+    ColumnConsensuses1(con);
 
     const int min_window = 41;
     const double qfudge = 0.5;
@@ -479,11 +462,11 @@ void readstack::StrongConsensus1(basevector &con, qualvector &conq,
     vec<BaseMetrics<int>> sum(Cols());
     vec<double> q;
     for (int j = 0; j < Rows(); j++) {
-        auto const &qs = quals_[j];
-        q.assign(qs.begin(), qs.end());
-        auto const &bs = bases_[j];
-        auto beg = bs.begin();
-        auto end = bs.end();
+        auto qs = quals_[j];
+        q.assign(qs, qs + Cols());
+        auto bs = bases_[j];
+        auto beg = bs;
+        auto end = bs + Cols();
         auto cItr = con.begin();
         for (auto itr = beg; itr != end; ++itr, ++cItr) {
             auto itrPair = std::mismatch(itr, end, cItr);
@@ -530,9 +513,8 @@ void readstack::StrongConsensus1(basevector &con, qualvector &conq,
 }
 
 void readstack::StrongConsensus2(basevector &con, qualvector &conq, const Bool raise_zero) const {
-    con.resize(Cols()), conq.resize(Cols());
-    for (int i = 0; i < Cols(); i++)
-        con.Set(i, ColumnConsensus1(i));
+    conq.resize(Cols());
+    ColumnConsensuses1(con);
 
     const int min_window = 41;
     const double qfudge = 0.5;
@@ -541,11 +523,11 @@ void readstack::StrongConsensus2(basevector &con, qualvector &conq, const Bool r
     vec<BaseMetrics<int>> sum(Cols());
     vec<double> q; //new quality values for the consensus
     for (int j = 0; j < Rows(); j++) { //for each read
-        auto const &qs = quals_[j]; //read's original qual
-        q.assign(qs.begin(), qs.end());
-        auto const &bs = bases_[j]; //read's sequence
-        auto beg = bs.begin();
-        auto end = bs.end();
+        auto qs = quals_[j]; //read's original qual
+        q.assign(qs, qs + Cols());
+        auto bs = bases_[j]; //read's sequence
+        auto beg = bs;
+        auto end = bs + Cols();
         auto cItr = con.begin(); //consensus sequence
         for (auto itr = beg; itr != end; ++itr, ++cItr) { // for every position of the read
             auto itrPair = std::mismatch(itr, end, cItr);
@@ -560,7 +542,7 @@ void readstack::StrongConsensus2(basevector &con, qualvector &conq, const Bool r
                     if (!raise_zero && q[l] == 0)
                         continue;
                     if (dist<1000)
-                        q[l] = std::max(q[l], new_qual_LUT_l[dist]);
+                        q[l] = std::max(q[l], new_qual_LUT[dist]);
                     else
                         q[l] = std::max(q[l], 10.0 * log10(2 * dist) * qfudge);// OK, so basically each position 20bp in-between
                 }
@@ -853,12 +835,10 @@ void readstack::Trim(const int start, const int stop) {
                 break;
             }
         }
-        //bases_[i].SetToSubOf(bases_[i], start, stop - start);
-        bases_[i].assign(bases_[i].begin()+start,bases_[i].begin()+stop);
-        //quals_[i].SetToSubOf(quals_[i], start, stop - start);
-        quals_[i].assign(quals_[i].begin()+start,quals_[i].begin()+stop);
         offset_[i] -= start;
     }
+    bases_.SubCols(start, stop);
+    quals_.SubCols(start, stop);
     cols_ = stop - start;
     Erase(to_remove);
 }
@@ -981,7 +961,7 @@ void readstack::MotifDiff(const int top, vec<Bool> &to_delete) const {
             r = s - 1;
         }
         if (this_one >= 0) {
-            int const *quals = &quals_[0][i];
+            signed char const *quals = &quals_[0][i];
             for (int b = 0; b < bigs.isize(); b++) {
                 if (b == this_one) continue;
                 int that_one = bigs[b];
@@ -1197,8 +1177,18 @@ readstack::CorrectAllEM3(basevector &b, qualvector &q, int &trim_to, std::vector
     StackBaseVec b_tmp;
     StackQualVec q_tmp;
 
+    // run_EMEC3 takes the stack as one vector per row
+    StackBaseVecVec call;
+    StackQualVecVec callq;
+    call.resize(Rows());
+    callq.resize(Rows());
+    for (int i = 0; i < Rows(); i++) {
+        call[i].assign(bases_[i], bases_[i] + Cols());
+        callq[i].assign(quals_[i], quals_[i] + Cols());
+    }
+
     // trim_to currently set to read len
-    run_EMEC3(this->bases_, this->quals_, b_tmp, q_tmp, pfriend, trim_to, debug, this->id_[0]);
+    run_EMEC3(call, callq, b_tmp, q_tmp, pfriend, trim_to, debug, this->id_[0]);
 
     b.resize(b_tmp.size());
     for (size_t i = 0; i < b_tmp.size(); ++i)
@@ -1229,20 +1219,17 @@ void readstack::CorrectAll(basevector &b, qualvector &q, int &trim_to,
 
     // Go through the columns.
 
+    // Compute quality score sum for each base.  We count Q2 bases as
+    // next to nothing.
+    vec<double> sums;
+    vec<int> tops;
+    QualSums(0., sums, &tops);
+
     for (int i = 0; i < Cols(); i++) {
-        // Compute quality score sum for each base.  We count Q2 bases as
-        // next to nothing.
         BaseMetrics<double> mx;
-        int top[4]{0, 0, 0, 0};
-        for (int j = 0; j < Rows(); j++) {
-            if (Qual(j, i) >= 0) {
-                double q = Qual(j, i);
-                if (q <= 2) q = Min(q, 0.2);
-                mx.val(Base(j, i)) += q;
-                int b = Base(j, i);
-                top[b] = Max(top[b], Qual(j, i));
-            }
-        }
+        int const *top = &tops[4 * i];
+        for (int b = 0; b < 4; b++)
+            mx.val(b) = sums[4 * i + b];
         mx.reverseSort();
         int winner = mx.id(0);
 
@@ -1903,8 +1890,7 @@ void readstack::AddPartners(const int K, const int top, const vecbasevector &bas
 }
 
 namespace {
-    int cappedLength(StackBaseVec::const_iterator itr,
-                     StackBaseVec::const_iterator end,
+    int cappedLength(char const *itr, char const *end,
                      long const homopolymerLengthCap) {
         int len = 0;
         while (itr != end) {
@@ -1926,14 +1912,14 @@ void readstack::FlagNoise(vec<Bool> &to_delete) const {
     to_delete.assign(Rows(), False);
     if (Rows() < 2) return; // EARLY RETURN!
 
-    StackBaseVec const &founder = bases_[0];
-    size_t nRows = bases_.size();
+    char const *founder = bases_[0];
+    size_t nRows = Rows();
     for (size_t idx = 1; idx != nRows; ++idx) {
-        StackBaseVec const &read = bases_[idx];
+        char const *read = bases_[idx];
         bool readOK = false;
-        auto end = read.end();
-        auto itr = read.begin();
-        auto fItr = founder.begin();
+        auto end = read + Cols();
+        auto itr = read;
+        auto fItr = founder;
         while (!readOK && itr != end) {
             auto mismatchItrs = std::mismatch(itr, end, fItr);
             auto tmp = mismatchItrs.first;
@@ -2050,10 +2036,8 @@ char readstack::ColumnConsensus1(const int i) const {
     // and Q2 as 0.2.
 
     double sum[4]{0., 0., 0., 0.};
-    auto qItr = quals_.begin();
-    auto bEnd = bases_.end();
-    for (auto bItr = bases_.begin(); bItr != bEnd; ++bItr, ++qItr) {
-        int q = (*qItr)[i];
+    for (int j = 0; j < Rows(); j++) {
+        int q = quals_[j][i];
         if (q < 0) continue;
         double val;
         switch (q) {
@@ -2070,7 +2054,7 @@ char readstack::ColumnConsensus1(const int i) const {
                 val = q;
                 break;
         }
-        sum[int((*bItr)[i])] += val;
+        sum[int(bases_[j][i])] += val;
     }
     return std::max_element(sum, sum + 4) - sum;
 }
@@ -2081,15 +2065,15 @@ void readstack::HighQualDiffWindow(vec<Bool> &to_delete) const {
     const int min_qsum = 30;
     const int min_qual = 10;
     to_delete.assign(Rows(), False);
-    auto fqItr = quals_[0].begin();
-    auto fbItr = bases_[0].begin();
+    auto fqItr = quals_[0];
+    auto fbItr = bases_[0];
     for (int c = 0; c <= Cols() - w; c++, ++fqItr, ++fbItr) {
         if (fqItr[0] < 0 || fqItr[w - 1] < 0) continue;
         auto fbEnd = fbItr + w;
         Bool confirmed = False;
         for (int j = 1; j < Rows(); j++) {
-            auto bItr = bases_[j].begin() + c;
-            auto qItr = quals_[j].begin() + c;
+            auto bItr = bases_[j] + c;
+            auto qItr = quals_[j] + c;
             auto qEnd = qItr + w;
             if (std::equal(fbItr, fbEnd, bItr) &&
                 std::find_if(qItr, qEnd,
@@ -12,6 +12,11 @@
 // case one is off the end of the read.
 //
 // Undefined entries are shown as having a blank base ' ' and quality -1.
+//
+// The bases and the quality scores are each held in a single row-major block,
+// one byte per entry, so a stack of a few hundred reads fits in cache.  Loops
+// that visit every column run over the rows in the outer loop and the columns
+// in the inner loop, so that memory is read sequentially.
 
 #ifndef READ_STACK_H
 #define READ_STACK_H
@@ -46,6 +51,104 @@ public:
 };
 
 
+// StackMatrix: a rows x cols matrix in one contiguous row-major block.  Row i
+// is the range [m[i],m[i]+Cols()).
+
+template<class T>
+class StackMatrix {
+public:
+    StackMatrix() : rows_(0), cols_(0) {}
+
+    void assign(const int nrows, const int ncols, const T fill) {
+        rows_ = nrows, cols_ = ncols;
+        data_.assign(size_t(nrows) * ncols, fill);
+    }
+
+    int Rows() const { return rows_; }
+
+    int Cols() const { return cols_; }
+
+    T *operator[](const int i) { return data_.data() + size_t(i) * cols_; }
+
+    T const *operator[](const int i) const { return data_.data() + size_t(i) * cols_; }
+
+    // AppendRows: add n rows, filled with the given value.
+
+    void AppendRows(const int n, const T fill) {
+        rows_ += n;
+        data_.resize(size_t(rows_) * cols_, fill);
+    }
+
+    // AppendRows: add the rows of m, shifted right by left columns, and padded
+    // on both sides with fill.
+
+    void AppendRows(const StackMatrix &m, const int left, const T fill) {
+        ForceAssertLe(left + m.Cols(), cols_);
+        int oldRows = rows_;
+        AppendRows(m.Rows(), fill);
+        for (int i = 0; i < m.Rows(); i++)
+            std::copy(m[i], m[i] + m.Cols(), (*this)[oldRows + i] + left);
+    }
+
+    // EraseRows: remove the rows i for which to_remove[i] is True.
+
+    void EraseRows(const vec<Bool> &to_remove) {
+        int j = 0;
+        for (int i = 0; i < rows_; i++) {
+            if (to_remove[i]) continue;
+            if (i != j) std::copy((*this)[i], (*this)[i] + cols_, (*this)[j]);
+            ++j;
+        }
+        rows_ = j;
+        data_.resize(size_t(rows_) * cols_);
+    }
+
+    // PermuteRows: move row i to row permutation[i], as PermuteVec does.
+
+    void PermuteRows(const vec<int> &permutation) {
+        std::vector<T> old(data_);
+        for (int i = 0; i < rows_; i++)
+            std::copy(old.data() + size_t(i) * cols_, old.data() + size_t(i + 1) * cols_,
+                      (*this)[permutation[i]]);
+    }
+
+    // ReverseRows: reverse the order of the entries in each row.
+
+    void ReverseRows() {
+        for (int i = 0; i < rows_; i++)
+            std::reverse((*this)[i], (*this)[i] + cols_);
+    }
+
+    // Widen: add left columns on the left and right columns on the right.
+
+    void Widen(const int left, const int right, const T fill) {
+        if (left == 0 && right == 0) return;
+        StackMatrix m;
+        m.assign(rows_, left + cols_ + right, fill);
+        for (int i = 0; i < rows_; i++)
+            std::copy((*this)[i], (*this)[i] + cols_, m[i] + left);
+        std::swap(*this, m);
+    }
+
+    // SubCols: keep only the columns in [start,stop).
+
+    void SubCols(const int start, const int stop) {
+        int ncols = stop - start;
+        for (int i = 0; i < rows_; i++)
+            std::copy((*this)[i] + start, (*this)[i] + stop, data_.data() + size_t(i) * ncols);
+        cols_ = ncols;
+        data_.resize(size_t(rows_) * cols_);
+    }
+
+private:
+    int rows_;
+    int cols_;
+    std::vector<T> data_;
+};
+
+typedef StackMatrix<char> StackBaseMatrix;
+typedef StackMatrix<signed char> StackQualMatrix;
+
 typedef std::vector<char> StackBaseVec;
 typedef VecPlus<StackBaseVec> StackBaseVecVec;
 typedef std::vector<int> StackQualVec;
@@ -58,7 +161,7 @@ class readstack {
 public:
     static void init_LUTs() {
         for (auto i=0;i<1000;++i){
-            new_qual_LUT_s[i]=5.0 * log10(2 * i);
+            new_qual_LUT[i]=5.0 * log10(2 * i);
         }
     };
 
@@ -119,7 +222,7 @@ public:
     // ========================= ACCESSORS ========================================
 
     // Rows, Cols: return number of rows and columns.
-    int Rows() const { return bases_.size(); }
+    int Rows() const { return bases_.Rows(); }
 
     int Cols() const { return cols_; }
 
@@ -131,15 +234,16 @@ public:
 
     char Base(const int i, const int j) const { return bases_[i][j]; }
 
-    // Qual: return a given quality score (0-255), or -1 if undefined.
+    // Qual: return a given quality score (0-127), or -1 if undefined.
 
     int Qual(const int i, const int j) const { return quals_[i][j]; }
 
-    // SetBase, SetQual: set base or quality score.
+    // SetBase, SetQual: set base or quality score.  Quality scores are capped
+    // at 127.
 
     void SetBase(const int i, const int j, char b) { bases_[i][j] = b; }
 
-    void SetQual(const int i, const int j, int q) { quals_[i][j] = q; }
+    void SetQual(const int i, const int j, int q) { quals_[i][j] = std::min(q, 127); }
 
     // Offset: implied start position of read or its rc relative to first column.
 
@@ -179,9 +283,9 @@ public:
 
     // Functions to return the entire matrix.
 
-    const StackBaseVecVec &Bases() const { return bases_; }
+    const StackBaseMatrix &Bases() const { return bases_; }
 
-    const StackQualVecVec &Quals() const { return quals_; }
+    const StackQualMatrix &Quals() const { return quals_; }
 
     const vec<int64_t> &Id() const { return id_; }
 
@@ -351,15 +455,28 @@ public:
 
     void Print(std::ostream &out, const vec<vec<char>> &con, const int w = 70) const;
 
+    // QualSums: for each column c and base b, set sums[4*c+b] to the sum of the
+    // quality scores of the defined entries in column c having base b.  Q0 is
+    // counted as q0, and Q1 and Q2 as 0.2.  The whole stack is read in one
+    // pass, in storage order, and rows are added in order, so the sums are the
+    // same as for a column-by-column loop.  If top is given, also set
+    // (*top)[4*c+b] to the largest such quality score, or 0 if there is none.
+
+    void QualSums(const double q0, vec<double> &sums,
+                  vec<int> *top = nullptr) const;
+
+    // ColumnConsensuses1: ColumnConsensus1 for every column.
+
+    void ColumnConsensuses1(basevector &con) const;
+
     // ========================= PRIVATE ==========================================
 
 
 private:
-    static double new_qual_LUT_s[1000];
-    double new_qual_LUT_l[1000];
+    static double new_qual_LUT[1000];
     int cols_;
-    StackBaseVecVec bases_;
-    StackQualVecVec quals_;
+    StackBaseMatrix bases_;
+    StackQualMatrix quals_;
     VecPlus<int64_t> id_;
     VecPlus<Bool> rc2_;
     VecPlus<int64_t> pid_;
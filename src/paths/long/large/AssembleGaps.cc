@@ -15,11 +15,15 @@
 #include "kmers/BigKPather.h"
 #include "paths/HyperBasevector.h"
 #include "paths/long/LargeKDispatcher.h"
+#include "paths/long/LongHyper.h"
 #include "paths/long/MakeKmerStuff.h"
 #include "paths/long/ReadPath.h"
 #include "paths/long/large/AssembleGaps.h"
 #include "paths/long/large/GapToyTools.h"
 #include "paths/long/large/Unsat.h"
+#include "feudal/BinaryStream.h"
+#include "system/MemoryGovernor.h"
+#include "system/SpareThreads.h"
 #include "system/SortInPlace.h"
 #include <util/w2rap_timers.h>
 #include <paths/long/LoadCorrectCore.h>
@@ -311,14 +315,27 @@ void AssembleGaps2(HyperBasevector &hb, vec<int> &inv2, ReadPathVec &paths2,
     //TODO: check local variable usage, should be made minimal!!!
     //Init readstacks, we'll need them!
     readstack::init_LUTs();
-#define BATCH_SIZE 5000
 
-    for (uint64_t bstart = 0; bstart < nblobs; bstart += BATCH_SIZE) {
+    // The local assemblies pile up in mhbp until patching.  Batches shrink if
+    // the assemblies are large, and once the ones held in memory outgrow a
+    // quarter of the budget they are spilled, to be read back after the
+    // layouts are freed.
+    const uint64_t MAX_BATCH_SIZE = 5000, MIN_BATCH_SIZE = 500;
+    const size_t allowance = MemoryGovernor::budget() / 4;
+    uint64_t batch_size = MAX_BATCH_SIZE, unspilled = 0;
+    size_t held_bytes = 0;
+    vec<std::pair<std::pair<uint64_t, uint64_t>, String>> spills;
+
+    for (uint64_t bstart = 0; bstart < nblobs; bstart += batch_size) {
+        uint64_t bstop = std::min(bstart + batch_size, (uint64_t) nblobs);
+        // Threads that run out of blobs lend themselves to read correction in
+        // the blobs that are still running.
+        SpareThreads::Pool spares;
         #pragma omp parallel
         {
-            #pragma omp for schedule(dynamic,1)
-            for (uint64_t bl = bstart; bl < bstart + BATCH_SIZE; ++bl) {
-                if (bl >= nblobs) continue;
+            SpareThreads::enter();
+            #pragma omp for schedule(dynamic,1) nowait
+            for (uint64_t bl = bstart; bl < bstop; ++bl) {
                 //First part: create the gbases and gquals. this is locked by memory accesses and very convoluted
                 const vec<int> &lefts = LR[bl].first, &rights = LR[bl].second; //TODO: how big is this? can we copy it?
 
@@ -353,10 +370,19 @@ void AssembleGaps2(HyperBasevector &hb, vec<int> &inv2, ReadPathVec &paths2,
                 CorrectionSuite(gbases, gquals, gpairs, heur, creads, corrected, cid, cpartner, NUM_THREADS, "",
                                 False);
 
+                // The reads are expanded and K2 chosen once for all floors.  A
+                // floor that leaves K2 where it was would rebuild the graph
+                // that was just found cyclic, so it is skipped.
+                std::unique_ptr<long_hyper_reads> lhreads;
+                int lastK2 = -1;
                 for (auto K2_FLOOR_LOCAL: k2floor_sequence) {
+                    int K2 = LocalAssemblyK2(corrected, K2_FLOOR_LOCAL, lhreads);
+                    if (K2 == lastK2) continue;
+                    lastK2 = K2;
                     SupportedHyperBasevector shb;
 
-                    MakeLocalAssembly2(corrected, lefts, rights, shb, K2_FLOOR_LOCAL, creads, cid, cpartner);
+                    MakeLocalAssembly2(corrected, lefts, rights, shb, K2_FLOOR_LOCAL, creads, cid, cpartner,
+                                       lhreads.get());
 
                     if (shb.K() == 0) continue;
 
@@ -466,15 +492,50 @@ void AssembleGaps2(HyperBasevector &hb, vec<int> &inv2, ReadPathVec &paths2,
                 }
                 //}//---OMP TASK END---
             }
+            SpareThreads::donate();
         }
 
-        std::cout << Date() << ": "<< std::min(bstart+BATCH_SIZE,(uint64_t)nblobs) <<" blobs processed, paths found for " << solved << std::endl;
+        std::cout << Date() << ": "<< bstop <<" blobs processed, paths found for " << solved << std::endl;
+
+        size_t batch_bytes = 0;
+        for (uint64_t bl = bstart; bl < bstop; ++bl)
+            for (int e = 0; e < mhbp[bl].EdgeObjectCount(); e++)
+                batch_bytes += sizeof(basevector) + mhbp[bl].EdgeObject(e).size() / 4;
+        held_bytes += batch_bytes;
+        if (held_bytes > allowance && bstop < (uint64_t) nblobs) {
+            String fn = MemoryGovernor::spillFile("blobs");
+            std::cout << Date() << ": spilling assemblies of blobs " << unspilled << "-" << bstop << " to " << fn << std::endl;
+            BinaryWriter writer(fn.c_str());
+            for (uint64_t bl = unspilled; bl < bstop; ++bl) {
+                writer.write(mhbp[bl]);
+                mhbp[bl] = HyperBasevector();
+            }
+            writer.close();
+            spills.push(std::make_pair(unspilled, bstop), fn);
+            unspilled = bstop;
+            held_bytes = 0;
+        }
+        size_t blob_bytes = batch_bytes / (bstop - bstart) + 1;
+        batch_size = MemoryGovernor::batchSize(8 * blob_bytes, MIN_BATCH_SIZE, MAX_BATCH_SIZE);
     }
     std::cout << Date() << TimeSince(clockp1) << " spent in local assemblies." << std::endl;
 
     TIMELOG_REPORT(std::cout,AssembleGaps,AG2_FindPids,AG2_ReadSetCreation,AG2_CorrectionSuite,AG2_LocalAssembly2,AG2_LocalAssemblyEval,AG2_CreateBpaths,AG2_PushBpathsToGraph);
     TIMELOG_REPORT(std::cout,Correct1Pre,C1P_Align,C1P_InitBasesQuals,C1P_Correct,C1P_UpdateBasesQuals);
     TIMELOG_REPORT(std::cout,CorrectPairs1,CP1_Align,CP1_MakeStacks,CP1_Correct);
+    // Free the layouts and bring back any spilled assemblies.
+    std::vector<std::vector<int>>().swap(layout_pos);
+    std::vector<std::vector<int64_t>>().swap(layout_id);
+    std::vector<std::vector<bool>>().swap(layout_or);
+    for (const auto &spill : spills) {
+        {
+            BinaryReader reader(spill.second.c_str());
+            for (uint64_t bl = spill.first.first; bl < spill.first.second; ++bl)
+                reader.read(&mhbp[bl]);
+        }
+        Remove(spill.second);
+    }
+
     // Do the patching.
     const vec<std::pair<int, int> > blobs(LR.size());
     Patch(hb, blobs, mhbp, work_dir, new_stuff);
@@ -199,6 +199,33 @@ void Clean200( HyperBasevector& hb, vec<int>& inv, ReadPathVec& paths,
      Validate( hb, inv, paths );    
      std::cout << TimeSince(clock) << " used cleaning large_k-mer graph" << std::endl;    }
 
+namespace
+{
+
+// A branching vertex under consideration, and its extensions.
+
+struct BranchWork
+{    int n;                  // number of branches
+     int depth;
+     vec<int> ei;            // branch of each extension
+     vec<PackedBases> exts;  // extension sequences
+     int64_t jobs_start, jobs_stop;
+};
+
+// A read to be scored against the extensions of a vertex.  For rc reads, the
+// reverse complement of the read is compared, so that every job is scored in
+// the forward frame of the extensions.
+
+struct ScoreJob
+{    int64_t id;
+     int64_t slot;    // index of result
+     int vert;        // index into BranchWork
+     int start;       // start of read relative to extensions (see below)
+     Bool rc;
+};
+
+} // end of anonymous namespace
+
 void Clean200x( HyperBasevector& hb, vec<int>& inv, ReadPathVec& paths,
      const vecbasevector& bases, const VecPQVec& quals, const int verbosity,
      const int version, const uint min_size )
@@ -211,6 +238,7 @@ void Clean200x( HyperBasevector& hb, vec<int>& inv, ReadPathVec& paths,
 
      const int max_exts = 10;
      const int npasses = 2;
+     const int batch_verts = 200000;
 
      // Run two passes.
 
@@ -226,144 +254,203 @@ void Clean200x( HyperBasevector& hb, vec<int>& inv, ReadPathVec& paths,
      HyperBasevectorX hbx(hb);
      VecULongVec paths_index;
      invert( paths, paths_index, hb.EdgeObjectCount( ) );
+     const int K = hb.K( );
 
-     // Look for weak branches.
+     // Look for weak branches.  This is done in batches of vertices.  For each
+     // batch, we first find the extensions of each vertex and the reads to be
+     // scored against them, then score the reads grouped by read id, so that
+     // each read's qualities are decoded once per batch rather than once per
+     // vertex, and finally analyze the scores vertex by vertex.
 
      std::cout << Date( ) << ": start walking" << std::endl;
      std::cout << "memory in use = " << ToStringAddCommas( MemUsageBytes( ) ) << std::endl;
      const int max_rl = 250;
-     vec<int> to_delete;
-     #pragma omp parallel for
+     vec<int> verts;
      for ( int v = 0; v < hb.N( ); v++ )
-     {    if ( hb.To(v).empty( ) || hb.From(v).size( ) <= 1 ) continue;
-
-          // Find extensions of e.
-
-          int n = hb.From(v).size( );
-          int depth = max_rl;
-          vec< vec<int> > exts;
-          GetExtensions( hbx, v, max_exts, exts, depth );
-          if ( exts.isize( ) > max_exts ) continue;
-          int N = exts.size( );
-          vec<int> ei(N);
-          for ( int i = 0; i < N; i++ )
-          for ( int j = 0; j < n; j++ )
-               if ( exts[i][0] == hb.IFrom( v, j ) ) ei[i] = j;
-
-          // Convert to basevectors.
-
-          vec<basevector> bexts, rbexts;
-          for ( int i = 0; i < N; i++ )
-          {    const vec<int>& x = exts[i];
-               basevector b = hb.Cat(x);
-               bexts.push_back(b);
-               b.ReverseComplement( );
-               rbexts.push_back(b);    }
-
-          // Score each read path containing a predecessor or successor of e.
-
-          vec<vec<int>> scores(n);
-          vec< std::pair<int64_t,int> > pi; // {(id,start)}
-          for ( int u = 0; u < hb.To(v).isize( ); u++ )
-          {    int e = hb.ITo( v, u );
-               for ( int64_t i = 0; i < (int64_t) paths_index[e].size( ); i++ )
-               {    int64_t id = paths_index[e][i];
-                    const ReadPath& p = paths[id];
-                    for ( int j = 0; j < (int) p.size( ); j++ )
-                    {    if ( p[j] == e ) 
-                         {    int start = p.getOffset( );
-                              for ( int l = 0; l <= j; l++ )
-                                   start -= hb.Kmers( p[l] );
-                              pi.push( id, start );    }    }    }    }
-          for ( int m = 0; m < n; m++ )
-          {    int ep = hb.IFrom( v, m );
-               for ( int64_t i = 0; i < (int64_t) paths_index[ep].size( ); i++ )
-               {    int64_t id = paths_index[ep][i];
-                    const ReadPath& p = paths[id];
-                    for ( int64_t j = 0; j < (int64_t) p.size( ); j++ )
-                    {    if ( p[j] == ep ) 
-                         {    if ( j > 0 && Member( hb.ToEdgeObj(v), p[j-1] ) )
-                                   continue;
-                              int start = p.getOffset( );
-                              for ( int l = 0; l < j; l++ )
-                                   start -= hb.Kmers( p[l] );
-                              pi.push( id, start );    }    }    }    }
-          qvec qv;
-          for ( int i = 0; i < pi.isize( ); i++ )
-          {    int64_t id = pi[i].first; 
-               int start = pi[i].second;
+          if ( hb.To(v).nonempty( ) && hb.From(v).size( ) > 1 ) verts.push_back(v);
+     vec<int> to_delete;
+     for ( int64_t bstart = 0; bstart < verts.isize( ); bstart += batch_verts )
+     {    const int nb = Min( (int64_t) batch_verts, verts.isize( ) - bstart );
+          vec<BranchWork> work(nb);
+          vec< vec<ScoreJob> > vjobs(nb);
+
+          // Find extensions and reads.
+
+          #pragma omp parallel for schedule(dynamic,100)
+          for ( int iv = 0; iv < nb; iv++ )
+          {    const int v = verts[ bstart + iv ];
+               BranchWork& W = work[iv];
+
+               // Find extensions of e.
+
+               int n = hb.From(v).size( );
+               W.n = n;
+               int depth = max_rl;
+               vec< vec<int> > exts;
+               GetExtensions( hbx, v, max_exts, exts, depth );
+               W.depth = depth;
+               if ( exts.isize( ) > max_exts ) 
+               {    W.n = 0;
+                    continue;    }
+               int N = exts.size( );
+               W.ei.resize(N);
+               for ( int i = 0; i < N; i++ )
+               for ( int j = 0; j < n; j++ )
+                    if ( exts[i][0] == hb.IFrom( v, j ) ) W.ei[i] = j;
+
+               // Convert to packed bases.
+
+               W.exts.resize(N);
+               for ( int i = 0; i < N; i++ )
+                    W.exts[i].assign( hb.Cat( exts[i] ) );
+
+               // Find each read path containing a predecessor or successor of e.
+
+               vec<ScoreJob>& jobs = vjobs[iv];
+               for ( int u = 0; u < hb.To(v).isize( ); u++ )
+               {    int e = hb.ITo( v, u );
+                    for ( int64_t i = 0; i < (int64_t) paths_index[e].size( ); i++ )
+                    {    int64_t id = paths_index[e][i];
+                         const ReadPath& p = paths[id];
+                         for ( int j = 0; j < (int) p.size( ); j++ )
+                         {    if ( p[j] == e ) 
+                              {    int start = p.getOffset( );
+                                   for ( int l = 0; l <= j; l++ )
+                                        start -= hb.Kmers( p[l] );
+                                   jobs.push_back( 
+                                        ScoreJob{ id, 0, iv, start, False } );    }    }    }    }
+               for ( int m = 0; m < n; m++ )
+               {    int ep = hb.IFrom( v, m );
+                    for ( int64_t i = 0; i < (int64_t) paths_index[ep].size( ); i++ )
+                    {    int64_t id = paths_index[ep][i];
+                         const ReadPath& p = paths[id];
+                         for ( int64_t j = 0; j < (int64_t) p.size( ); j++ )
+                         {    if ( p[j] == ep ) 
+                              {    if ( j > 0 && Member( hb.ToEdgeObj(v), p[j-1] ) )
+                                        continue;
+                                   int start = p.getOffset( );
+                                   for ( int l = 0; l < j; l++ )
+                                        start -= hb.Kmers( p[l] );
+                                   jobs.push_back( 
+                                        ScoreJob{ id, 0, iv, start, False } );    }    }    }    }
+
+               // Find each read path containing rc of e or its successor.
+
+               vec<int> res;
+               for ( int64_t u = 0; u < hb.To(v).isize( ); u++ )
+               {    int64_t e = hb.ITo( v, u );
+                    int64_t re = inv[e];
+                    res.push_back(re);
+                    for ( int64_t i = 0; i < (int64_t) paths_index[re].size( ); i++ )
+                    {    int64_t id = paths_index[re][i];
+                         const ReadPath& p = paths[id];
+                         for ( int64_t j = 0; j < (int64_t) p.size( ); j++ )
+                         {    if ( p[j] == re ) 
+                              {    int start = p.getOffset( );
+                                   for ( int l = 0; l < j; l++ )
+                                        start -= hb.Kmers( p[l] );
+                                   jobs.push_back( 
+                                        ScoreJob{ id, 0, iv, start, True } );    }    }    }    }
+               for ( int m = 0; m < n; m++ )
+               {    int64_t rep = inv[ hb.IFrom( v, m ) ];
+                    for ( int64_t i = 0; i < (int64_t) paths_index[rep].size( ); i++ )
+                    {    int64_t id = paths_index[rep][i];
+                         const ReadPath& p = paths[id];
+                         for ( int64_t j = 0; j < (int64_t) p.size( ); j++ )
+                         {    if ( p[j] == rep ) 
+                              {    if ( j < (int64_t) p.size( ) - 1 && Member( res, p[j+1] ) )
+                                        continue;     
+                                   int start = p.getOffset( );
+                                   for ( int l = 0; l <= j; l++ )
+                                        start -= hb.Kmers( p[l] );
+                                   jobs.push_back( 
+                                        ScoreJob{ id, 0, iv, start, True } );    }    }    }    }    }
+
+          // Gather the jobs and group them by read.
+
+          vec<ScoreJob> jobs;
+          {    int64_t njobs = 0;
+               for ( int iv = 0; iv < nb; iv++ )
+                    njobs += vjobs[iv].size( );
+               jobs.reserve(njobs);
+               for ( int iv = 0; iv < nb; iv++ )
+               {    work[iv].jobs_start = jobs.size( );
+                    for ( auto const& job : vjobs[iv] )
+                    {    jobs.push_back(job);
+                         jobs.back( ).slot = jobs.size( ) - 1;    }
+                    work[iv].jobs_stop = jobs.size( );
+                    Destroy( vjobs[iv] );    }    }
+          ParallelSort( jobs, []( ScoreJob const& j1, ScoreJob const& j2 )
+               { return j1.id < j2.id || ( j1.id == j2.id && j1.slot < j2.slot ); } );
+          vec<int64_t> group_starts;
+          for ( int64_t i = 0; i < jobs.jsize( ); i++ )
+               if ( i == 0 || jobs[i].id != jobs[i-1].id ) group_starts.push_back(i);
+          group_starts.push_back( jobs.size( ) );
+
+          // Score reads.  A result is (winning branch, margin), or branch -1 if
+          // there is no unique best branch.
+
+          vec< std::pair<int,int> > results( jobs.size( ) );
+          #pragma omp parallel for schedule(dynamic,100)
+          for ( int64_t g = 0; g < group_starts.jsize( ) - 1; g++ )
+          {    const int64_t id = jobs[ group_starts[g] ].id;
+               const int L = bases[id].size( );
+               qvec qv, rqv;
                quals[id].unpack(&qv);
-               const ReadPath& p = paths[id];
-               vec<int> q( N, 0 );
-               for ( int pos = 0; pos < depth + hb.K( ) - 1; pos++ )
-               {    int rpos = pos - start;
-                    if ( rpos < 0 || rpos >= bases[id].isize( ) ) continue;
+               PackedBases read( bases[id] ), rread;
+               Bool have_rc = False;
+               vec<int> q, qq;
+               for ( int64_t i = group_starts[g]; i < group_starts[g+1]; i++ )
+               {    const ScoreJob& job = jobs[i];
+                    const BranchWork& W = work[job.vert];
+                    const int D = W.depth + K - 1;
+                    const PackedBases* r = &read;
+                    const unsigned char* qp = ( qv.empty( ) ? NULL : &qv[0] );
+                    int offset = job.start;
+                    if ( job.rc )
+                    {    if ( !have_rc )
+                         {    basevector b( bases[id] );
+                              b.ReverseComplement( );
+                              rread.assign(b);
+                              rqv.resize( qv.size( ) );
+                              for ( int i = 0; i < (int) qv.size( ); i++ )
+                                   rqv[i] = qv[ qv.size( ) - 1 - i ];
+                              have_rc = True;    }
+                         r = &rread, qp = ( rqv.empty( ) ? NULL : &rqv[0] );
+                         offset = -( L - K + 1 + job.start );    }
+                    const int lo = Max( 0, offset ), hi = Min( D, offset + L );
+                    const int N = W.exts.size( );
+                    q.assign( N, 0 );
                     for ( int l = 0; l < N; l++ )
-                    {    if ( bexts[l][pos] != bases[id][rpos] )
-                              q[l] += qv[rpos];    }    }
-               vec<int> qq( n, 1000000000 );
-               for ( int l = 0; l < N; l++ )
-                    qq[ ei[l] ] = Min( qq[ ei[l] ], q[l] );
-               vec<int> idx( n, vec<int>::IDENTITY );
-               SortSync( qq, idx );
-               if ( qq[0] < qq[1] ) scores[ idx[0] ].push_back( qq[1] - qq[0] );    }
-
-          // Score each read path containing rc of e or its successor.
-
-          vec< std::pair<int64_t,int> > rpi; // {(id, start of read rel edge re)}
-          vec<int> res;
-          for ( int64_t u = 0; u < hb.To(v).isize( ); u++ )
-          {    int64_t e = hb.ITo( v, u );
-               int64_t re = inv[e];
-               res.push_back(re);
-               for ( int64_t i = 0; i < (int64_t) paths_index[re].size( ); i++ )
-               {    int64_t id = paths_index[re][i];
-                    const ReadPath& p = paths[id];
-                    for ( int64_t j = 0; j < (int64_t) p.size( ); j++ )
-                    {    if ( p[j] == re ) 
-                         {    int start = p.getOffset( );
-                              for ( int l = 0; l < j; l++ )
-                                   start -= hb.Kmers( p[l] );
-                              rpi.push( id, start );    }    }    }    }
-          for ( int m = 0; m < n; m++ )
-          {    int64_t rep = inv[ hb.IFrom( v, m ) ];
-               for ( int64_t i = 0; i < (int64_t) paths_index[rep].size( ); i++ )
-               {    int64_t id = paths_index[rep][i];
-                    const ReadPath& p = paths[id];
-                    for ( int64_t j = 0; j < (int64_t) p.size( ); j++ )
-                    {    if ( p[j] == rep ) 
-                         {    if ( j < (int64_t) p.size( ) - 1 && Member( res, p[j+1] ) )
-                                   continue;     
-                              int start = p.getOffset( );
-                              for ( int l = 0; l <= j; l++ )
-                                   start -= hb.Kmers( p[l] );
-                              rpi.push( id, start );    }    }    }    }
-          for ( int i = 0; i < rpi.isize( ); i++ )
-          {    int64_t id = rpi[i].first; 
-               int start = rpi[i].second;
-               quals[id].unpack(&qv);
-               const ReadPath& p = paths[id];
-               vec<int> q( N, 0 );
-               for ( int pos = 0; pos < depth + hb.K( ) - 1; pos++ )
-               {    int rpos = hb.K( ) - 2 - pos - start;
-                    if ( rpos < 0 || rpos >= bases[id].isize( ) ) continue;
+                         q[l] = MismatchQualSum( W.exts[l], *r, qp, offset, lo, hi );
+                    qq.assign( W.n, 1000000000 );
                     for ( int l = 0; l < N; l++ )
-                    {    int s = bexts[l].size( );
-                         if ( rbexts[l][s-pos-1] != bases[id][rpos] )
-                              q[l] += qv[rpos];    }    }
-               vec<int> qq( n, 1000000000 );
-               for ( int l = 0; l < N; l++ )
-                    qq[ ei[l] ] = Min( qq[ ei[l] ], q[l] );
-               vec<int> idx( n, vec<int>::IDENTITY );
-               SortSync( qq, idx );
-               if ( qq[0] < qq[1] ) scores[ idx[0] ].push_back( qq[1] - qq[0] );    }
+                         qq[ W.ei[l] ] = Min( qq[ W.ei[l] ], q[l] );
+                    int best = 0;
+                    for ( int j = 1; j < W.n; j++ )
+                         if ( qq[j] < qq[best] ) best = j;
+                    int second = 1000000000;
+                    for ( int j = 0; j < W.n; j++ )
+                         if ( j != best ) second = Min( second, qq[j] );
+                    results[ job.slot ] = ( qq[best] < second
+                         ? std::make_pair( best, second - qq[best] )
+                         : std::make_pair( -1, 0 ) );    }    }
+          Destroy(jobs), Destroy(group_starts);
 
           // Analyze scores.
 
-          for ( int j = 0; j < n; j++ )
-               ReverseSort( scores[j] );
-          AnalyzeScores( hbx, inv, v, scores, to_delete, zpass, verbosity,
-               version );    }
+          #pragma omp parallel for schedule(dynamic,100)
+          for ( int iv = 0; iv < nb; iv++ )
+          {    const BranchWork& W = work[iv];
+               if ( W.n == 0 ) continue;
+               vec<vec<int>> scores( W.n );
+               for ( int64_t i = W.jobs_start; i < W.jobs_stop; i++ )
+                    if ( results[i].first >= 0 )
+                         scores[ results[i].first ].push_back( results[i].second );
+               for ( int j = 0; j < W.n; j++ )
+                    ReverseSort( scores[j] );
+               AnalyzeScores( hbx, inv, verts[ bstart + iv ], scores, to_delete,
+                    zpass, verbosity, version );    }    }
 
      // Remove tiny standalone edges
 
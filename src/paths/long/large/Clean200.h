@@ -29,4 +29,50 @@ void Clean200x( HyperBasevector& hb, vec<int>& inv, ReadPathVec& paths,
 void GetExtensions( const HyperBasevectorX& hb, const int v,
      const int max_exts, vec<vec<int>>& exts, int& depth );
 
+// Bases packed 32 to a word, left-most base in the lowest two bits, as laid
+// out by BaseVec::extractBaseBits.  One word of zero padding lets any 32-base
+// window that starts inside the sequence be read with two loads.
+
+class PackedBases
+{
+public:
+     PackedBases( ) : mSize(0) { }
+     explicit PackedBases( const basevector& b ) { assign(b); }
+
+     void assign( const basevector& b )
+     {    mSize = b.size( );
+          mWords.assign( mSize/32 + 2, 0 );
+          b.extractBaseBits( mWords.data( ), mWords.size( ) * sizeof(uint64_t) );    }
+
+     int size( ) const { return mSize; }
+
+     // The 32 bases starting at pos, which must be in [0,size()].
+     uint64_t window( const int pos ) const
+     {    int w = pos >> 5, sh = ( pos & 31 ) << 1;
+          if ( sh == 0 ) return mWords[w];
+          return ( mWords[w] >> sh ) | ( mWords[w+1] << ( 64 - sh ) );    }
+
+private:
+     int mSize;
+     std::vector<uint64_t> mWords;
+};
+
+// Sum the read qualities at mismatches between an extension and a read, over
+// extension positions [lo,hi), where extension position pos faces read position
+// pos - offset.  Bases are compared 32 at a time: the xor of two packed words is
+// folded to one bit per base, and only the mismatching positions are visited.
+
+inline int MismatchQualSum( const PackedBases& ext, const PackedBases& read,
+     const unsigned char* q, const int offset, const int lo, const int hi )
+{    int sum = 0;
+     for ( int pos = lo; pos < hi; pos += 32 )
+     {    uint64_t x = ext.window(pos) ^ read.window( pos - offset );
+          uint64_t m = ( x | ( x >> 1 ) ) & 0x5555555555555555ull;
+          int nb = hi - pos;
+          if ( nb < 32 ) m &= ( 1ull << ( 2*nb ) ) - 1;
+          while (m)
+          {    sum += q[ pos - offset + ( __builtin_ctzll(m) >> 1 ) ];
+               m &= m - 1;    }    }
+     return sum;    }
+
 #endif
@@ -16,6 +16,7 @@
 #include "paths/long/large/FinalFiles.h"
 #include "paths/long/large/GapToyTools.h"
 #include "paths/long/large/Lines.h"
+#include "paths/long/large/PathStats.h"
 
 // Build final assembly files, starting from the results of scaffolding.
 
@@ -23,7 +24,7 @@ void FinalFiles(const HyperBasevector &hb, const vec<int> &inv, const
 ReadPathVec &paths, const vec<String> &subsam_names,
                 const vec<int64_t> &subsam_starts, const String &work_dir, const String &prefix,
                 const int MAX_CELL_PATHS, const int MAX_DEPTH,
-                const vecbasevector &G) {
+                const vecbasevector &G, vec<vec<vec<vec<int>>>>* lines_out) {
      // Write some assembly files.
 
      TestInvolution(hb, inv);
@@ -38,13 +39,19 @@ ReadPathVec &paths, const vec<String> &subsam_names,
      BinaryWriter::writeFile(work_dir + "/" + prefix + ".lines", linesx);
      DumpLineFiles(linesx, hb, inv, paths, work_dir);
      {
+          vec<int> tolx;
+          GetTol(hb, linesx, tolx);
+          LinePairStat line_pairs(inv, tolx, linesx.size(), subsam_starts);
+          ScanPairs(paths, {&line_pairs});
+          VecULongVec paths_index;
+          invert(paths, paths_index, hb.EdgeObjectCount());
           vec<vec<covcount>> covsx;
-          ComputeCoverage(hb, inv, paths, linesx, subsam_starts, covsx);
+          ComputeCoverage(hb, inv, paths, paths_index, linesx, subsam_starts,
+               line_pairs.npairs(), covsx);
           BinaryWriter::writeFile(work_dir + "/" + prefix + ".covs", covsx);
-          vec<int> npairsx;
+          vec<int> npairsx = line_pairs.total();
           vec<int> llensx;
           GetLineLengths(hb, linesx, llensx);
-          GetLineNpairs(hb, inv, paths, linesx, npairsx);
           BinaryWriter::writeFile(work_dir + "/" + prefix + ".lines.npairs", npairsx);
           WriteLineStats(work_dir + "/" + prefix, linesx, llensx, npairsx, covsx);
 
@@ -103,6 +110,8 @@ ReadPathVec &paths, const vec<String> &subsam_names,
 
      }
 
+     if (lines_out != NULL) *lines_out = std::move(linesx);
+
 
      // Compute edge coverage.
      /*
@@ -16,12 +16,14 @@
 #include "paths/long/large/Lines.h"
 
 // Build final assembly files, starting from the results of scaffolding.
+// If lines_out is given, the (sorted) lines are returned there so that later
+// consumers such as GFADump need not find them again.
 
 void FinalFiles(
      const HyperBasevector& hb, const vec<int>& inv, const ReadPathVec& paths,
      const vec<String>& subsam_names, const vec<int64_t>& subsam_starts,
      const String& work_dir,  const String& prefix,
      const int MAX_CELL_PATHS, const int MAX_DEPTH,
-     const vecbasevector& G);
+     const vecbasevector& G, vec<vec<vec<vec<int>>>>* lines_out = NULL );
 
 #endif
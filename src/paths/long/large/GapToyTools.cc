@@ -373,7 +373,7 @@ void MakeLocalAssembly2(VecEFasta &corrected,
                         const vec<int> &lefts, const vec<int> &rights,
                         SupportedHyperBasevector &shb, const int K2_FLOOR,
                         vecbasevector &creads, vec<int> &cid,
-                        vec<pairing_info> &cpartner) {
+                        vec<pairing_info> &cpartner, const long_hyper_reads *reads) {
     long_logging logc("", "");
     logc.STATUS_LOGGING = False;
     logc.MIN_LOGGING = False;
@@ -388,7 +388,10 @@ void MakeLocalAssembly2(VecEFasta &corrected,
     if (count == 0) {
         //mout << "No reads were corrected." << std::endl;
     } else {
-        if (!LongHyper(corrected, cpartner, shb, heur, log_control, logc, False)) {
+        Bool ok = ( reads != nullptr
+                ? LongHyper(corrected, *reads, cpartner, shb, heur, log_control, logc, False)
+                : LongHyper(corrected, cpartner, shb, heur, log_control, logc, False) );
+        if (!ok) {
             //mout << "No paths were found." << std::endl;
             SupportedHyperBasevector shb0;
             shb = shb0;
@@ -408,6 +411,23 @@ void MakeLocalAssembly2(VecEFasta &corrected,
     mout << "assembly time 2 = " << TimeSince(clock) << std::endl;*/
 }
 
+int LocalAssemblyK2(const VecEFasta &corrected, const int K2_FLOOR,
+                    std::unique_ptr<long_hyper_reads> &reads) {
+    if (!reads) {
+        int count = 0;
+        for (int l = 0; l < (int) corrected.size(); l++)
+            if (corrected[l].size() > 0) count++;
+        if (count == 0) return 0;
+        long_logging logc("", "");
+        logc.STATUS_LOGGING = False;
+        logc.MIN_LOGGING = False;
+        reads.reset(new long_hyper_reads(corrected, long_heuristics(""), logc));
+    }
+    long_heuristics heur("");
+    heur.K2_FLOOR = K2_FLOOR;
+    return reads->K2(heur);
+}
+
 void LogTime( const double clock, const String& what, const String& work_dir )
 {    static String dir;
      if ( work_dir != "" ) dir = work_dir;
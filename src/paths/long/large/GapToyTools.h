@@ -108,10 +108,21 @@ void BasesToGraph( vecbasevector& bpathsx, const int K, HyperBasevector& hb );
 void GetRoots( const HyperBasevector& hb, vec<int>& to_left, vec<int>& to_right,
      const vec<int>& lefts, const vec<int>& rights, int& lroot, int& rroot );
 
+class long_hyper_reads;
+
+// If reads is given, it holds the expansion of corrected made by a previous
+// call, and is reused.
+
 void MakeLocalAssembly2( VecEFasta& corrected, const vec<int>& lefts, const vec<int>& rights,
      SupportedHyperBasevector& shb, const int K2_FLOOR,
      vecbasevector& creads, /*LongProtoTmpDirManager& tmp_mgr,*/ vec<int>& cid,
-     vec<pairing_info>& cpartner );
+     vec<pairing_info>& cpartner, const long_hyper_reads* reads = nullptr );
+
+// The K2 that MakeLocalAssembly2 would use for K2_FLOOR, or 0 if no reads were
+// corrected.  The expanded reads are made on first use and kept in reads.
+
+int LocalAssemblyK2( const VecEFasta& corrected, const int K2_FLOOR,
+     std::unique_ptr<long_hyper_reads>& reads );
 
 void PlaceMore( const HyperBasevector& hb, const vecbasevector& bases,
      const VecPQVec& quals, ReadPathVec& paths2, vec<int64_t>& placed,
@@ -188,7 +199,7 @@ void Empty( const HyperBasevector& hb, const vec< std::pair<vec<int>,vec<int>> >
 void AddNewStuff( vecbvec& new_stuff, HyperBasevector& hb, vec<int>& inv2, 
      ReadPathVec& paths2, const vecbasevector& bases, const VecPQVec& quals, 
      const int MIN_GAIN, const vec<int>& TRACE_PATHS, const String& work_dir,
-     const int EXT_MODE );
+     const int EXT_MODE, const Bool SPLICE = True );
 
 void ExtendPath( ReadPath& p, const int64_t i, const HyperBasevector& hb, 
      const vec<int>& to_right, const bvec& bases,
@@ -391,6 +402,10 @@ void BuildGenomeMap( const HyperBasevector& hb, const vec<int>& inv,
 void FragDist( const HyperBasevector& hb, const vec<int>& inv,
      const ReadPathVec& paths, const String out_file );
 
+// Write and plot the fragment size histogram of a FragSizeStat.
+
+void FragDist( const vec<double>& count, const String out_file );
+
 void UnwindThreeEdgePlasmids(HyperBasevector& hb, vec<int>& inv, ReadPathVec& paths);
 
 // Compute fraction of edges in the assembly whose copy number is within 10% of
@@ -409,6 +424,9 @@ void RemoveUnneededVerticesGeneralizedLoops( HyperBasevector& hb, vec<int>& inv,
 void BuildAll( vecbasevector& all, const HyperBasevector& hb, 
      const int64_t extra = 0 );
 
+void TranslatePath( ReadPath& p, const HyperBasevector& hb3,
+     const vec<vec<int>>& to3, const vec<int>& left3 );
+
 void TranslatePaths( ReadPathVec& paths2, const HyperBasevector& hb3,
      const vec<vec<int>>& to3, const vec<int>& left3 );
 
@@ -13,7 +13,7 @@
 #include "ParallelVecUtilities.h"
 #include "PrintAlignment.h"
 #include "Qualvector.h"
-#include "graphics/BasicGraphics.h"
+#include "graphics/SvgPlot.h"
 #include "kmers/LongReadPather.h"
 #include "paths/HyperBasevector.h"
 #include "paths/ReadsToPathsCoreX.h"
@@ -27,6 +27,7 @@
 #include "paths/long/ReadPathTools.h"
 #include "paths/long/ReadStack.h"
 #include "paths/long/large/GapToyTools.h"
+#include "paths/long/large/PathStats.h"
 #include <ctime>
 
 
@@ -615,24 +616,13 @@ void TestInvolution( const HyperBasevector& hb, const vec<int>& inv )
 
 void FragDist( const HyperBasevector& hb, const vec<int>& inv,
      const ReadPathVec& paths, const String out_file )
+{    FragSizeStat frag_sizes( hb, inv );
+     ScanPairs( paths, { &frag_sizes } );
+     FragDist( frag_sizes.counts( ), out_file );    }
+
+void FragDist( const vec<double>& count, const String out_file )
 {    
-     // Generate fragment distribution.
-
-     const int width = 10;
-     const int max_sep = 1000;
-     const int min_edge = 10000;
-     vec<double> count( max_sep/width, 0 );
-     for ( int64_t id1 = 0; id1 < (int64_t) paths.size( ); id1 += 2 )
-     {    int64_t id2 = id1 + 1;
-          if ( paths[id1].size( ) == 0 || paths[id2].size( ) == 0 ) continue;
-          int e1 = paths[id1][0], e2 = inv[ paths[id2][0] ];
-          int epos1 = paths[id1].getOffset( );
-          if ( e1 != e2 ) continue;
-          if ( hb.EdgeLengthBases(e1) < min_edge ) continue;
-          int epos2 = hb.EdgeLengthBases(e2) - paths[id2].getOffset( );
-          int len = epos2 - epos1;
-          if ( len < 0 || len >= max_sep ) continue;
-          count[ len/width ]++;    }
+     const int width = FragSizeStat::WIDTH;
 
      // Output distribution.
 
@@ -647,61 +637,28 @@ void FragDist( const HyperBasevector& hb, const vec<int>& inv,
 
      // Check for abject failure.
 
+     Remove( out_file + ".svg.FAIL" );
      if ( total == 0 )
-     {    Ofstream( out, out_file + ".png.FAIL" );
-          Remove( out_file + ".png" );
-          out << "Could not generate frags.dist.png because there was not\n"
+     {    Ofstream( out, out_file + ".svg.FAIL" );
+          Remove( out_file + ".svg" );
+          out << "Could not generate frags.dist.svg because there was not\n"
                << "enough assembly to compute the distribution." << std::endl;
           return;    }
 
-     // Check for missing executables.
-
-     vec<String> missing;
-     vec<String> ex = { "ps2epsi", "pstopnm", "pnmcrop", "pnmpad", "pnmtopng" };
-     for ( auto executable : ex )
-     {    if ( System( executable + " --version > /dev/null 2>&1" ) != 0 )
-               missing.push_back(executable);    }
-     if ( missing.nonempty( ) )
-     {    Ofstream( out, out_file + ".png.FAIL" );
-          out << "Could not generate frags.dist.png because the following "
-               << "executables were not found:\n" << printSeq(missing) 
-               << "." << std::endl;
-          Remove( out_file + ".png" );
-          return;    }
-
      // Make plot.
-          
-     String TITLE = "Fragment library size distribution";
-     vec<graphics_primitive> points, lines;
-     lines.push_back( SetLineWidth(1.0) );
-     double xm = 0.0, ym = 0.0;
+
+     vec<double> centers, mass;
      for ( int j = 0; j < count.isize( ); j++ )
-          points.push_back( Point( j * width + (width/2),  count[j]/total, 1.0 ) );
-     points.push_back( SetColor(black) );
-     points.append(lines);
-     double x = 0, X = MaxX(points), y = 0, Y = MaxY(points);
-     vec<graphics_primitive> x_axis = AxisX( x, X, 1.0, True, "", 0.0, False );
-     x_axis.push_front( SetLineWidth(1.0) );
-     vec<graphics_primitive> y_axis = AxisY( x, X, y, Y, True, "", 0.0, False );
-     vec<graphics_primitive> points2(y_axis);
-     points2.append(points);
-     points = points2;
-     vec< vec<graphics_primitive> > stack;
-     vec<double> heights;
-     stack.push_back(x_axis),    heights.push_back(0);
-     stack.push_back(points),    heights.push_back(200);
-     vec<graphics_primitive> title;
-     title.push_back( TextCenter( TITLE, (X+x)/2.0, 0, 0, TimesBold(15) ) );
-     stack.push_back(title);
-     heights.push_back(20);
-     String fail_msg = RenderGraphics( out_file + ".png", stack, heights, 1.0, 200, 
-          50, True, 1.0, True );
-     Remove( out_file + ".eps" );
+     {    centers.push_back( j * width + (width/2) );
+          mass.push_back( count[j]/total );    }
+     String fail_msg = WriteSvgHistogram( out_file + ".svg",
+          "Fragment library size distribution", "fragment size", "mass",
+          centers, mass );
      if ( fail_msg != "" )
-     {    Remove( out_file + ".png" );
-          Ofstream( out, out_file + ".png.FAIL" );
-          out << "Could not generate frags.dist.png because something went "
-               << "wrong, see below:\n\n" << fail_msg;
+     {    Remove( out_file + ".svg" );
+          Ofstream( out, out_file + ".svg.FAIL" );
+          out << "Could not generate frags.dist.svg because something went "
+               << "wrong, see below:\n\n" << fail_msg << std::endl;
           return;    }    }
 
 // UnwindThreeEdgePlasmids
@@ -36,6 +36,7 @@
 #include "paths/long/ReadStack.h"
 #include "paths/long/large/Lines.h"
 #include "paths/long/large/GapToyTools.h"
+#include "paths/long/large/SpliceNewStuff.h"
 #include "random/Bernoulli.h"
 #include "random/Random.h"
 #include "system/WorklistN.h"
@@ -161,45 +162,49 @@ void BuildAll( vecbasevector& allx, const HyperBasevector& hb, const int64_t ext
 
 // Note that this truncates to length 1.
 
+void TranslatePath( ReadPath& p, const HyperBasevector& hb3,
+     const vec<vec<int>>& to3, const vec<int>& left3 )
+{    if ( p.size( ) == 0 ) return;
+     int start = p.getOffset( ) + left3[ p[0] ];
+
+     if ( to3[p[0]].empty( ) )
+     {    p.clear( );
+          return;    }
+
+     if ( start < hb3.Bases( to3[ p[0] ][0] ) )
+     {    p.resize(1);
+          p[0] = to3[ p[0] ][0];
+          p.setOffset(start);
+          return;    }
+
+     SerfVec<int> q;
+     for ( int64_t j = 0; j < (int64_t) p.size( ); j++ )
+     {    if ( to3[ p[j] ].empty( ) ) break;
+          OverlapAppend( q, to3[p[j]] );    }
+     int trim = 0;
+     while( start >= hb3.EdgeLengthBases( q[trim] ) )
+     {    start -= hb3.EdgeLengthKmers( q[trim] );
+          trim++;
+          if ( trim == (int) q.size( ) ) break;    }
+
+     if ( trim == (int) q.size( ) )
+     {    p.clear( );
+          return;    }
+     p.resize(1);
+     p[0] = q[trim];
+     p.setOffset(start);    }
+
 void TranslatePaths( ReadPathVec& paths2, const HyperBasevector& hb3,
      const vec<vec<int>>& to3, const vec<int>& left3 )
 {
      #pragma omp parallel for
      for ( int64_t i = 0; i < (int64_t) paths2.size( ); i++ )
-     {    if ( paths2[i].size( ) == 0 ) continue;
-          int start = paths2[i].getOffset( ) + left3[ paths2[i][0] ];
-
-          if ( to3[paths2[i][0]].empty( ) )
-          {    paths2[i].clear( );
-               continue;    }
-     
-          if ( start < hb3.Bases( to3[ paths2[i][0] ][0] ) )
-          {    paths2[i].resize(1);
-               paths2[i][0] = to3[ paths2[i][0] ][0];
-               paths2[i].setOffset(start);
-               continue;    }
-
-          SerfVec<int> p;
-          for ( int64_t j = 0; j < (int64_t) paths2[i].size( ); j++ )
-          {    if ( to3[ paths2[i][j] ].empty( ) ) break;
-               OverlapAppend( p, to3[paths2[i][j]] );    }
-          int trim = 0;
-          while( start >= hb3.EdgeLengthBases( p[trim] ) )
-          {    start -= hb3.EdgeLengthKmers( p[trim] );
-               trim++;
-               if ( trim == (int) p.size( ) ) break;    }
-
-          if ( trim == (int) p.size( ) )
-          {    paths2[i].clear( );
-               continue;    }
-          paths2[i].resize(1);
-          paths2[i][0] = p[trim];
-          paths2[i].setOffset(start);    }    }
+          TranslatePath( paths2[i], hb3, to3, left3 );    }
 
 void AddNewStuff( vecbvec& new_stuff, HyperBasevector& hb, vec<int>& inv2, 
      ReadPathVec& paths2, const vecbasevector& bases, const VecPQVec& quals, 
      const int MIN_GAIN, const vec<int>& TRACE_PATHS, 
-     const String& work_dir, const int EXT_MODE )
+     const String& work_dir, const int EXT_MODE, const Bool SPLICE )
 {
      vec<int> trace_edges;
      if ( TRACE_PATHS.size() ) 
@@ -216,6 +221,17 @@ void AddNewStuff( vecbvec& new_stuff, HyperBasevector& hb, vec<int>& inv2,
      //const int K = 200;
      int K=hb.K();//TODO: check K effect
      ForceAssertEq( K, hb.K( ) );
+
+     // Usually the patches touch a small part of the graph, and only that part
+     // needs rebuilding.  The paths that don't reach it are kept as they are.
+
+     vec<Bool> remapped;
+     if ( SPLICE && trace_edges.empty( )
+          && SpliceNewStuff( new_stuff, hb, paths2, bases, remapped ) )
+     {    std::cout << TimeSince(clock1) << " used splicing in new stuff"
+               << std::endl;    }
+     else
+     {
      vec<Bool> used;
      hb.Used(used);
 
@@ -257,6 +273,8 @@ void AddNewStuff( vecbvec& new_stuff, HyperBasevector& hb, vec<int>& inv2,
      double clock3 = WallClockTime( );
      TranslatePaths( paths2, hb3, to3, left3 );
      hb = hb3;
+     remapped.resize( paths2.size( ), True );
+     }
      hb.Involution(inv2);
 
      // Extend paths.
@@ -269,7 +287,8 @@ void AddNewStuff( vecbvec& new_stuff, HyperBasevector& hb, vec<int>& inv2,
      hb.ToRight(to_right);
      #pragma omp parallel for
      for ( int64_t i = 0; i < (int64_t) paths2.size( ); i++ )
-     {    if ( paths2[i].size( ) > 0 ) paths2[i].resize(1);
+     {    if ( !remapped[i] ) continue;
+          if ( paths2[i].size( ) > 0 ) paths2[i].resize(1);
           ExtendPath( paths2[i], i, hb, to_right, bases[i], quals.begin()[i],
                   MIN_GAIN, extend_paths_verbose, EXT_MODE );    }
      Validate( hb, inv2, paths2 );
@@ -17,6 +17,7 @@
 #include "paths/long/ReadPath.h"
 #include "paths/long/large/GapToyTools.h"
 #include "paths/long/large/Lines.h"
+#include "paths/long/large/PathStats.h"
 #include "paths/long/large/CN1PeakFinder.h"
 #include "system/SortInPlace.h"
 
@@ -30,6 +31,12 @@ void FindLines( const HyperBasevector& hb, const vec<int>& inv,
 
      const int verts_mul = 2;
 
+     // Find the weakly connected components.  Neither cells nor lines cross
+     // component boundaries, so both are found one component at a time.
+
+     vec<vec<int>> comps;
+     hb.Components(comps);
+
      // Find some cells.  These do not include standard bubbles.
 
      vec<vec<vec<int>>> xpaths;
@@ -37,7 +44,7 @@ void FindLines( const HyperBasevector& hb, const vec<int>& inv,
      {    int max_cell_verts = verts_mul * max_cell_paths;
           vec< std::pair<int,int> > bounds0;
           // std::cout << Date( ) << ": finding cells" << std::endl;
-          FindSomeCells( hb, max_cell_verts, max_depth, bounds0 );
+          FindSomeCells( hb, max_cell_verts, max_depth, comps, bounds0 );
 
           // Symmetrize cells.
 
@@ -129,15 +136,31 @@ void FindLines( const HyperBasevector& hb, const vec<int>& inv,
              [&hb](int i1,int i2)
              {return hb.EdgeObject(i1).size()>hb.EdgeObject(i2).size();});
 
-     // Go through the edges and build lines.
-
-     vec<Bool> marked( nobj, False );
-     lines.clear( );
-     // #pragma omp parallel for // seems unsafe and doesn't save time
+     // Go through the edges and build lines.  Each component is processed
+     // independently, visiting its edges in the global length order, so the
+     // lines found are the same as for a single serial pass.  Lines are
+     // gathered per component and concatenated in component order, so the
+     // output does not depend on thread scheduling.  Marking is safe without
+     // locking because a line only touches edges of its own component.
+
+     vec<int> vcomp( hb.N( ) );
+     for ( int c = 0; c < comps.isize( ); c++ )
+     for ( int j = 0; j < comps[c].isize( ); j++ )
+          vcomp[ comps[c][j] ] = c;
+     vec<vec<int>> comp_edges( comps.size( ) );
      for ( int ie = 0; ie < nobj; ie++ )
      {    int e = ids[ie];
           if ( hb.EdgeLengthBases(e) == 0 ) continue;
           if ( !used[e] ) continue;
+          comp_edges[ vcomp[ to_left[e] ] ].push_back(e);    }
+     Destroy(vcomp);
+
+     vec<Bool> marked( nobj, False );
+     vec<LineVec> comp_lines( comps.size( ) );
+     #pragma omp parallel for schedule(dynamic,1)
+     for ( int c = 0; c < comps.isize( ); c++ )
+     for ( int ie = 0; ie < comp_edges[c].isize( ); ie++ )
+     {    int e = comp_edges[c][ie];
           if ( marked[e] ) continue;
           marked[e] = True;
 
@@ -186,8 +209,17 @@ void FindLines( const HyperBasevector& hb, const vec<int>& inv,
 
           // Save.
 
-          #pragma omp critical
-          {    lines.push_back( line, liner );    }    }
+          comp_lines[c].push_back( line, liner );    }
+
+     lines.clear( );
+     {    size_t nlines = 0;
+          for ( int c = 0; c < comp_lines.isize( ); c++ )
+               nlines += comp_lines[c].size( );
+          lines.reserve(nlines);
+          for ( int c = 0; c < comp_lines.isize( ); c++ )
+          {    for ( auto& line : comp_lines[c] )
+                    lines.push_back( std::move(line) );
+               Destroy( comp_lines[c] );    }    }
 
      // Order paths.
 
@@ -340,19 +372,11 @@ void GetLineNpairs( const HyperBasevector& hb, const vec<int>& inv,
      const ReadPathVec& paths, const vec<vec<vec<vec<int>>>>& lines, 
      vec<int>& npairs )
 {
-     npairs.resize_and_set( lines.size( ), 0 );
      vec<int> tol;
      GetTol( hb, lines, tol );
-     for ( int64_t pid = 0; pid < (int64_t) paths.size( ) / 2; pid++ )
-     {    int64_t id1 = 2*pid, id2 = 2*pid+1;
-          vec<int> e;
-          for ( int64_t j = 0; j < (int64_t) paths[id1].size( ); j++ )
-               e.push_back( tol[ paths[id1][j] ], tol[ inv[ paths[id1][j] ] ] );
-          for ( int64_t j = 0; j < (int64_t) paths[id2].size( ); j++ )
-               e.push_back( tol[ paths[id2][j] ], tol[ inv[ paths[id2][j] ] ] );
-          UniqueSort(e);
-          for ( int j = 0; j < e.isize( ); j++ )
-               npairs[ e[j] ]++;    }    }
+     LinePairStat line_pairs( inv, tol, lines.size( ), { 0 } );
+     ScanPairs( paths, { &line_pairs } );
+     npairs = line_pairs.total( );    }
 
 void WriteLineStats( const String& head, const vec<vec<vec<vec<int>>>>& lines,
      const vec<int>& llens, const vec<int>& npairs, const vec<vec<covcount>>& covs )
@@ -443,40 +467,29 @@ void ComputeCoverage( const HyperBasevector& hb, const vec<int>& inv,
      const ReadPathVec& paths, const vec<vec<vec<vec<int>>>>& lines,
      const vec<int64_t>& subsam_starts, vec<vec<covcount>>& covs )
 {
-     // Heuristics.
-
-     const int min_line = 1000;
-     const int top_group = 50;
-
-     // Index paths (better done outside this program).
+     // Index paths, and compute pairs touching each line.
 
      VecULongVec paths_index;
      invert( paths, paths_index, hb.EdgeObjectCount( ) );
+     vec<int> tol;
+     GetTol( hb, lines, tol );
+     LinePairStat line_pairs( inv, tol, lines.size( ), subsam_starts );
+     ScanPairs( paths, { &line_pairs } );
+     ComputeCoverage( hb, inv, paths, paths_index, lines, subsam_starts,
+          line_pairs.npairs( ), covs );    }
 
-     // Compute pairs touching each line.
+void ComputeCoverage( const HyperBasevector& hb, const vec<int>& inv, 
+     const ReadPathVec& paths, const VecULongVec& paths_index,
+     const vec<vec<vec<vec<int>>>>& lines, const vec<int64_t>& subsam_starts,
+     const vec<vec<int>>& npairs, vec<vec<covcount>>& covs )
+{
+     // Heuristics.
+
+     const int min_line = 1000;
+     const int top_group = 50;
 
      int ns = subsam_starts.size( );
      covs.resize(ns);
-     vec<vec<int>> npairs( ns, vec<int>( lines.size( ), 0 ) );
-     vec<int> tol;
-     GetTol( hb, lines, tol );
-     {
-	 vec<int> e;
-	 for ( int64_t pid = 0; pid < (int64_t) paths.size( ) / 2; pid++ ) {
-	     int64_t id1 = 2*pid, id2 = 2*pid+1;
-	     e.clear();
-	     for ( int64_t j = 0; j < (int64_t) paths[id1].size( ); j++ )
-		 e.push_back( tol[ paths[id1][j] ], tol[ inv[ paths[id1][j] ] ] );
-	     for ( int64_t j = 0; j < (int64_t) paths[id2].size( ); j++ )
-		 e.push_back( tol[ paths[id2][j] ], tol[ inv[ paths[id2][j] ] ] );
-	     UniqueSort(e);
-	     int ss;
-	     for ( ss = 0; ss < ns; ss++ )
-		 if ( ss == ns - 1 || 2*pid < subsam_starts[ss+1] ) break;
-	     for ( int64_t j = 0; j < e.isize( ); j++ )
-		 npairs[ss][ e[j] ]++; 
-	 } 
-     }
 
      // Compute coverage of lines.
 
@@ -661,17 +674,24 @@ void TestLineSymmetry( const vec<vec<vec<vec<int>>>>& lines, const vec<int>& inv
                     std::cout << "Fatal Error." << std::endl;
                     Scram(1);    }    }    }    }
 
-void SortLines( vec<vec<vec<vec<int>>>>& lines, const HyperBasevector& hb,
-     const vec<int>& inv )
+void SortedLineOrder( const vec<vec<vec<vec<int>>>>& lines,
+     const HyperBasevector& hb, const vec<int>& inv, vec<int>& ids )
 {    int N = lines.size( );
-     vec<int> lens, ids( N, vec<int>::IDENTITY ), F(N), B(N);
+     vec<int> lens, F(N), B(N);
+     ids = vec<int>( N, vec<int>::IDENTITY );
      GetLineLengths( hb, lines, lens );
      for ( int i = 0; i < N; i++ )
      {    F[i] = lines[i].front( )[0][0], B[i] = lines[i].back( )[0][0];    }
      ParallelSort( ids, [&F,&B,&lens,&inv]( int i1, int i2 )
      {    return make_triple( -lens[i1], Min( F[i1], inv[ B[i1] ] ), F[i1] )
                < make_triple( -lens[i2], Min( F[i2], inv[ B[i2] ] ), F[i2] );
-                    }    );
+                    }    );    }
+
+void SortLines( vec<vec<vec<vec<int>>>>& lines, const HyperBasevector& hb,
+     const vec<int>& inv )
+{    int N = lines.size( );
+     vec<int> ids;
+     SortedLineOrder( lines, hb, inv, ids );
      vec<int> idsx(N);
      for ( int i = 0; i < N; i++ )
           idsx[ ids[i] ] = i;
@@ -163,6 +163,14 @@ void ComputeCoverage( const HyperBasevector& hb, const vec<int>& inv,
      const ReadPathVec& paths, const vec<vec<vec<vec<int>>>>& lines,
      const vec<int64_t>& subsam_starts, vec<vec<covcount>>& covs );
 
+// As above, given the paths index and the pairs touching each line in each
+// subsample, as LinePairStat counts them.
+
+void ComputeCoverage( const HyperBasevector& hb, const vec<int>& inv, 
+     const ReadPathVec& paths, const VecULongVec& paths_index,
+     const vec<vec<vec<vec<int>>>>& lines, const vec<int64_t>& subsam_starts,
+     const vec<vec<int>>& npairs, vec<vec<covcount>>& covs );
+
 void TestLineSymmetry( const vec<vec<vec<vec<int>>>>& lines, const vec<int>& inv );
 
 // Sort lines so that they are in reverse order by length, and each line is
@@ -171,6 +179,12 @@ void TestLineSymmetry( const vec<vec<vec<vec<int>>>>& lines, const vec<int>& inv
 void SortLines( vec<vec<vec<vec<int>>>>& lines, const HyperBasevector& hb,
      const vec<int>& inv );
 
+// SortedLineOrder: the order SortLines would put the lines in, without moving
+// them: lines[ ids[0] ] comes first, and so on.
+
+void SortedLineOrder( const vec<vec<vec<vec<int>>>>& lines,
+     const HyperBasevector& hb, const vec<int>& inv, vec<int>& ids );
+
 void DumpLineFiles( const vec<vec<vec<vec<int>>>>& lines, const HyperBasevector& hb,
      const vec<int>& inv, const ReadPathVec& paths, const String& dir );
 
@@ -0,0 +1,121 @@
+/*
+ * PathStats.cc
+ */
+
+#include "paths/long/large/PathStats.h"
+#include "VecUtilities.h"
+#include <algorithm>
+#include <memory>
+
+void ScanPairs( ReadPathVec const& paths, vec<PairStat*> const& stats )
+{
+    int64_t const nPaths = paths.size();
+    int64_t const nPairs = (nPaths+1)/2;
+    ReadPath const noMate;
+    #pragma omp parallel
+    {
+        std::vector<std::unique_ptr<PairStat>> mine;
+        for ( PairStat* stat : stats )
+            mine.emplace_back(stat->clone());
+
+        #pragma omp for schedule(dynamic,10000)
+        for ( int64_t pid = 0; pid < nPairs; ++pid )
+        {
+            ReadPath const& p1 = paths[2*pid];
+            ReadPath const& p2 = 2*pid+1 < nPaths ? paths[2*pid+1] : noMate;
+            for ( auto& stat : mine )
+                stat->add(pid,p1,p2);
+        }
+
+        #pragma omp critical
+        for ( size_t i = 0; i != stats.size(); ++i )
+            stats[i]->merge(*mine[i]);
+    }
+}
+
+void FragSizeStat::add( int64_t, ReadPath const& p1, ReadPath const& p2 )
+{
+    if ( p1.empty() || p2.empty() )
+        return;
+    int e = p1[0];
+    if ( e != mInv[p2[0]] )
+        return;
+    int len = mHB.EdgeLengthBases(e);
+    if ( len < MIN_EDGE )
+        return;
+    int sep = len - p2.getOffset() - p1.getOffset();
+    if ( sep >= 0 && sep < MAX_SEP )
+        mCount[sep/WIDTH] += 1;
+}
+
+void FragSizeStat::merge( PairStat const& that )
+{
+    vec<double> const& count = static_cast<FragSizeStat const&>(that).mCount;
+    for ( size_t i = 0; i != mCount.size(); ++i )
+        mCount[i] += count[i];
+}
+
+void LinePairStat::add( int64_t pid, ReadPath const& p1, ReadPath const& p2 )
+{
+    mLines.clear();
+    for ( int e : p1 )
+        mLines.push_back(mToL[e],mToL[mInv[e]]);
+    for ( int e : p2 )
+        mLines.push_back(mToL[e],mToL[mInv[e]]);
+    UniqueSort(mLines);
+
+    // the last subsample starting at or before the pair
+    int ss = std::upper_bound(mSubsamStarts.begin()+1,mSubsamStarts.end(),2*pid)
+                - mSubsamStarts.begin() - 1;
+    vec<int>& npairs = mNPairs[ss];
+    for ( int l : mLines )
+        if ( l >= 0 )
+            npairs[l] += 1;
+}
+
+void LinePairStat::merge( PairStat const& that )
+{
+    vec<vec<int>> const& npairs = static_cast<LinePairStat const&>(that).mNPairs;
+    for ( size_t ss = 0; ss != mNPairs.size(); ++ss )
+        for ( size_t l = 0; l != mNPairs[ss].size(); ++l )
+            mNPairs[ss][l] += npairs[ss][l];
+}
+
+vec<int> LinePairStat::total() const
+{
+    vec<int> result(mNPairs[0].size(),0);
+    for ( vec<int> const& npairs : mNPairs )
+        for ( size_t l = 0; l != npairs.size(); ++l )
+            result[l] += npairs[l];
+    return result;
+}
+
+void EdgeSupportStat::add( int64_t, ReadPath const& p1, ReadPath const& p2 )
+{
+    addRead(p1);
+    addRead(p2);
+}
+
+void EdgeSupportStat::addRead( ReadPath const& path )
+{
+    int* in = mpIn->data();
+    int* out = mpOut->data();
+    int last = int(path.size()) - 1;
+    for ( int j = 0; j <= last; ++j )
+    {
+        int e = path[j];
+        int re = mInv[e];
+        if ( j > 0 )
+        {
+            __atomic_fetch_add(in+e,1,__ATOMIC_RELAXED);
+            if ( re >= 0 )
+                __atomic_fetch_add(out+re,1,__ATOMIC_RELAXED);
+        }
+        if ( j < last )
+        {
+            __atomic_fetch_add(out+e,1,__ATOMIC_RELAXED);
+            if ( re >= 0 )
+                __atomic_fetch_add(in+re,1,__ATOMIC_RELAXED);
+        }
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * PathStats.h
+ *
+ * Statistics over the read paths, gathered in one parallel pass.
+ */
+
+#ifndef PATHS_LONG_LARGE_PATHSTATS_H_
+#define PATHS_LONG_LARGE_PATHSTATS_H_
+
+#include "Vec.h"
+#include "paths/HyperBasevector.h"
+#include "paths/long/ReadPath.h"
+
+// Something computed from every read pair.  ScanPairs gives each thread an
+// empty copy from clone(), feeds the copies the pairs, and merges them back
+// into the original, so add() needs no locking.
+class PairStat
+{
+public:
+    virtual ~PairStat() {}
+
+    virtual PairStat* clone() const = 0;
+    virtual void add( int64_t pid, ReadPath const& p1, ReadPath const& p2 ) = 0;
+    virtual void merge( PairStat const& that ) = 0;
+};
+
+// Feed each pair of paths, 2*pid and 2*pid+1, to every one of the stats, in a
+// single pass.  An odd last path is fed with an empty mate.
+void ScanPairs( ReadPathVec const& paths, vec<PairStat*> const& stats );
+
+// The fragment size histogram of FragDist: the distance between the reads of
+// a pair that land on the same long edge, in 10-base bins below 1000.
+class FragSizeStat : public PairStat
+{
+public:
+    static int const WIDTH = 10;
+    static int const MAX_SEP = 1000;
+    static int const MIN_EDGE = 10000;
+
+    FragSizeStat( HyperBasevector const& hb, vec<int> const& inv )
+    : mHB(hb), mInv(inv), mCount(MAX_SEP/WIDTH,0.) {}
+
+    PairStat* clone() const override { return new FragSizeStat(mHB,mInv); }
+    void add( int64_t pid, ReadPath const& p1, ReadPath const& p2 ) override;
+    void merge( PairStat const& that ) override;
+
+    vec<double> const& counts() const { return mCount; }
+
+private:
+    HyperBasevector const& mHB;
+    vec<int> const& mInv;
+    vec<double> mCount;
+};
+
+// The number of pairs touching each line, for each subsample, as
+// ComputeCoverage counts them: a pair counts once for a line, however many of
+// its edges or their involutes lie on it.  tol maps edges to lines (GetTol).
+class LinePairStat : public PairStat
+{
+public:
+    LinePairStat( vec<int> const& inv, vec<int> const& tol, int nLines,
+                  vec<int64_t> const& subsam_starts )
+    : mInv(inv), mToL(tol), mSubsamStarts(subsam_starts),
+      mNPairs(subsam_starts.size(),vec<int>(nLines,0)) {}
+
+    PairStat* clone() const override
+    { return new LinePairStat(mInv,mToL,mNPairs[0].size(),mSubsamStarts); }
+    void add( int64_t pid, ReadPath const& p1, ReadPath const& p2 ) override;
+    void merge( PairStat const& that ) override;
+
+    // indexed by subsample, then line
+    vec<vec<int>> const& npairs() const { return mNPairs; }
+
+    // summed over the subsamples, as GetLineNpairs counts them
+    vec<int> total() const;
+
+private:
+    vec<int> const& mInv;
+    vec<int> const& mToL;
+    vec<int64_t> mSubsamStarts;
+    vec<vec<int>> mNPairs;
+    vec<int> mLines;
+};
+
+// For each edge, the number of reads that go on from it (out), and that come
+// into it (in), with a read through the involute of an edge counted as going
+// the other way.  These are per read, not per pair.  Two counts per edge for
+// every thread would cost more than they save, so the copies share the
+// original's counts and add to them atomically.
+class EdgeSupportStat : public PairStat
+{
+public:
+    explicit EdgeSupportStat( vec<int> const& inv )
+    : mInv(inv), mIn(inv.size(),0), mOut(inv.size(),0),
+      mpIn(&mIn), mpOut(&mOut) {}
+
+    PairStat* clone() const override { return new EdgeSupportStat(*this,0); }
+    void add( int64_t pid, ReadPath const& p1, ReadPath const& p2 ) override;
+    void merge( PairStat const& ) override {}
+
+    vec<int> const& in() const { return mIn; }
+    vec<int> const& out() const { return mOut; }
+
+private:
+    EdgeSupportStat( EdgeSupportStat const& that, int )
+    : mInv(that.mInv), mpIn(that.mpIn), mpOut(that.mpOut) {}
+
+    void addRead( ReadPath const& path );
+
+    vec<int> const& mInv;
+    vec<int> mIn, mOut;
+    vec<int>* mpIn;
+    vec<int>* mpOut;
+};
+
+#endif /* PATHS_LONG_LARGE_PATHSTATS_H_ */
@@ -18,7 +18,68 @@
 #include "paths/long/LongReadsToPaths.h"
 #include "paths/long/LongProtoTools.h"
 #include "paths/long/ReadPath.h"
+#include "system/MemoryGovernor.h"
 #include "system/SortInPlace.h"
+#include <fstream>
+#include <queue>
+
+namespace
+{
+
+// approximate heap footprint of a set of places
+size_t PlacesBytes( const std::vector< std::vector<int> >& places )
+{    size_t bytes = places.capacity( ) * sizeof( std::vector<int> );
+     for ( const auto& p : places ) bytes += 16 + p.capacity( ) * sizeof(int);
+     return bytes;    }
+
+// One spilled run, read back a place at a time.
+class PlaceRun
+{
+public:
+     explicit PlaceRun( const String& fn )
+          : in_( fn.c_str( ), std::ios::in | std::ios::binary ) { Next( ); }
+     bool Done( ) const { return done_; }
+     const std::vector<int>& Head( ) const { return head_; }
+     void Next( )
+     {    uint32_t n;
+          done_ = !in_.read( (char*) &n, sizeof(n) );
+          if (done_) return;
+          head_.resize(n);
+          in_.read( (char*) head_.data( ), n * sizeof(int) );    }
+
+private:
+     std::ifstream in_;
+     std::vector<int> head_;
+     bool done_;
+};
+
+} // end of anonymous namespace
+
+void SpillPlaces( std::vector< std::vector<int> >& places, const String& fn )
+{    std::ofstream out( fn.c_str( ), std::ios::out | std::ios::trunc | std::ios::binary );
+     for ( const auto& p : places )
+     {    uint32_t n = p.size( );
+          out.write( (const char*) &n, sizeof(n) );
+          out.write( (const char*) p.data( ), n * sizeof(int) );    }
+     if ( !out ) FatalErr( "Failed to spill places to " + fn );
+     std::vector< std::vector<int> >( ).swap(places);    }
+
+void MergePlaceRuns( const vec<String>& runs,
+     std::vector< std::vector<int> >& places )
+{    std::vector< std::unique_ptr<PlaceRun> > in;
+     for ( const auto& fn : runs ) in.emplace_back( new PlaceRun(fn) );
+     auto later = [&in]( int r1, int r2 ) { return in[r2]->Head( ) < in[r1]->Head( ); };
+     std::priority_queue< int, std::vector<int>, decltype(later) > heap(later);
+     for ( int r = 0; r < (int) in.size( ); r++ )
+          if ( !in[r]->Done( ) ) heap.push(r);
+     while ( !heap.empty( ) )
+     {    int r = heap.top( );
+          heap.pop( );
+          if ( places.empty( ) || places.back( ) != in[r]->Head( ) )
+               places.push_back( in[r]->Head( ) );
+          in[r]->Next( );
+          if ( !in[r]->Done( ) ) heap.push(r);    }
+     for ( const auto& fn : runs ) Remove(fn);    }
 
 void RepathInMemory( const HyperBasevector& hb, const vecbasevector& edges,
              const vec<int>& inv, ReadPathVec& paths, const int K, const int K2,
@@ -40,33 +101,59 @@ void RepathInMemory( const HyperBasevector& hb, const vecbasevector& edges,
      }
      std::cout << Date() << ": " <<pathed<<" / "<<paths.size()<<" reads pathed, "<< multipathed << " spanning junctions"<< std::endl;
      std::vector< std::vector<int> > places;
-     places.reserve( paths.size( ) );
 
+     // Places are built in rounds.  If they outgrow half of the memory that
+     // was free at the start, they're compacted, and if that isn't enough,
+     // spilled to disk as sorted runs that are merged at the end.  This bounds
+     // the duplicate places held along the way; the unique places themselves
+     // are all needed below (for the extensions and for BinPosition), so the
+     // merge still produces them in memory.
+
+     const size_t allowance = MemoryGovernor::planningBudget( ) / 2;
+     const int64_t round = MemoryGovernor::batchSize( 256, 1000000, 50000000 );
+     vec<String> runs;
      const int batch = 10000;
-     #pragma omp parallel for
-     for (int64_t m = 0; m < (int64_t) paths.size(); m += batch) {
-          std::vector<std::vector<int> > placesm;
-          placesm.reserve(batch);
-          std::vector<int> x, y;
-          int64_t n = Min(m + batch, (int64_t) paths.size());
-          for (int64_t i = m; i < n; i++) {
-               x.clear(), y.clear();
-               for (int64_t j = 0; j < (int64_t) paths[i].size(); j++)
-                    x.push_back(paths[i][j]);
-               int nkmers = 0;
-               for (int j = 0; j < x.size(); j++)
-                    nkmers += edges[x[j]].size() - ((int) K - 1);
-               if (nkmers + ((int) K - 1) < K2) continue;
-               for (int j = x.size() - 1; j >= 0; j--)
-                    y.push_back(inv[x[j]]);
-               placesm.push_back(x < y ? x : y);
+     for ( int64_t r = 0; r < (int64_t) paths.size( ); r += round ) {
+          const int64_t rstop = Min( r + round, (int64_t) paths.size( ) );
+          #pragma omp parallel for
+          for (int64_t m = r; m < rstop; m += batch) {
+               std::vector<std::vector<int> > placesm;
+               placesm.reserve(batch);
+               std::vector<int> x, y;
+               int64_t n = Min(m + batch, rstop);
+               for (int64_t i = m; i < n; i++) {
+                    x.clear(), y.clear();
+                    for (int64_t j = 0; j < (int64_t) paths[i].size(); j++)
+                         x.push_back(paths[i][j]);
+                    int nkmers = 0;
+                    for (int j = 0; j < x.size(); j++)
+                         nkmers += edges[x[j]].size() - ((int) K - 1);
+                    if (nkmers + ((int) K - 1) < K2) continue;
+                    for (int j = x.size() - 1; j >= 0; j--)
+                         y.push_back(inv[x[j]]);
+                    placesm.push_back(x < y ? x : y);
+               }
+               #pragma omp critical
+               { places.insert(places.end(),placesm.begin(),placesm.end()); }
           }
-          #pragma omp critical
-          { places.insert(places.end(),placesm.begin(),placesm.end()); }
+          if ( rstop < (int64_t) paths.size( ) && PlacesBytes(places) > allowance )
+          {    sortInPlaceParallel(places.begin(), places.end());
+               places.erase(std::unique(places.begin(),places.end()),places.end());
+               if ( PlacesBytes(places) > allowance / 2 )
+               {    runs.push_back( MemoryGovernor::spillFile( "places" ) );
+                    std::cout << Date() << ": spilling " << places.size( )
+                         << " places to " << runs.back( ) << std::endl;
+                    SpillPlaces( places, runs.back( ) );    }    }
      }
      std::cout << Date() << ": sorting "<<places.size()<<" places" << std::endl;
      sortInPlaceParallel(places.begin(), places.end());
      places.erase(std::unique(places.begin(),places.end()),places.end());
+     if ( runs.nonempty( ) )
+     {    runs.push_back( MemoryGovernor::spillFile( "places" ) );
+          SpillPlaces( places, runs.back( ) );
+          std::cout << Date() << ": merging " << runs.size( ) << " runs of places"
+               << std::endl;
+          MergePlaceRuns( runs, places );    }
      places.shrink_to_fit();
      std::cout << Date() << ": "<<places.size()<<" unique places" << std::endl;
      // Add extended places.
@@ -20,4 +20,14 @@ void RepathInMemory( const HyperBasevector& hb, const vecbasevector& edges,
                 HyperBasevector& hb2, ReadPathVec& paths2 , const Bool REPATH_TRANSLATE, bool INVERT_PATHS,
                 const Bool EXTEND_PATHS );
 
+// Write sorted places to a run file, and free them.
+
+void SpillPlaces( std::vector< std::vector<int> >& places, const String& fn );
+
+// Merge sorted runs into unique sorted places, appending them to places and
+// deleting the run files.
+
+void MergePlaceRuns( const vec<String>& runs,
+     std::vector< std::vector<int> >& places );
+
 #endif
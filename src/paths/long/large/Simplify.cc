@@ -16,6 +16,7 @@
 #include "paths/long/ReadPath.h"
 #include "paths/long/large/GapToyTools.h"
 #include "paths/long/large/ImprovePath.h"
+#include "paths/long/large/PathStats.h"
 #include "paths/long/large/PullAparter.h"
 #include "paths/long/large/Simplify.h"
 
@@ -41,50 +42,28 @@ void Simplify(const String &fin_dir, HyperBasevector &hb, vec<int> &inv,
     {
         const int min_mult = 10;
         vec<int> dels;
-        {
-            vec<int> support(hb.EdgeObjectCount(), 0);
-            for (int64_t id = 0; id < (int64_t) paths.size(); id++) {
-                for (int64_t j = 0; j < (int64_t) paths[id].size(); j++) {
-                    int e = paths[id][j];
-                    if (j >= 1) support[e]++;
-                    if (inv[e] >= 0 && j < (int64_t) paths[id].size() - 1)
-                        support[inv[e]]++;
-                }
-            }
+        EdgeSupportStat support(inv);
+        ScanPairs(paths, {&support});
 #pragma omp parallel for
-            for (int v = 0; v < hb.N(); v++) {
-                if (hb.From(v).size() == 2) {
-                    int e1 = hb.EdgeObjectIndexByIndexFrom(v, 0);
-                    int e2 = hb.EdgeObjectIndexByIndexFrom(v, 1);
-                    if (support[e1] > support[e2]) std::swap(e1, e2);
-                    int s1 = support[e1], s2 = support[e2];
-                    if (s1 <= MAX_SUPP_DEL && s2 >= min_mult * Max(1, s1)) {
+        for (int v = 0; v < hb.N(); v++) {
+            if (hb.From(v).size() == 2) {
+                int e1 = hb.EdgeObjectIndexByIndexFrom(v, 0);
+                int e2 = hb.EdgeObjectIndexByIndexFrom(v, 1);
+                if (support.in()[e1] > support.in()[e2]) std::swap(e1, e2);
+                int s1 = support.in()[e1], s2 = support.in()[e2];
+                if (s1 <= MAX_SUPP_DEL && s2 >= min_mult * Max(1, s1)) {
 #pragma omp critical
-                        { dels.push_back(e1); }
-                    }
-                }
-            }
-        }
-        {
-            vec<int> support(hb.EdgeObjectCount(), 0);
-            for (int64_t id = 0; id < (int64_t) paths.size(); id++) {
-                for (int64_t j = 0; j < (int64_t) paths[id].size(); j++) {
-                    int e = paths[id][j];
-                    if (j < (int64_t) paths[id].size() - 1) support[e]++;
-                    if (inv[e] >= 0 && j >= 1) support[inv[e]]++;
+                    { dels.push_back(e1); }
                 }
             }
-#pragma omp parallel for
-            for (int v = 0; v < hb.N(); v++) {
-                if (hb.To(v).size() == 2) {
-                    int e1 = hb.EdgeObjectIndexByIndexTo(v, 0);
-                    int e2 = hb.EdgeObjectIndexByIndexTo(v, 1);
-                    if (support[e1] > support[e2]) std::swap(e1, e2);
-                    int s1 = support[e1], s2 = support[e2];
-                    if (s1 <= MAX_SUPP_DEL && s2 >= min_mult * Max(1, s1)) {
+            if (hb.To(v).size() == 2) {
+                int e1 = hb.EdgeObjectIndexByIndexTo(v, 0);
+                int e2 = hb.EdgeObjectIndexByIndexTo(v, 1);
+                if (support.out()[e1] > support.out()[e2]) std::swap(e1, e2);
+                int s1 = support.out()[e1], s2 = support.out()[e2];
+                if (s1 <= MAX_SUPP_DEL && s2 >= min_mult * Max(1, s1)) {
 #pragma omp critical
-                        { dels.push_back(e1); }
-                    }
+                    { dels.push_back(e1); }
                 }
             }
         }
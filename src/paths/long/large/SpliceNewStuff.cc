@@ -0,0 +1,452 @@
+/*
+ * SpliceNewStuff.cc
+ *
+ * Rebuilding the whole graph from its edges, its vertex crossings and the gap
+ * patches only changes the graph where a patch shares a kmer with it.  The
+ * kmers of the graph are unique, and an edge ends where its last kmer has
+ * other successors, or its successor other predecessors.  A patch adds kmers
+ * and adjacencies, so it can only split or join the edges it shares kmers
+ * with, and attach to the vertices whose (K-1)-mers it contains.  Everything
+ * else comes back unchanged.  So we rebuild the touched edges, with the
+ * patches and the crossings of the vertices they might change, and splice the
+ * result in.
+ */
+
+#include "paths/long/large/SpliceNewStuff.h"
+#include "kmers/BigKPather.h"
+#include "kmers/KMerHasher.h"
+#include "paths/long/LargeKDispatcher.h"
+#include "paths/long/large/GapToyTools.h"
+#include "system/System.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace
+{
+
+template <int K, class Itr1, class Itr2>
+bool sameKmer( Itr1 itr1, Itr2 itr2, bool eitherStrand )
+{
+    if ( std::equal(itr1,itr1+K,itr2) )
+        return true;
+    if ( !eitherStrand )
+        return false;
+    for ( int i = 0; i != K; ++i )
+        if ( itr1[i] != (3^itr2[K-1-i]) )
+            return false;
+    return true;
+}
+
+// A sorted list of the kmers at given places in some sequences, each with an
+// id.  The hash is strand-symmetric, so the same list finds kmers on either
+// strand, if asked to.  A bitmap of hashes throws out most misses cheaply,
+// since most lookups are misses.
+template <int K>
+class KmerIndex
+{
+public:
+    explicit KmerIndex( bool eitherStrand ) : mEitherStrand(eitherStrand) {}
+
+    void add( bvec const& seq, int id )
+    { if ( seq.size() < unsigned(K) ) return;
+      KMerHasher<K> hasher;
+      auto itr = seq.begin();
+      mEntries.push_back(Entry{hasher.hash(itr),&seq,0u,id});
+      for ( unsigned pos = 1, end = seq.size()-K+1; pos != end; ++pos )
+          mEntries.push_back(Entry{hasher.stepF(++itr),&seq,pos,id}); }
+
+    void addOne( bvec const& seq, unsigned pos, int id )
+    { mEntries.push_back(Entry{KMerHasher<K>()(seq.begin(pos)),&seq,pos,id}); }
+
+    void finish()
+    { std::sort(mEntries.begin(),mEntries.end(),
+              []( Entry const& e1, Entry const& e2 )
+              { return e1.hash < e2.hash; });
+      size_t nBits = 64;
+      while ( nBits < 8*mEntries.size() )
+          nBits *= 2;
+      mMask = nBits-1;
+      mFilter.assign(nBits/64,0);
+      for ( Entry const& entry : mEntries )
+      { size_t bit = entry.hash & mMask;
+        mFilter[bit/64] |= 1ul << bit%64; } }
+
+    // the id of the kmer at itr, which has the given hash, or -1
+    template <class Itr>
+    int find( Itr itr, size_t hash ) const
+    { size_t bit = hash & mMask;
+      if ( !(mFilter[bit/64] & (1ul << bit%64)) )
+          return -1;
+      auto end = mEntries.end();
+      auto pos = std::lower_bound(mEntries.begin(),end,hash,
+                        []( Entry const& entry, size_t hash )
+                        { return entry.hash < hash; });
+      for ( ; pos != end && pos->hash == hash; ++pos )
+          if ( sameKmer<K>(itr,pos->seq->begin(pos->pos),mEitherStrand) )
+              return pos->id;
+      return -1; }
+
+    // the number of kmers of seq in the index
+    int count( bvec const& seq ) const
+    { if ( seq.size() < unsigned(K) ) return 0;
+      KMerHasher<K> hasher;
+      auto itr = seq.begin();
+      int result = find(itr,hasher.hash(itr)) >= 0;
+      for ( auto end = seq.end()-K+1; ++itr != end; )
+          result += find(itr,hasher.stepF(itr)) >= 0;
+      return result; }
+
+    bool any( bvec const& seq ) const
+    { if ( seq.size() < unsigned(K) ) return false;
+      KMerHasher<K> hasher;
+      auto itr = seq.begin();
+      if ( find(itr,hasher.hash(itr)) >= 0 ) return true;
+      for ( auto end = seq.end()-K+1; ++itr != end; )
+          if ( find(itr,hasher.stepF(itr)) >= 0 ) return true;
+      return false; }
+
+private:
+    struct Entry
+    {
+        size_t hash;
+        bvec const* seq;
+        unsigned pos;
+        int id;
+    };
+
+    std::vector<Entry> mEntries;
+    std::vector<uint64_t> mFilter;
+    size_t mMask = 0;
+    bool mEitherStrand;
+};
+
+// Whether seq contains a palindromic K-mer (or, for odd K, a palindromic
+// K-1-mer).  The edge builder breaks edges at those, so the rebuild could cut
+// an untouched edge that contains one.
+template <int K>
+bool hasPalindrome( bvec const& seq )
+{
+    int const H = K/2;
+    int const len = seq.size();
+    for ( int c = H; c + H <= len; ++c )
+    {
+        int m = 0;
+        while ( m < H && seq[c-1-m] == (3^seq[c+m]) )
+            ++m;
+        if ( m == H )
+            return true;
+    }
+    return false;
+}
+
+// Where the K-1-mer of vertex v starts.
+void vertexKmer( HyperBasevector const& hb, int v, bvec const** pSeq,
+                    unsigned* pPos )
+{
+    if ( hb.From(v).nonempty() )
+    {
+        *pSeq = &hb.EdgeObject(hb.IFrom(v,0));
+        *pPos = 0;
+        return;
+    }
+    *pSeq = &hb.EdgeObject(hb.ITo(v,0));
+    *pPos = (*pSeq)->size() - (hb.K()-1);
+}
+
+template <int K>
+bool splice( vecbvec const& new_stuff, HyperBasevector& hb, ReadPathVec& paths,
+                vecbvec const& bases, vec<Bool>& remapped )
+{
+    int const nEdges = hb.EdgeObjectCount();
+    vec<Bool> used;
+    hb.Used(used);
+    if ( std::count(used.begin(),used.end(),True) != nEdges )
+        return false;
+
+    // The rebuild joins the edges through a vertex with one edge in and one
+    // out, so there mustn't be any.
+
+    for ( int v = 0; v < hb.N(); ++v )
+        if ( hb.To(v).size() == 1 && hb.From(v).size() == 1
+                && hb.ITo(v,0) != hb.IFrom(v,0) )
+            return false;
+
+    // Find the edges that share a kmer with a patch.
+
+    KmerIndex<K> patchKmers(true);
+    KmerIndex<K-1> patchVerts(true);
+    for ( size_t i = 0; i != new_stuff.size(); ++i )
+    {
+        patchKmers.add(new_stuff[i],i);
+        patchVerts.add(new_stuff[i],i);
+    }
+    patchKmers.finish();
+    patchVerts.finish();
+
+    vec<Bool> touched(nEdges,False);
+    std::atomic<bool> palindrome(false);
+    #pragma omp parallel for schedule(dynamic,1000)
+    for ( int e = 0; e < nEdges; ++e )
+    {
+        bvec const& edge = hb.EdgeObject(e);
+        if ( hasPalindrome<K>(edge) )
+            palindrome = true;
+        if ( patchKmers.any(edge) )
+            touched[e] = True;
+    }
+    vec<int> tEdges;
+    for ( int e = 0; e < nEdges; ++e )
+        if ( touched[e] )
+            tEdges.push_back(e);
+    if ( palindrome || 2*tEdges.size() > size_t(nEdges) )
+        return false;
+
+    // The vertices that might change: those of the touched edges, and those
+    // whose K-1-mer a patch contains.  A vertex is known by its K-1-mer, so
+    // those must be distinct.
+
+    vec<int> to_left, to_right;
+    hb.ToLeft(to_left), hb.ToRight(to_right);
+    vec<Bool> changed(hb.N(),False);
+    for ( int e : tEdges )
+        changed[to_left[e]] = changed[to_right[e]] = True;
+    #pragma omp parallel for schedule(dynamic,1000)
+    for ( int v = 0; v < hb.N(); ++v )
+    {
+        if ( changed[v] || (hb.To(v).empty() && hb.From(v).empty()) )
+            continue;
+        bvec const* seq; unsigned pos;
+        vertexKmer(hb,v,&seq,&pos);
+        auto itr = seq->begin(pos);
+        if ( patchVerts.find(itr,KMerHasher<K-1>()(itr)) >= 0 )
+            changed[v] = True;
+    }
+    vec<int> cVerts;
+    KmerIndex<K-1> vertexIndex(false);
+    for ( int v = 0; v < hb.N(); ++v )
+    {
+        if ( !changed[v] ) continue;
+        bvec const* seq; unsigned pos;
+        vertexKmer(hb,v,&seq,&pos);
+        vertexIndex.addOne(*seq,pos,v);
+        cVerts.push_back(v);
+    }
+    vertexIndex.finish();
+    for ( int v : cVerts )
+    {
+        bvec const* seq; unsigned pos;
+        vertexKmer(hb,v,&seq,&pos);
+        auto itr = seq->begin(pos);
+        if ( vertexIndex.find(itr,KMerHasher<K-1>()(itr)) != v )
+            return false;
+    }
+
+    // Rebuild the touched edges, with the patches and the crossings of the
+    // changed vertices.  The crossings bring in the end kmers of the untouched
+    // edges there, the ghosts.  Those stay as they are, so we drop the edges
+    // made of ghosts, and give up if an edge mixes them with other kmers.
+
+    KmerIndex<K> ghosts(true);
+    size_t nCrossings = 0;
+    for ( int v : cVerts )
+    {
+        for ( int j = 0; j < hb.To(v).isize(); ++j )
+        {
+            int e = hb.ITo(v,j);
+            bvec const& edge = hb.EdgeObject(e);
+            if ( !touched[e] ) ghosts.addOne(edge,edge.size()-K,e);
+        }
+        for ( int j = 0; j < hb.From(v).isize(); ++j )
+        {
+            int e = hb.IFrom(v,j);
+            if ( !touched[e] ) ghosts.addOne(hb.EdgeObject(e),0,e);
+        }
+        nCrossings += hb.To(v).size()*hb.From(v).size();
+    }
+    ghosts.finish();
+
+    vecbvec local;
+    local.reserve(tEdges.size()+new_stuff.size()+nCrossings);
+    for ( int e : tEdges )
+        local.push_back(hb.EdgeObject(e));
+    local.append(new_stuff.begin(),new_stuff.end());
+    bvec tmp(K+1);
+    for ( int v : cVerts )
+    for ( int i1 = 0; i1 < hb.To(v).isize(); ++i1 )
+    for ( int i2 = 0; i2 < hb.From(v).isize(); ++i2 )
+    {
+        bvec const& x1 = hb.EdgeObject(hb.ITo(v,i1));
+        bvec const& x2 = hb.EdgeObject(hb.IFrom(v,i2));
+        tmp.assign(x1.end()-K,x1.end()).push_back(x2[K-1]);
+        local.push_back(tmp);
+    }
+
+    HyperBasevector hbL;
+    ReadPathVec localPaths;
+    buildBigKHBVFromReads(K,local,4,&hbL,&localPaths);
+
+    int const nL = hbL.EdgeObjectCount();
+    vec<Bool> isNew(nL,False);
+    std::atomic<bool> mixed(false);
+    #pragma omp parallel for schedule(dynamic,100)
+    for ( int l = 0; l < nL; ++l )
+    {
+        bvec const& edge = hbL.EdgeObject(l);
+        int nGhosts = ghosts.count(edge);
+        if ( nGhosts == 0 )
+            isNew[l] = True;
+        else if ( nGhosts != int(edge.size()-K+1) )
+            mixed = true;
+    }
+    if ( mixed )
+        return false;
+    for ( size_t i = 0; i != tEdges.size(); ++i )
+    {
+        if ( localPaths[i].empty() )
+            return false;
+        for ( int l : localPaths[i] )
+            if ( !isNew[l] )
+                return false;
+    }
+
+    // Give each vertex of a new edge the old vertex with its K-1-mer, or a new
+    // one.
+
+    vec<int> to_leftL, to_rightL;
+    hbL.ToLeft(to_leftL), hbL.ToRight(to_rightL);
+    vec<int> vmap(hbL.N(),-1);
+    int nNewVerts = 0;
+    for ( int l = 0; l < nL; ++l )
+    {
+        if ( !isNew[l] ) continue;
+        for ( int u : {to_leftL[l],to_rightL[l]} )
+        {
+            if ( vmap[u] >= 0 ) continue;
+            bvec const* seq; unsigned pos;
+            vertexKmer(hbL,u,&seq,&pos);
+            auto itr = seq->begin(pos);
+            vmap[u] = vertexIndex.find(itr,KMerHasher<K-1>()(itr));
+            if ( vmap[u] < 0 )
+                vmap[u] = hb.N() + nNewVerts++;
+        }
+    }
+
+    // Flag the paths that the rebuild would change: those through a touched
+    // edge, and those whose read, cut back to its first edge, could be
+    // extended into a changed vertex.  For the latter we want the distance in
+    // kmers from each vertex to the nearest changed one, up to a read length.
+
+    int maxReadLen = 0;
+    for ( auto const& read : bases )
+        maxReadLen = std::max(maxReadLen,int(read.size()));
+    vec<int> dist(hb.N(),INT_MAX);
+    typedef std::pair<int,int> dist_vert;
+    std::priority_queue<dist_vert,std::vector<dist_vert>,
+                        std::greater<dist_vert>> todo;
+    for ( int v : cVerts )
+    {
+        dist[v] = 0;
+        todo.push(dist_vert(0,v));
+    }
+    while ( !todo.empty() )
+    {
+        int d = todo.top().first, w = todo.top().second;
+        todo.pop();
+        if ( d > dist[w] ) continue;
+        for ( int j = 0; j < hb.To(w).isize(); ++j )
+        {
+            int u = hb.To(w)[j];
+            int du = d + hb.EdgeLengthKmers(hb.ITo(w,j));
+            if ( du < maxReadLen && du < dist[u] )
+            {
+                dist[u] = du;
+                todo.push(dist_vert(du,u));
+            }
+        }
+    }
+
+    remapped.assign(paths.size(),False);
+    #pragma omp parallel for schedule(dynamic,10000)
+    for ( int64_t i = 0; i < int64_t(paths.size()); ++i )
+    {
+        ReadPath const& p = paths[i];
+        if ( p.empty() ) continue;
+        for ( int e : p )
+            if ( touched[e] )
+            {
+                remapped[i] = True;
+                break;
+            }
+        if ( remapped[i] || p.getOffset() < 0 ) continue;
+        int ext = bases[i].isize() - (hb.EdgeLengthBases(p[0])-p.getOffset());
+        if ( ext > 0 && dist[to_right[p[0]]] < ext )
+            remapped[i] = True;
+    }
+
+    // Splice the new edges in.
+
+    hb.AddVertices(nNewVerts);
+    hb.DeleteEdges(tEdges,to_left);
+    vec<int> added(nL,-1);
+    for ( int l = 0; l < nL; ++l )
+        if ( isNew[l] )
+            added[l] = hb.AddEdge(vmap[to_leftL[l]],vmap[to_rightL[l]],
+                                    hbL.EdgeObject(l));
+    vec<int> trans = hb.RemoveDeadEdgeObjects();
+    hb.RemoveEdgelessVertices();
+
+    // Translate the flagged paths as the rebuild would, and renumber the rest.
+
+    vec<vec<int>> to3(nEdges);
+    vec<int> left3(nEdges,0);
+    for ( int e = 0; e < nEdges; ++e )
+        if ( !touched[e] )
+            to3[e].push_back(trans[e]);
+    for ( size_t i = 0; i != tEdges.size(); ++i )
+    {
+        int e = tEdges[i];
+        for ( int l : localPaths[i] )
+            to3[e].push_back(trans[added[l]]);
+        left3[e] = localPaths[i].getFirstSkip();
+    }
+    #pragma omp parallel for schedule(dynamic,10000)
+    for ( int64_t i = 0; i < int64_t(paths.size()); ++i )
+    {
+        if ( remapped[i] )
+            TranslatePath(paths[i],hb,to3,left3);
+        else
+            for ( int& e : paths[i] )
+                e = trans[e];
+    }
+
+    std::cout << Date() << ": spliced " << tEdges.size() << " of " << nEdges
+              << " edges and " << cVerts.size() << " vertices, remapping "
+              << std::count(remapped.begin(),remapped.end(),True)
+              << " paths" << std::endl;
+    return true;
+}
+
+template <int K>
+struct SpliceFunctor
+{
+    void operator()( vecbvec const& new_stuff, HyperBasevector& hb,
+                        ReadPathVec& paths, vecbvec const& bases,
+                        vec<Bool>& remapped, bool& result )
+    { result = splice<K>(new_stuff,hb,paths,bases,remapped); }
+};
+
+}
+
+bool SpliceNewStuff( vecbvec const& new_stuff, HyperBasevector& hb,
+                     ReadPathVec& paths, vecbvec const& bases,
+                     vec<Bool>& remapped )
+{
+    bool result = false;
+    BigK::dispatch<SpliceFunctor>(hb.K(),new_stuff,hb,paths,bases,remapped,
+                                    result);
+    return result;
+}
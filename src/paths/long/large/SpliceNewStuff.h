@@ -0,0 +1,34 @@
+/*
+ * SpliceNewStuff.h
+ *
+ * Adds gap patches to the large-K graph by rebuilding only the part of the
+ * graph that the patches touch.
+ */
+
+#ifndef PATHS_LONG_LARGE_SPLICENEWSTUFF_H_
+#define PATHS_LONG_LARGE_SPLICENEWSTUFF_H_
+
+#include "Basevector.h"
+#include "paths/HyperBasevector.h"
+#include "paths/long/ReadPath.h"
+
+// Gives the graph that AddNewStuff's rebuild from all the edges, the K+1-mers
+// across every vertex, and new_stuff would give.  Only the edges that share a
+// kmer with new_stuff are rebuilt, together with the patches, and spliced back
+// in place of the old ones.  The other edges keep their sequence and relative
+// order.
+//
+// Edge ids are compacted, so every path is renumbered.  A path is remapped if
+// it uses a rebuilt edge, or if its read reaches a rebuilt part of the graph
+// from its first edge.  A remapped path is translated as TranslatePaths does,
+// which cuts it back to one edge, and flagged in remapped, to be extended
+// again.  Other paths are kept as they are.
+//
+// Returns false, changing nothing, if the splice might not give the rebuilt
+// graph, or if the patches touch so much of the graph that the rebuild is as
+// cheap.
+bool SpliceNewStuff( vecbvec const& new_stuff, HyperBasevector& hb,
+                     ReadPathVec& paths, vecbvec const& bases,
+                     vec<Bool>& remapped );
+
+#endif /* PATHS_LONG_LARGE_SPLICENEWSTUFF_H_ */
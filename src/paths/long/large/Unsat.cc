@@ -11,8 +11,8 @@
 // MakeDepend: library OMP
 // MakeDepend: cflags OMP_FLAGS
 
+#include "ConcurrentUnionFind.h"
 #include "CoreTools.h"
-#include "Equiv.h"
 //#include "ParallelVecUtilities.h"
 #include "ParseSet.h"
 #include "VecUtilities.h"
@@ -26,18 +26,18 @@ vec<int> Nhood( const HyperBasevector& hb, const vec<int>& to_left,
      const vec<int>& to_right, const int e, const int radius )
 {    vec<int> x = {e};
      for ( int r = 0; r < radius; r++ )
-     {    vec<int> x2 = x;
-          for ( int l = 0; l < x.isize( ); l++ )
+     {    int nx = x.size( );
+          for ( int l = 0; l < nx; l++ )
           {    int w = to_right[ x[l] ];
                for ( int j = 0; j < hb.From(w).isize( ); j++ )
-                    x2.push_back( hb.IFrom( w, j ) );    }
-          x = x2;
-          for ( int l = 0; l < x.isize( ); l++ )
+                    x.push_back( hb.IFrom( w, j ) );    }
+          UniqueSort(x);
+          nx = x.size( );
+          for ( int l = 0; l < nx; l++ )
           {    int w = to_left[ x[l] ];
                for ( int j = 0; j < hb.To(w).isize( ); j++ )
-                    x2.push_back( hb.ITo( w, j ) );    }
-          x = x2;    }
-     UniqueSort(x);
+                    x.push_back( hb.ITo( w, j ) );    }
+          UniqueSort(x);    }
      return x;    }
 
 void MergeClusters( const vec< vec< std::pair<int,int> > >& x,
@@ -50,57 +50,53 @@ void MergeClusters( const vec< vec< std::pair<int,int> > >& x,
      #pragma omp parallel for
      for ( int i = 0; i < N; i++ )
      {    UniqueSort( ind1[i] ), UniqueSort( ind2[i] );    }
-     equiv_rel e( x.size( ) );
-     #pragma omp parallel
-     {
-         std::vector<std::vector<int>> tt1;
-         #pragma omp for nowait
-         for ( int i = 0; i < x.isize( ); i++ ) {
-             vec<int> s1, s2, t1, t2;
-             for (int j = 0; j < x[i].isize(); j++) {
-                 s1.push_back(x[i][j].first);
-                 s2.push_back(x[i][j].second);
-             }
-             UniqueSort(s1), UniqueSort(s2);
-
-             vec<int> ss1, ss2;
-             for (int j = 0; j < s1.isize(); j++)
-                 ss1.append(n[s1[j]]);
-             for (int j = 0; j < s2.isize(); j++)
-                 ss2.append(n[s2[j]]);
-             UniqueSort(ss1), UniqueSort(ss2);
-             s1 = ss1;
-             s2 = ss2;
-
-             for (int j = 0; j < s1.isize(); j++)
-                 t1.append(ind1[s1[j]]);
-             for (int j = 0; j < s2.isize(); j++)
-                 t2.append(ind2[s2[j]]);
-             UniqueSort(t1), UniqueSort(t2);
-             vec<int> t = Intersection(t1, t2);
-             tt1.insert(tt1.end(),t);
-         }
-         #pragma omp critical
-         {
-             for (auto &t:tt1)
-                 for ( auto x : t )
-                     e.Join( t[0], x );
-         }
-     }
 
+     // Join each cluster to those that share a neighborhood on both sides.
 
-
-     vec< vec< std::pair<int,int> > > z;
-     vec<int> reps;
-     e.OrbitReps(reps);
-     for ( int j = 0; j < reps.isize( ); j++ )
-     {    vec<int> o;
-          e.Orbit( reps[j], o );
-          vec< std::pair<int,int> > m;
+     ConcurrentUnionFind e( x.size( ) );
+     #pragma omp parallel
+     {    vec<int> s1, s2, ss1, ss2, t1, t2, t;
+          #pragma omp for schedule(dynamic, 100)
+          for ( int i = 0; i < x.isize( ); i++ )
+          {    s1.clear( ), s2.clear( ), ss1.clear( ), ss2.clear( );
+               t1.clear( ), t2.clear( );
+               for ( int j = 0; j < x[i].isize( ); j++ )
+               {    s1.push_back( x[i][j].first );
+                    s2.push_back( x[i][j].second );    }
+               UniqueSort(s1), UniqueSort(s2);
+               for ( int j = 0; j < s1.isize( ); j++ )
+                    ss1.append( n[ s1[j] ] );
+               for ( int j = 0; j < s2.isize( ); j++ )
+                    ss2.append( n[ s2[j] ] );
+               UniqueSort(ss1), UniqueSort(ss2);
+               for ( int j = 0; j < ss1.isize( ); j++ )
+                    t1.append( ind1[ ss1[j] ] );
+               for ( int j = 0; j < ss2.isize( ); j++ )
+                    t2.append( ind2[ ss2[j] ] );
+               UniqueSort(t1), UniqueSort(t2);
+               Intersection( t1, t2, t );
+               for ( int j = 1; j < t.isize( ); j++ )
+                    e.join( t[0], t[j] );    }    }
+
+     // Gather the classes.  Each is numbered by its smallest member.
+
+     vec<int> root( x.size( ) ), cid( x.size( ), -1 );
+     #pragma omp parallel for
+     for ( int i = 0; i < x.isize( ); i++ )
+          root[i] = e.find(i);
+     vec< vec<int> > orbits;
+     for ( int i = 0; i < x.isize( ); i++ )
+     {    if ( root[i] == i )
+          {    cid[i] = orbits.size( );
+               orbits.push_back( vec<int>( ) );    }
+          orbits[ cid[ root[i] ] ].push_back(i);    }
+     vec< vec< std::pair<int,int> > > z( orbits.size( ) );
+     #pragma omp parallel for schedule(dynamic, 100)
+     for ( int j = 0; j < orbits.isize( ); j++ )
+     {    const vec<int>& o = orbits[j];
           for ( int l = 0; l < o.isize( ); l++ )
-               m.append( x[ o[l] ] );
-          UniqueSort(m);
-          z.push_back(m);    }
+               z[j].append( x[ o[l] ] );
+          UniqueSort( z[j] );    }
      sortInPlaceParallel(z.begin(),z.end());
      y = z;    }
 
@@ -208,13 +204,15 @@ void Unsat( const HyperBasevector& hb, const vec<int>& inv,
 
      // Form neighborhoods.
      vec<vec<int>> n( hb.EdgeObjectCount( ) );
+     #pragma omp parallel for schedule(dynamic, 1000)
      for ( int e = 0; e < hb.EdgeObjectCount( ); e++ )
           n[e] = Nhood( hb, to_left, to_right, e, radius );
 
      // Form initial clusters.
 
      xs.clear( );
-
+     vec< vec< vec< std::pair<int,int> > > > xs_by_edge( hb.EdgeObjectCount( ) );
+     #pragma omp parallel for schedule(dynamic, 1000)
      for ( int id1 = 0; id1 < hb.EdgeObjectCount( ); id1++ )
      {    for ( int m = 0; m < unsats[id1].isize( ); m++ )
           {    int id2 = unsats[id1][m].first;
@@ -228,7 +226,10 @@ void Unsat( const HyperBasevector& hb, const vec<int>& inv,
                          if ( BinMember( n[ id[1] ], unsats[e1][j].first ) )
                               x.push( e1, e2 );    }    }
                Sort(x);
-               xs.push_back(x);    }     }
+               xs_by_edge[id1].push_back(x);    }     }
+     for ( int id1 = 0; id1 < hb.EdgeObjectCount( ); id1++ )
+          xs.append( xs_by_edge[id1] );
+     Destroy(xs_by_edge);
      double clock = WallClockTime( ); // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
      __gnu_parallel::sort(xs.begin(),xs.end());
 
@@ -13,6 +13,18 @@
 #include "paths/HyperBasevector.h"
 #include "paths/long/ReadPath.h"
 
+// The edges within radius steps of e, a step going right and then left.
+
+vec<int> Nhood( const HyperBasevector& hb, const vec<int>& to_left,
+     const vec<int>& to_right, const int e, const int radius );
+
+// Merge each cluster of links in x with the clusters having a left end in the
+// neighborhoods n of its left ends, and a right end in those of its right
+// ends, transitively.  N is the number of edges.
+
+void MergeClusters( const vec< vec< std::pair<int,int> > >& x,
+     vec< vec< std::pair<int,int> > >& y, const vec< vec<int> >& n, const int N );
+
 void Unsat( const HyperBasevector& hb, const vec<int>& inv, 
      const ReadPathVec& paths, vec< vec< std::pair<int,int> > >& xs,
      const String& work_dir, const int A2V );
@@ -0,0 +1,125 @@
+/*
+ * SyntheticGenome.cc
+ */
+
+#include "paths/simulation/SyntheticGenome.h"
+#include "random/NormalDistribution.h"
+#include "system/System.h"
+#include <cmath>
+
+namespace
+{
+
+double uniform( RNGen& rng )
+{ return (rng.next()+.5)/(RNGen::RNGEN_RAND_MAX+1.); }
+
+bool chance( RNGen& rng, double prob )
+{ return prob > 0. && uniform(rng) < prob; }
+
+int normal( RNGen& rng, double mean, double sd )
+{
+    double x;
+    while ( !NormalDeviate(uniform(rng),2.*uniform(rng)-1.,x) )
+        ;
+    return int(std::lround(mean+sd*x));
+}
+
+// A base other than the given one.
+unsigned char mutate( RNGen& rng, unsigned char base )
+{ return (base+1+rng.next()%3)&3; }
+
+}
+
+void SimulateGenome( genome_params const& gp, RNGen& rng, vecbvec& haplotypes )
+{
+    if ( gp.ploidy < 1 )
+        FatalErr("Can't simulate a genome of ploidy " << gp.ploidy << '.');
+    bvec ref(gp.size);
+    for ( size_t i = 0; i != gp.size; ++i )
+        ref.set(i,rng.next()&3);
+
+    if ( gp.repeat_len > 0 && size_t(gp.repeat_len) <= gp.size
+            && gp.repeat_copies > 1 )
+    {
+        double unitBases = double(gp.repeat_len)*gp.repeat_copies;
+        size_t nUnits = std::lround(gp.repeat_frac*gp.size/unitBases);
+        bvec unit(gp.repeat_len);
+        for ( size_t u = 0; u != nUnits; ++u )
+        {
+            for ( int i = 0; i != gp.repeat_len; ++i )
+                unit.set(i,rng.next()&3);
+            for ( int c = 0; c != gp.repeat_copies; ++c )
+            {
+                size_t start = rng.next()%(gp.size-gp.repeat_len+1);
+                bool rc = rng.next()&1;
+                for ( int i = 0; i != gp.repeat_len; ++i )
+                {
+                    unsigned char base = rc ? 3-unit[gp.repeat_len-1-i] : unit[i];
+                    if ( chance(rng,gp.repeat_div) )
+                        base = mutate(rng,base);
+                    ref.set(start+i,base);
+                }
+            }
+        }
+    }
+
+    haplotypes.clear();
+    haplotypes.reserve(gp.ploidy);
+    haplotypes.push_back(ref);
+    for ( int h = 1; h < gp.ploidy; ++h )
+    {
+        bvec hap(ref);
+        for ( size_t i = 0; i != gp.size; ++i )
+            if ( chance(rng,gp.het) )
+                hap.set(i,mutate(rng,hap[i]));
+        haplotypes.push_back(hap);
+    }
+}
+
+void SimulatePairs( vecbvec const& haplotypes, read_params const& rp, RNGen& rng,
+     vecbvec& bases, vecqvec& quals, vec<sim_pair>* origins )
+{
+    int const L = rp.read_len;
+    for ( auto const& hap : haplotypes )
+        if ( hap.size() < unsigned(L) )
+            FatalErr("Can't simulate " << L << "-base reads from a haplotype of "
+                     << hap.size() << " bases.");
+    size_t nPairs = haplotypes.empty() ? 0 :
+            std::lround(rp.coverage*haplotypes[0].size()/(2.*L));
+    bases.clear(), quals.clear();
+    bases.reserve(2*nPairs), quals.reserve(2*nPairs);
+    if ( origins ) origins->clear();
+
+    bvec frag, read;
+    qvec qual(L);
+    for ( size_t p = 0; p != nPairs; ++p )
+    {
+        sim_pair sp;
+        sp.hap = rng.next()%haplotypes.size();
+        bvec const& hap = haplotypes[sp.hap];
+        sp.len = normal(rng,rp.insert_mean,rp.insert_sd);
+        sp.len = std::max(L,std::min(sp.len,int(std::min<size_t>(hap.size(),INT_MAX))));
+        sp.start = rng.next()%(hap.size()-sp.len+1);
+        sp.rc = rng.next()&1;
+        frag.SetToSubOf(hap,sp.start,sp.len);
+        if ( sp.rc ) frag.ReverseComplement();
+        for ( int end = 0; end != 2; ++end )
+        {
+            if ( end == 1 ) frag.ReverseComplement();
+            read.SetToSubOf(frag,0,L);
+            for ( int i = 0; i != L; ++i )
+            {
+                if ( chance(rng,rp.error_rate) )
+                {
+                    read.set(i,mutate(rng,read[i]));
+                    qual[i] = 2+rng.next()%14;
+                }
+                else
+                    qual[i] = 25+rng.next()%16;
+            }
+            bases.push_back(read);
+            quals.push_back(qual);
+        }
+        if ( origins ) origins->push_back(sp);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * SyntheticGenome.h
+ *
+ * Random genomes with repeats and heterozygosity, and Illumina-like read
+ * pairs sampled from them, so the assembler can be exercised without real
+ * data.  Everything is drawn from the RNGen passed in: the same seed gives
+ * the same genome and the same reads.
+ */
+
+#ifndef PATHS_SIMULATION_SYNTHETICGENOME_H_
+#define PATHS_SIMULATION_SYNTHETICGENOME_H_
+
+#include "Basevector.h"
+#include "Qualvector.h"
+#include "Vec.h"
+#include "random/RNGen.h"
+
+struct genome_params
+{
+    size_t size = 2000000;      // bases in each haplotype
+    double repeat_frac = .05;   // fraction of the genome covered by repeat copies
+    int repeat_len = 1000;      // length of a repeat unit
+    int repeat_copies = 4;      // copies of each repeat unit
+    double repeat_div = .005;   // per-base divergence between copies of a unit
+    double het = .001;          // per-base SNP rate of each haplotype but the first
+    int ploidy = 2;             // number of haplotypes
+};
+
+struct read_params
+{
+    double coverage = 30;       // read bases per base of one haplotype
+    int read_len = 150;
+    int insert_mean = 450;
+    int insert_sd = 50;
+    double error_rate = .002;   // per-base substitution rate
+};
+
+// Where a simulated pair came from: the fragment [start,start+len) of
+// haplotype hap, read from its reverse strand if rc.
+
+struct sim_pair
+{
+    int hap;
+    int64_t start;
+    int len;
+    bool rc;
+};
+
+// The haplotypes of a random genome, one record each.  The first haplotype
+// is the reference: random bases, overwritten in places by diverged copies of
+// random repeat units, in either orientation.  The others are copies of it
+// with SNPs at rate het.
+
+void SimulateGenome( genome_params const& gp, RNGen& rng, vecbvec& haplotypes );
+
+// Read pairs from the haplotypes, in the order ExtractReads would give them:
+// read 2i and 2i+1 are the two ends of a fragment, each as sequenced, facing
+// each other.  Fragment lengths are normal, and each pair comes from a random
+// haplotype.  Substitution errors get low qualities, other bases high ones.
+// If origins isn't null, it gets where each pair came from.
+
+void SimulatePairs( vecbvec const& haplotypes, read_params const& rp, RNGen& rng,
+     vecbvec& bases, vecqvec& quals, vec<sim_pair>* origins = nullptr );
+
+#endif /* PATHS_SIMULATION_SYNTHETICGENOME_H_ */
@@ -0,0 +1,86 @@
+/*
+ * BackgroundWriter.cc
+ */
+
+#include "system/BackgroundWriter.h"
+#include "system/System.h"
+#include <exception>
+#include <iostream>
+
+BackgroundWriter::BackgroundWriter()
+: mJobAdded(mLock), mJobDone(mLock), mBusy(false), mQuit(false),
+  mThread([this](){run();})
+{}
+
+BackgroundWriter::~BackgroundWriter()
+{
+    finish();
+    if ( true )
+    { Locker locker(mLock); mQuit = true; }
+    mJobAdded.signal();
+    mThread.join();
+}
+
+void BackgroundWriter::add( std::string const& what,
+                            std::function<void()> job )
+{
+    if ( true )
+    { Locker locker(mLock); mJobs.emplace_back(what,std::move(job)); }
+    mJobAdded.signal();
+}
+
+std::vector<std::string> BackgroundWriter::wait()
+{
+    Locker locker(mLock);
+    while ( mBusy || !mJobs.empty() )
+        locker.wait(mJobDone);
+    std::vector<std::string> failures;
+    failures.swap(mFailures);
+    return failures;
+}
+
+void BackgroundWriter::finish()
+{
+    std::vector<std::string> failures = wait();
+    if ( failures.empty() )
+        return;
+    for ( std::string const& failure : failures )
+        std::cout << failure << std::endl;
+    FatalErr(failures.size() << " background write(s) failed.");
+}
+
+void BackgroundWriter::run()
+{
+    while ( true )
+    {
+        std::pair<std::string,std::function<void()>> job;
+        if ( true )
+        {
+            Locker locker(mLock);
+            while ( mJobs.empty() && !mQuit )
+                locker.wait(mJobAdded);
+            if ( mJobs.empty() )
+                return;
+            job = std::move(mJobs.front());
+            mJobs.pop_front();
+            mBusy = true;
+        }
+
+        std::string failure;
+        try
+        { job.second(); }
+        catch ( std::exception const& e )
+        { failure = "Writing " + job.first + " failed: " + e.what(); }
+        catch ( ... )
+        { failure = "Writing " + job.first + " failed."; }
+
+        if ( true )
+        {
+            Locker locker(mLock);
+            if ( !failure.empty() )
+                mFailures.push_back(failure);
+            mBusy = false;
+        }
+        mJobDone.broadcast();
+    }
+}
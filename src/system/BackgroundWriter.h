@@ -0,0 +1,55 @@
+/*
+ * BackgroundWriter.h
+ *
+ * Writes files on a thread of its own, so the assembly can start its next
+ * step while the last step's outputs go to disk.  Jobs run one at a time, in
+ * the order they were added.  A job must own what it writes: hand it a copy,
+ * or the object itself if the caller is done with it.
+ */
+
+#ifndef SYSTEM_BACKGROUNDWRITER_H_
+#define SYSTEM_BACKGROUNDWRITER_H_
+
+#include "system/LockedData.h"
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class BackgroundWriter
+{
+public:
+    BackgroundWriter();
+    BackgroundWriter( BackgroundWriter const& )=delete;
+    BackgroundWriter& operator=( BackgroundWriter const& )=delete;
+
+    /// Calls finish().
+    ~BackgroundWriter();
+
+    /// Queues a job.  What names it in failure messages.
+    void add( std::string const& what, std::function<void()> job );
+
+    /// Waits for the queued jobs, and returns a message for each job that
+    /// threw since the last call.
+    std::vector<std::string> wait();
+
+    /// Waits for the queued jobs, and exits with a report of the failures if
+    /// any job threw.
+    void finish();
+
+private:
+    void run();
+
+    LockedData mLock;
+    Condition mJobAdded;
+    Condition mJobDone;
+    std::deque<std::pair<std::string,std::function<void()>>> mJobs;
+    std::vector<std::string> mFailures;
+    bool mBusy;
+    bool mQuit;
+    std::thread mThread;
+};
+
+#endif /* SYSTEM_BACKGROUNDWRITER_H_ */
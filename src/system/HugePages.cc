@@ -0,0 +1,90 @@
+/*
+ * HugePages.cc
+ *
+ * Explicit hugetlbfs pages would need a reserved pool and an munmap on every
+ * free path, so only transparent huge pages are used.
+ */
+
+#include "system/HugePages.h"
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+
+namespace
+{
+
+bool gEnabled = false;
+std::atomic<size_t> gAdvisedBytes(0);
+
+// The bracketed choice in the kernel's setting, e.g. "madvise" from
+// "always [madvise] never", or empty if there are no transparent huge pages.
+std::string thpSetting()
+{
+    std::ifstream in("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string word;
+    while ( in >> word )
+        if ( word.size() > 2 && word.front() == '[' && word.back() == ']' )
+            return word.substr(1,word.size()-2);
+    return std::string();
+}
+
+}
+
+bool HugePages::enable( bool on )
+{
+    gEnabled = false;
+    if ( !on )
+        return false;
+    std::string setting = thpSetting();
+#ifdef MADV_HUGEPAGE
+    if ( setting == "always" || setting == "madvise" )
+        gEnabled = true;
+#endif
+    if ( !gEnabled )
+        std::cout << "Warning: transparent huge pages are "
+                  << (setting.empty() ? "not available" : setting)
+                  << ", keeping small pages." << std::endl;
+    return gEnabled;
+}
+
+bool HugePages::enabled()
+{
+    return gEnabled;
+}
+
+void HugePages::advise( void* mem, size_t bytes )
+{
+    if ( !gEnabled || bytes < MIN_ADVISE_BYTES )
+        return;
+    uintptr_t start = reinterpret_cast<uintptr_t>(mem);
+    uintptr_t first = (start+PAGE_BYTES-1) & ~(PAGE_BYTES-1);
+    uintptr_t last = (start+bytes) & ~(PAGE_BYTES-1);
+    if ( last <= first )
+        return;
+#ifdef MADV_HUGEPAGE
+    if ( !madvise(reinterpret_cast<void*>(first),last-first,MADV_HUGEPAGE) )
+        gAdvisedBytes += last - first;
+#endif
+}
+
+size_t HugePages::advisedBytes()
+{
+    return gAdvisedBytes;
+}
+
+size_t HugePages::backedBytes()
+{
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string key;
+    size_t kB;
+    while ( in >> key )
+    {
+        if ( key == "AnonHugePages:" && in >> kB )
+            return kB*1024;
+        in.ignore(1024,'\n');
+    }
+    return 0;
+}
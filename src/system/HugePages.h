@@ -0,0 +1,43 @@
+/*
+ * HugePages.h
+ *
+ * Transparent huge page backing for the big random-access arrays: the k-mer
+ * dictionaries, the read and path stores.  With 4 kB pages, lookups into
+ * tables of many GB miss the TLB almost every time.
+ */
+
+#ifndef SYSTEM_HUGEPAGES_H_
+#define SYSTEM_HUGEPAGES_H_
+
+#include <cstddef>
+
+namespace HugePages
+{
+
+/// Turn the advice on or off for every later allocation.  If the kernel has
+/// no transparent huge pages, or has them set to "never", we warn and stay
+/// off.  Returns whether the advice is on.
+bool enable( bool on );
+
+/// Whether the advice is on.
+bool enabled();
+
+/// If the advice is on, ask the kernel to back the whole 2 MB pages inside a
+/// new block of this many bytes with huge pages.  Does nothing for blocks
+/// under MIN_ADVISE_BYTES.  A refusal is ignored: the block just keeps its
+/// small pages.
+void advise( void* mem, size_t bytes );
+
+/// Bytes that the kernel has agreed to back with huge pages so far.
+size_t advisedBytes();
+
+/// Bytes of the process's memory actually on huge pages now, or 0 if the
+/// kernel doesn't say.
+size_t backedBytes();
+
+size_t const PAGE_BYTES = 2ul*1024*1024;
+size_t const MIN_ADVISE_BYTES = 2*PAGE_BYTES;
+
+}
+
+#endif /* SYSTEM_HUGEPAGES_H_ */
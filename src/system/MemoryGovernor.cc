@@ -0,0 +1,115 @@
+/*
+ * MemoryGovernor.cc
+ */
+
+#include "system/MemoryGovernor.h"
+#include "system/HugePages.h"
+#include "system/System.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <unistd.h>
+
+namespace
+{
+
+std::string gSpillDir;
+std::atomic<unsigned> gSpillSerial(0);
+
+double const GB = 1024.*1024.*1024.;
+
+// the high-water mark in bytes, or 0 if we can't tell
+size_t peakBytes()
+{
+#ifdef __linux
+    std::ifstream in("/proc/self/status");
+    std::string tag;
+    while ( in >> tag )
+    {
+        if ( tag == "VmHWM:" )
+        {
+            size_t kb = 0;
+            in >> kb;
+            return kb*1024ul;
+        }
+        in.ignore(std::numeric_limits<std::streamsize>::max(),'\n');
+    }
+#endif
+    return 0;
+}
+
+}
+
+namespace MemoryGovernor
+{
+
+void setSpillDir( std::string const& dir )
+{ gSpillDir = dir; }
+
+std::string const& spillDir()
+{ return gSpillDir; }
+
+std::string spillFile( std::string const& tag )
+{
+    std::string dir = gSpillDir.empty() ? std::string(".") : gSpillDir;
+    return dir + "/spill." + std::to_string(getpid()) + '.' +
+            std::to_string(gSpillSerial++) + '.' + tag;
+}
+
+size_t budget( double fract )
+{ return MemAvailable(fract); }
+
+size_t planningBudget( double fract )
+{
+    size_t avail = budget(fract);
+    return avail ? avail : GetMaxMemory()/2;
+}
+
+size_t nBatches( size_t totalBytes, size_t maxBatches, double fract )
+{
+    size_t avail = std::max(planningBudget(fract),1ul);
+    size_t result = (totalBytes+avail-1)/avail;
+    return std::max(1ul,std::min(result,maxBatches));
+}
+
+size_t batchSize( size_t bytesPerUnit, size_t minBatch, size_t maxBatch,
+                    double fract )
+{
+    size_t result = budget(fract)/std::max(bytesPerUnit,1ul);
+    return std::max(minBatch,std::min(result,maxBatch));
+}
+
+Phase::Phase( std::string const& name )
+: mName(name), mStartBytes(MemUsageBytes()), mStartPeakBytes(peakBytes())
+{}
+
+Phase::~Phase()
+{
+    size_t endBytes = MemUsageBytes();
+    size_t peak = peakBytes();
+    size_t limit = GetMaxMemory();
+    std::cout << Date() << ": memory for " << mName << std::fixed
+              << std::setprecision(2) << ": start " << mStartBytes/GB
+              << " GB, end " << endBytes/GB << " GB";
+    // the high-water mark covers the whole run, so it only tells us about this
+    // phase if the phase raised it
+    if ( peak > mStartPeakBytes )
+        std::cout << ", peak " << peak/GB << " GB (up "
+                  << (peak-mStartPeakBytes)/GB << " GB)";
+    else
+        std::cout << ", peak no higher than before";
+    std::cout << ", limit " << limit/GB << " GB";
+    if ( HugePages::enabled() )
+        std::cout << ", on huge pages " << HugePages::backedBytes()/GB
+                  << " GB of " << HugePages::advisedBytes()/GB << " GB advised";
+    std::cout
+              << std::resetiosflags(std::ios::fixed) << std::endl;
+    if ( peak > mStartPeakBytes && peak > limit )
+        std::cout << Date() << ": WARNING: " << mName
+                  << " went over the --max_mem limit" << std::endl;
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+ * MemoryGovernor.h
+ *
+ * Turns the SetMaxMemory advisory into decisions: how many batches to split
+ * a job into, whether an intermediate still fits, and where to spill it when
+ * it doesn't.  Nothing is enforced; callers ask before they allocate.
+ */
+
+#ifndef SYSTEM_MEMORYGOVERNOR_H_
+#define SYSTEM_MEMORYGOVERNOR_H_
+
+#include <cstddef>
+#include <string>
+
+namespace MemoryGovernor
+{
+
+/// Fraction of the advisory that the governor will plan to use.  The rest is
+/// slack for allocator overhead and things we haven't accounted for.
+double const DEFAULT_FRACT = .85;
+
+/// Set the directory that large intermediates are spilled to.
+void setSpillDir( std::string const& dir );
+
+/// The spill directory.  Empty if none was set.
+std::string const& spillDir();
+
+/// A fresh file name in the spill directory, with the given tag in it.
+std::string spillFile( std::string const& tag );
+
+/// Bytes that may still be allocated before the advisory is exceeded.
+size_t budget( double fract = DEFAULT_FRACT );
+
+/// Whether an allocation of this many bytes would fit within the budget.
+inline bool fits( size_t bytes, double fract = DEFAULT_FRACT )
+{ return bytes <= budget(fract); }
+
+/// The budget to size batches against.  This is budget(), unless that is
+/// already used up, which says little about how big a batch could be; then
+/// it's half the advisory.
+size_t planningBudget( double fract = DEFAULT_FRACT );
+
+/// Number of batches to split a job into so that each batch's share of
+/// totalBytes fits within planningBudget().  Always at least 1 and at most
+/// maxBatches.
+size_t nBatches( size_t totalBytes, size_t maxBatches = ~0ul,
+                    double fract = DEFAULT_FRACT );
+
+/// Number of units per batch, if each unit costs bytesPerUnit, clamped to
+/// [minBatch,maxBatch].
+size_t batchSize( size_t bytesPerUnit, size_t minBatch, size_t maxBatch,
+                    double fract = DEFAULT_FRACT );
+
+/// Logs the memory used by one phase of the assembly, and whether the phase
+/// raised the process's peak above the advisory.  Construct at the start of
+/// the phase.  The kernel's high-water mark is only read, never reset.
+class Phase
+{
+public:
+    explicit Phase( std::string const& name );
+    Phase( Phase const& )=delete;
+    Phase& operator=( Phase const& )=delete;
+    ~Phase();
+
+private:
+    std::string mName;
+    size_t mStartBytes;
+    size_t mStartPeakBytes;
+};
+
+}
+
+#endif /* SYSTEM_MEMORYGOVERNOR_H_ */
@@ -0,0 +1,150 @@
+/*
+ * NumaPolicy.cc
+ *
+ * set_mempolicy is called directly, so that libnuma isn't needed to build.
+ */
+
+#include "system/NumaPolicy.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <omp.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+
+int const MPOL_DEFAULT_MODE = 0;
+int const MPOL_INTERLEAVE_MODE = 3;
+size_t const MAX_NODES = 1024;
+unsigned long const BITS_PER_LONG = 8*sizeof(unsigned long);
+
+NumaPolicy::Policy gPolicy = NumaPolicy::DEFAULT;
+
+// The online nodes, from a list of ranges like "0-3,5".  Returns the count.
+int onlineNodes( unsigned long* mask )
+{
+    std::ifstream in("/sys/devices/system/node/online");
+    std::string list;
+    if ( !(in >> list) )
+    {
+        mask[0] |= 1;
+        return 1;
+    }
+    int count = 0;
+    size_t pos = 0;
+    while ( pos < list.size() )
+    {
+        size_t end = list.find(',',pos);
+        if ( end == std::string::npos ) end = list.size();
+        std::string range = list.substr(pos,end-pos);
+        size_t dash = range.find('-');
+        unsigned long lo = std::stoul(range.substr(0,dash));
+        unsigned long hi = dash == std::string::npos ? lo
+                                : std::stoul(range.substr(dash+1));
+        for ( unsigned long node = lo; node <= hi && node < MAX_NODES; ++node )
+        {
+            mask[node/BITS_PER_LONG] |= 1ul << node%BITS_PER_LONG;
+            count += 1;
+        }
+        pos = end + 1;
+    }
+    return count ? count : 1;
+}
+
+bool setMempolicy( int mode, unsigned long const* mask )
+{
+#ifdef SYS_set_mempolicy
+    // the kernel takes one more than the number of bits in the mask
+    return !syscall(SYS_set_mempolicy,mode,mask,MAX_NODES+1);
+#else
+    return false;
+#endif
+}
+
+// The kernel keeps a policy per thread, so set it on every thread of the
+// OpenMP pool, this one included.  A team reuses the pool's threads, so one as
+// big as any team so far reaches them all.  Threads started later inherit the
+// policy from the thread that starts them.
+bool setMempolicyEverywhere( int mode, unsigned long const* mask )
+{
+    bool ok = true;
+    int nThreads = std::max(omp_get_max_threads(),omp_get_num_procs());
+    #pragma omp parallel num_threads(nThreads) reduction(&&:ok)
+    ok = setMempolicy(mode,mask);
+    return ok;
+}
+
+}
+
+bool NumaPolicy::parse( std::string const& name, Policy& policy )
+{
+    if ( name == "default" ) policy = DEFAULT;
+    else if ( name == "interleave" ) policy = INTERLEAVE;
+    else if ( name == "first_touch" ) policy = FIRST_TOUCH;
+    else return false;
+    return true;
+}
+
+char const* NumaPolicy::name( Policy policy )
+{
+    switch ( policy )
+    {
+    case INTERLEAVE: return "interleave";
+    case FIRST_TOUCH: return "first_touch";
+    default: return "default";
+    }
+}
+
+int NumaPolicy::nNodes()
+{
+    unsigned long mask[MAX_NODES/BITS_PER_LONG] = {};
+    return onlineNodes(mask);
+}
+
+NumaPolicy::Policy NumaPolicy::set( Policy policy )
+{
+    if ( omp_in_parallel() )
+    {
+        std::cout << "Warning: can't change the NUMA policy inside a parallel "
+                     "region, keeping " << name(gPolicy) << '.' << std::endl;
+        return gPolicy;
+    }
+    unsigned long mask[MAX_NODES/BITS_PER_LONG] = {};
+    int nodes = onlineNodes(mask);
+    if ( policy == INTERLEAVE && nodes == 1 )
+        policy = DEFAULT;
+    if ( policy == INTERLEAVE )
+    {
+        if ( !setMempolicyEverywhere(MPOL_INTERLEAVE_MODE,mask) )
+        {
+            std::cout << "Warning: can't interleave memory across "
+                      << nodes << " NUMA nodes, keeping the default policy."
+                      << std::endl;
+            setMempolicyEverywhere(MPOL_DEFAULT_MODE,nullptr);
+            policy = DEFAULT;
+        }
+    }
+    else if ( gPolicy == INTERLEAVE )
+        setMempolicyEverywhere(MPOL_DEFAULT_MODE,nullptr);
+    gPolicy = policy;
+    return policy;
+}
+
+NumaPolicy::Policy NumaPolicy::get()
+{
+    return gPolicy;
+}
+
+void NumaPolicy::touch( void* mem, size_t bytes )
+{
+    if ( gPolicy != FIRST_TOUCH || bytes < MIN_TOUCH_BYTES || omp_in_parallel() )
+        return;
+    char* start = static_cast<char*>(mem);
+    int64_t const page = sysconf(_SC_PAGESIZE);
+    int64_t const nPages = (bytes+page-1)/page;
+    #pragma omp parallel for schedule(static)
+    for ( int64_t idx = 0; idx < nPages; ++idx )
+        start[idx*page] = 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * NumaPolicy.h
+ *
+ * Where the pages of the big shared arrays go on a multi-socket machine.  The
+ * reads, quals, paths and dictionaries are mostly filled by one thread and
+ * then read by all of them, so by default they all land on one node's memory.
+ */
+
+#ifndef SYSTEM_NUMAPOLICY_H_
+#define SYSTEM_NUMAPOLICY_H_
+
+#include <cstddef>
+#include <string>
+
+namespace NumaPolicy
+{
+
+enum Policy
+{
+    DEFAULT,     ///< the kernel's: a page goes to the node that first touches it
+    INTERLEAVE,  ///< every allocation's pages go round-robin across the nodes
+    FIRST_TOUCH  ///< the default, with big new arrays touched in parallel
+};
+
+/// Parse "default", "interleave" or "first_touch".  Returns false, leaving
+/// policy alone, for any other name.
+bool parse( std::string const& name, Policy& policy );
+
+/// The name that parse() takes for a policy.
+char const* name( Policy policy );
+
+/// The number of NUMA nodes the process may allocate on.  1 without NUMA.
+int nNodes();
+
+/// Set the policy for every later allocation.  The kernel keeps a policy per
+/// thread, so it's set on the calling thread and on the OpenMP pool, as far as
+/// a default-sized team (or one thread per processor) reaches; threads started
+/// later inherit it.  Other threads already running keep their own, so call
+/// this at startup, after omp_set_num_threads and before any others.  Inside a
+/// parallel region it warns and changes nothing.  With one node there's
+/// nothing to interleave, so INTERLEAVE gives DEFAULT.  If the kernel refuses
+/// it, we warn and keep the default.  Returns the policy in effect.
+Policy set( Policy policy );
+
+/// The policy in effect.
+Policy get();
+
+/// Under FIRST_TOUCH, touch the pages of a new block of this many bytes from
+/// the threads of a static OpenMP schedule over it, so that each page lands on
+/// the node of the thread that will later work on that part of the block.
+/// The block's contents must not matter yet: one byte per page is zeroed.
+/// Does nothing under the other policies, for blocks under MIN_TOUCH_BYTES,
+/// or inside a parallel region.
+void touch( void* mem, size_t bytes );
+
+size_t const MIN_TOUCH_BYTES = 16ul*1024*1024;
+
+}
+
+#endif /* SYSTEM_NUMAPOLICY_H_ */
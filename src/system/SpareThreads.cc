@@ -0,0 +1,59 @@
+/*
+ * SpareThreads.cc
+ */
+
+#include "system/SpareThreads.h"
+#include <algorithm>
+#include <atomic>
+#include <omp.h>
+
+namespace
+{
+
+std::atomic<int> gDonated(0);
+
+}
+
+namespace SpareThreads
+{
+
+Pool::Pool()
+: mOldLevels(omp_get_max_active_levels())
+{ gDonated = 0;
+  omp_set_max_active_levels(std::max(mOldLevels,2)); }
+
+Pool::~Pool()
+{ omp_set_max_active_levels(mOldLevels);
+  gDonated = 0; }
+
+void enter()
+{ omp_set_num_threads(1); }
+
+void donate()
+{ ++gDonated; }
+
+int donated()
+{ return gDonated.load(); }
+
+Loan::Loan( int maxThreads )
+: mThreads(1), mBorrowed(0)
+{
+    if ( maxThreads <= 1 )
+        return;
+    if ( !omp_in_parallel() )
+    {
+        mThreads = std::min(maxThreads,omp_get_max_threads());
+        return;
+    }
+    int avail = gDonated.load();
+    int want = std::min(avail,maxThreads-1);
+    while ( want > 0 && !gDonated.compare_exchange_weak(avail,avail-want) )
+        want = std::min(avail,maxThreads-1);
+    mBorrowed = std::max(want,0);
+    mThreads = mBorrowed + 1;
+}
+
+Loan::~Loan()
+{ gDonated += mBorrowed; }
+
+}
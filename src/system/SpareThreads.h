@@ -0,0 +1,79 @@
+/*
+ * SpareThreads.h
+ *
+ * Lends the idle threads of a parallel loop to the iterations that are still
+ * running.  When a loop over uneven items (blobs, say) runs down, threads that
+ * have finished sit at the barrier while the last big items run serially.  A
+ * thread that runs out of work donates itself, and code inside a running item
+ * that has enough parallel work borrows donated threads for a nested region.
+ *
+ * The outer region is set up like this:
+ *
+ *     SpareThreads::Pool pool;
+ *     #pragma omp parallel
+ *     {    SpareThreads::enter();
+ *          #pragma omp for schedule(dynamic,1) nowait
+ *          for ( ... ) { ... }
+ *          SpareThreads::donate();    }
+ *
+ * and a nested loop like this:
+ *
+ *     SpareThreads::Loan loan(nChunks);
+ *     #pragma omp parallel for num_threads(loan.threads()) if(loan.threads()>1)
+ *     for ( ... ) { ... }
+ *
+ * Outside of any parallel region, a Loan simply hands out up to all threads.
+ */
+
+#ifndef SYSTEM_SPARETHREADS_H_
+#define SYSTEM_SPARETHREADS_H_
+
+namespace SpareThreads
+{
+
+/// Allows one level of nested parallelism for its lifetime, and starts the
+/// count of donated threads at zero.  Construct just before the outer region.
+class Pool
+{
+public:
+    Pool();
+    Pool( Pool const& )=delete;
+    Pool& operator=( Pool const& )=delete;
+    ~Pool();
+
+private:
+    int mOldLevels;
+};
+
+/// Called by each thread at the start of the outer region.  Nested regions
+/// that it encounters run on one thread unless they borrow.
+void enter();
+
+/// Called by a thread of the outer region once it has no more work.
+void donate();
+
+/// The number of donated threads not currently on loan.
+int donated();
+
+/// Borrows donated threads for a nested region, and returns them when it
+/// goes out of scope.
+class Loan
+{
+public:
+    /// Borrow enough to make a team of at most maxThreads.
+    explicit Loan( int maxThreads );
+    Loan( Loan const& )=delete;
+    Loan& operator=( Loan const& )=delete;
+    ~Loan();
+
+    /// The team size to ask for: always at least 1.
+    int threads() const { return mThreads; }
+
+private:
+    int mThreads;
+    int mBorrowed;
+};
+
+}
+
+#endif /* SYSTEM_SPARETHREADS_H_ */
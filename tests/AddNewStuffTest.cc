@@ -0,0 +1,159 @@
+// AddNewStuffTest: check that splicing gap patches into the graph gives the
+// same graph and read paths as rebuilding the whole graph with them.  Reads
+// come from a simulated diploid genome with some windows left out, and the
+// patches fill the windows, add a variant and hang novel sequences off the
+// graph.  Edge numbering may differ, so graphs are compared by their edges'
+// sequences and adjacencies.
+
+#include "CoreTools.h"
+#include "feudal/PQVec.h"
+#include "kmers/BigKPather.h"
+#include "paths/long/large/GapToyTools.h"
+#include "paths/long/large/SpliceNewStuff.h"
+#include "paths/simulation/SyntheticGenome.h"
+
+namespace
+{
+
+// Each edge, with the sequences of the edges that follow it, sorted.
+
+vec<String> GraphSignature( const HyperBasevector& hb )
+{    vec<int> to_right;
+     hb.ToRight(to_right);
+     vec<String> sig;
+     for ( int e = 0; e < hb.EdgeObjectCount( ); e++ )
+     {    vec<String> next;
+          int v = to_right[e];
+          for ( int j = 0; j < hb.From(v).isize( ); j++ )
+               next.push_back( hb.EdgeObject( hb.IFrom( v, j ) ).ToString( ) );
+          Sort(next);
+          String s = hb.EdgeObject(e).ToString( ) + ":";
+          for ( auto const& n : next ) s += " " + n;
+          sig.push_back(s);    }
+     Sort(sig);
+     return sig;    }
+
+// The sequence a read path spells, from its offset on the first edge.
+
+String PathSequence( const HyperBasevector& hb, const ReadPath& p )
+{    String s;
+     for ( int j = 0; j < (int) p.size( ); j++ )
+     {    String e = hb.EdgeObject( p[j] ).ToString( );
+          s += ( j == 0 ? e : e.substr( hb.K( ) - 1, e.size( ) ) );    }
+     return s.empty( ) ? s : s.substr( p.getFirstSkip( ), s.size( ) );    }
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0;
+     const int K = 200, L = 250, W = 300, flank = K + 50;
+     const int MIN_GAIN = 5, EXT_MODE = 1;
+     for ( int seed = 1; seed <= 3; seed++ )
+     {
+          // Error-free reads on both strands of both haplotypes, missing the
+          // windows.
+
+          genome_params gp;
+          gp.size = 60000, gp.het = .002;
+          RNGen rng(seed);
+          vecbvec haps;
+          SimulateGenome( gp, rng, haps );
+          const vec<int> windows = { 12000, 27000, 41000 };
+          vecbvec reads;
+          VecPQVec quals;
+          qvec q(L);
+          for ( int i = 0; i < L; i++ )
+               q[i] = 40;
+          for ( int h = 0; h < 2; h++ )
+          for ( int r = 0; r < 50 * (int) gp.size / L; r++ )
+          {    int start = rng.next( ) % ( gp.size - L + 1 );
+               Bool gap = False;
+               for ( int w : windows )
+                    if ( start < w + W && start + L > w ) gap = True;
+               if (gap) continue;
+               bvec b( haps[h], start, L );
+               if ( rng.next( ) % 2 ) b.ReverseComplement( );
+               reads.push_back(b);
+               quals.push_back( PQVec(q) );    }
+
+          HyperBasevector hb;
+          ReadPathVec paths;
+          buildBigKHBVFromReads( K, reads, 4, &hb, &paths );
+          vec<int> inv;
+          hb.Involution(inv);
+
+          // A novel sequence hanging off a vertex, and a read running into it
+          // from an edge that the patches don't touch, so that only extending
+          // its path again finds the new edge.
+
+          int v = 0;
+          while ( hb.To(v).empty( ) || hb.From(v).empty( ) ) v++;
+          const int e = hb.ITo( v, 0 );
+          const bvec& edge = hb.EdgeObject(e);
+          bvec hang( edge, edge.size( ) - (K-1), K-1 );
+          for ( int i = 0; i < W; i++ )
+               hang.push_back( rng.next( ) % 4 );
+          bvec into( edge, edge.size( ) - L/2, L/2 );
+          into.append( hang.begin( ) + K - 1, hang.begin( ) + K - 1 + L/2 );
+          reads.push_back(into);
+          quals.push_back( PQVec(q) );
+          paths.push_back( ReadPath( edge.size( ) - L/2 ) );
+          paths.back( ).push_back(e);
+
+          vec<int> to_right;
+          hb.ToRight(to_right);
+          for ( size_t i = 0; i < paths.size( ); i++ )
+          {    if ( paths[i].size( ) > 0 ) paths[i].resize(1);
+               ExtendPath( paths[i], i, hb, to_right, reads[i], q, MIN_GAIN,
+                    False, EXT_MODE );    }
+
+          // Patches: the windows with their flanks, one of them from both
+          // haplotypes, a novel sequence branching off the genome, a SNP, and
+          // the sequence hanging off v.
+
+          vecbvec new_stuff;
+          for ( int w : windows )
+               new_stuff.push_back( bvec( haps[0], w - flank, W + 2*flank ) );
+          new_stuff.push_back( bvec( haps[1], windows[1] - flank, W + 2*flank ) );
+          bvec novel( haps[0], 20000 - flank, flank );
+          for ( int i = 0; i < W; i++ )
+               novel.push_back( rng.next( ) % 4 );
+          new_stuff.push_back(novel);
+          bvec snp( haps[0], 35000 - L, 2*L + 1 );
+          snp.Set( L, ( snp[L] + 1 ) % 4 );
+          new_stuff.push_back(snp);
+          new_stuff.push_back(hang);
+
+          HyperBasevector hb1(hb), hb2(hb), hb3(hb);
+          vec<int> inv1(inv), inv2(inv);
+          ReadPathVec paths1(paths), paths2(paths), paths3(paths);
+          vecbvec stuff1(new_stuff), stuff2(new_stuff);
+          AddNewStuff( stuff1, hb1, inv1, paths1, reads, quals, MIN_GAIN,
+               vec<int>( ), "", EXT_MODE, False );
+          AddNewStuff( stuff2, hb2, inv2, paths2, reads, quals, MIN_GAIN,
+               vec<int>( ), "", EXT_MODE, True );
+
+          vec<Bool> remapped;
+          if ( !SpliceNewStuff( new_stuff, hb3, paths3, reads, remapped ) )
+          {    std::cout << "no splice, seed " << seed << std::endl;
+               fails++;
+               continue;    }
+          if ( GraphSignature(hb1) == GraphSignature(hb) )
+          {    std::cout << "patches changed nothing, seed " << seed << std::endl;
+               fails++;    }
+          if ( hb1.N( ) != hb2.N( ) || GraphSignature(hb1) != GraphSignature(hb2)
+               || inv2.size( ) != inv1.size( ) )
+          {    std::cout << "graphs differ, seed " << seed << std::endl;
+               fails++;
+               continue;    }
+          for ( size_t i = 0; i < reads.size( ); i++ )
+          {    if ( paths1[i].getOffset( ) != paths2[i].getOffset( )
+                    || PathSequence( hb1, paths1[i] )
+                         != PathSequence( hb2, paths2[i] ) )
+               {    std::cout << "paths differ, seed " << seed << ", read "
+                         << i << std::endl;
+                    fails++;
+                    break;    }    }    }
+     if ( fails > 0 ) return 1;
+     std::cout << "splice and rebuild agree" << std::endl;
+     return 0;    }
@@ -0,0 +1,60 @@
+// BackgroundWriterTest: check that queued writes all happen, in order, that
+// wait() returns only once they are done, and that a job that throws is
+// reported rather than lost.
+
+#include "CoreTools.h"
+#include "paths/long/ReadPath.h"
+#include "random/Random.h"
+#include "system/BackgroundWriter.h"
+#include <memory>
+#include <stdexcept>
+
+int main( )
+{    int fails = 0;
+     const String file = "BackgroundWriterTest.tmp.paths";
+     BackgroundWriter writer;
+     for ( int it = 0; it < 20; it++ )
+     {
+          // Write a snapshot of some paths, then change the paths at once,
+          // as the next step would.
+
+          ReadPathVec paths( randomx( ) % 5000 );
+          for ( auto& p : paths )
+          {    p.setOffset( randomx( ) % 100 );
+               for ( int j = randomx( ) % 6; j > 0; j-- )
+                    p.push_back( randomx( ) % 1000 );    }
+          auto copy = std::make_shared<ReadPathVec>(paths);
+          vec<int> order;
+          writer.add( "first", [&order]( ) { order.push_back(1); } );
+          writer.add( file, [copy, file]( )
+               { WriteReadPathVec( *copy, file.c_str( ) ); } );
+          writer.add( "last", [&order]( ) { order.push_back(2); } );
+          for ( auto& p : paths )
+               p.clear( );
+          if ( !writer.wait( ).empty( ) )
+          {    std::cout << "unexpected failure, case " << it << std::endl;
+               fails++;    }
+          ReadPathVec back;
+          LoadReadPathVec( back, file.c_str( ) );
+          Bool same = ( back.size( ) == copy->size( ) );
+          for ( size_t i = 0; same && i < back.size( ); i++ )
+               same = back[i].same_read( (*copy)[i] );
+          if ( !same || order != vec<int>{ 1, 2 } )
+          {    std::cout << "write lost or out of order, case " << it
+                    << std::endl;
+               fails++;    }    }
+
+     writer.add( "bad", []( ) { throw std::runtime_error("disk full"); } );
+     writer.add( "good", []( ) { } );
+     std::vector<std::string> failures = writer.wait( );
+     if ( failures.size( ) != 1 || failures[0].find("bad") == std::string::npos
+          || failures[0].find("disk full") == std::string::npos )
+     {    std::cout << "failure not reported" << std::endl;
+          fails++;    }
+     if ( !writer.wait( ).empty( ) )
+     {    std::cout << "failure reported twice" << std::endl;
+          fails++;    }
+     Remove(file);
+     if ( fails > 0 ) return 1;
+     std::cout << "all writes done" << std::endl;
+     return 0;    }
@@ -0,0 +1,102 @@
+// BigKPatherTest: check that the sorted-vector dictionary used for small read
+// sets inside parallel regions builds the same graph and read paths as the
+// hash table used at top level.  Edge numbering may differ, so graphs are
+// compared by their edges' sequences and adjacencies.
+
+#include "CoreTools.h"
+#include "kmers/BigKPather.h"
+#include "random/Random.h"
+#include <omp.h>
+
+namespace
+{
+
+// Each edge, with the sequences of the edges that follow it, sorted.
+
+vec<String> GraphSignature( const HyperBasevector& hb )
+{    vec<int> to_right;
+     hb.ToRight(to_right);
+     vec<String> sig;
+     for ( int e = 0; e < hb.EdgeObjectCount( ); e++ )
+     {    vec<String> next;
+          int v = to_right[e];
+          for ( int j = 0; j < hb.From(v).isize( ); j++ )
+               next.push_back( hb.EdgeObject( hb.IFrom( v, j ) ).ToString( ) );
+          Sort(next);
+          String s = hb.EdgeObject(e).ToString( ) + ":";
+          for ( auto const& n : next ) s += " " + n;
+          sig.push_back(s);    }
+     Sort(sig);
+     return sig;    }
+
+// The sequence a read path spells, from the start of the read.
+
+String PathSequence( const HyperBasevector& hb, const ReadPath& p )
+{    String s;
+     for ( int j = 0; j < (int) p.size( ); j++ )
+     {    String e = hb.EdgeObject( p[j] ).ToString( );
+          s += ( j == 0 ? e : e.substr( hb.K( ) - 1, e.size( ) ) );    }
+     return s.empty( ) ? s : s.substr( p.getFirstSkip( ), s.size( ) );    }
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0;
+     for ( int trial = 0; trial < 30; trial++ )
+     {
+          // Reads from a random genome with a repeat, on both strands, with
+          // an occasional error.
+
+          basevector genome;
+          const int G = 2000 + randomx( ) % 3000;
+          for ( int i = 0; i < G; i++ )
+               genome.push_back( randomx( ) % 4 );
+          for ( int i = 0; i < 150; i++ )
+          {    const unsigned char b = genome[100+i];
+               genome.push_back(b);    }
+          for ( int i = 0; i < 500; i++ )
+               genome.push_back( randomx( ) % 4 );
+          const int nreads = 400;
+          vecbasevector reads;
+          reads.reserve(nreads);
+          for ( int r = 0; r < nreads; r++ )
+          {    const int L = 100 + randomx( ) % 150;
+               const int s = randomx( ) % ( genome.isize( ) - L );
+               basevector b( genome.begin( ) + s, genome.begin( ) + s + L );
+               if ( randomx( ) % 2 ) b.ReverseComplement( );
+               if ( randomx( ) % 10 == 0 ) b.Set( randomx( ) % L, randomx( ) % 4 );
+               reads.push_back(b);    }
+          const unsigned K = 60 + ( trial % 3 ) * 20;
+
+          // Top level uses the hash table; inside a parallel region, the
+          // sorted vector.
+
+          HyperBasevector h1, h2;
+          HyperKmerPath k1, k2;
+          vecKmerPath p1, p2;
+          ReadPathVec r1, r2;
+          buildBigKHBVFromReads( K, reads, 2, &h1, &r1, &k1, &p1 );
+          #pragma omp parallel num_threads(2)
+          {
+               #pragma omp single
+               {    if ( !omp_in_parallel( ) )
+                    {    std::cout << "could not start a parallel region"
+                              << std::endl;
+                         fails++;    }
+                    buildBigKHBVFromReads( K, reads, 2, &h2, &r2, &k2, &p2 );    }
+          }
+
+          if ( h1.N( ) != h2.N( ) || GraphSignature(h1) != GraphSignature(h2) )
+          {    std::cout << "graphs differ, trial " << trial << std::endl;
+               fails++;
+               continue;    }
+          for ( size_t i = 0; i < reads.size( ); i++ )
+          {    if ( PathSequence( h1, r1[i] ) != PathSequence( h2, r2[i] )
+                    || p1[i].KmerCount( ) != p2[i].KmerCount( ) )
+               {    std::cout << "paths differ, trial " << trial << ", read "
+                         << i << std::endl;
+                    fails++;
+                    break;    }    }    }
+     if ( fails > 0 ) return 1;
+     std::cout << "graphs and paths agree" << std::endl;
+     return 0;    }
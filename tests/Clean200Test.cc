@@ -0,0 +1,89 @@
+// Clean200Test: check the packed mismatch scoring used by Clean200x against
+// the base-by-base loops it replaced, for reads on both strands.
+
+#include "Basevector.h"
+#include "CoreTools.h"
+#include "paths/long/large/Clean200.h"
+#include "random/Random.h"
+
+namespace
+{
+
+basevector RandomBases( const int n, const basevector* like = NULL )
+{    basevector b(n);
+     for ( int i = 0; i < n; i++ )
+     {    // Copy most bases from like, to get reads that nearly match.
+          if ( like != NULL && i < like->isize( ) && randomx( ) % 10 != 0 )
+               b.Set( i, (*like)[i] );
+          else b.Set( i, randomx( ) % 4 );    }
+     return b;    }
+
+// The scores as Clean200x computed them before: ext is the extension, D the
+// number of extension positions scored, start the start of the read relative
+// to the extension.
+
+int OldForwardScore( const basevector& ext, const basevector& read,
+     const vec<int>& qv, const int D, const int start )
+{    int q = 0;
+     for ( int pos = 0; pos < D; pos++ )
+     {    int rpos = pos - start;
+          if ( rpos < 0 || rpos >= read.isize( ) ) continue;
+          if ( ext[pos] != read[rpos] ) q += qv[rpos];    }
+     return q;    }
+
+int OldReverseScore( const basevector& ext, const basevector& read,
+     const vec<int>& qv, const int D, const int start, const int K )
+{    basevector rext(ext);
+     rext.ReverseComplement( );
+     int s = rext.size( ), q = 0;
+     for ( int pos = 0; pos < D; pos++ )
+     {    int rpos = K - 2 - pos - start;
+          if ( rpos < 0 || rpos >= read.isize( ) ) continue;
+          if ( rext[s-pos-1] != read[rpos] ) q += qv[rpos];    }
+     return q;    }
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0;
+     for ( int it = 0; it < 20000; it++ )
+     {    const int K = 1 + randomx( ) % 200;
+          const int D = 1 + randomx( ) % 400;
+          const int L = 1 + randomx( ) % 300;
+          basevector ext = RandomBases(D);
+          const int start = (int) ( randomx( ) % ( D + L + 2*K ) ) - L - K;
+          basevector read;
+          if ( start >= 0 && start < D )
+          {    basevector tail( ext.begin( ) + start, ext.end( ) );
+               read = RandomBases( L, &tail );    }
+          else read = RandomBases(L);
+          vec<int> qv(L);
+          vec<unsigned char> q(L), rq(L);
+          for ( int i = 0; i < L; i++ )
+          {    q[i] = qv[i] = randomx( ) % 41;
+               rq[ L - 1 - i ] = q[i];    }
+
+          // The forward frame, as in Clean200x.
+
+          PackedBases pext(ext), pread(read);
+          int offset = start;
+          int lo = Max( 0, offset ), hi = Min( D, offset + L );
+          int newq = MismatchQualSum( pext, pread, &q[0], offset, lo, hi );
+          if ( newq != OldForwardScore( ext, read, qv, D, start ) )
+          {    std::cout << "forward score differs, case " << it << std::endl;
+               fails++;    }
+
+          // The reverse frame: the read is reverse complemented instead.
+
+          basevector rread(read);
+          rread.ReverseComplement( );
+          PackedBases prread(rread);
+          offset = -( L - K + 1 + start );
+          lo = Max( 0, offset ), hi = Min( D, offset + L );
+          newq = MismatchQualSum( pext, prread, &rq[0], offset, lo, hi );
+          if ( newq != OldReverseScore( ext, read, qv, D, start, K ) )
+          {    std::cout << "reverse score differs, case " << it << std::endl;
+               fails++;    }    }
+     if ( fails > 0 ) return 1;
+     std::cout << "all scores agree" << std::endl;
+     return 0;    }
@@ -0,0 +1,140 @@
+// DigraphTest: check the parallel digraph component and strongly connected
+// component code against the serial searches it replaced, on random graphs.
+
+#include "CoreTools.h"
+#include "Equiv.h"
+#include "graph/Digraph.h"
+#include "random/Random.h"
+
+namespace
+{
+
+// The serial depth-first search used before.
+
+void SerialComponents( const digraph& G, vec< vec<int> >& comp,
+     const vec<Bool>* invisible )
+{    comp.clear( );
+     vec<Bool> used( G.N( ), False );
+     if ( invisible != NULL ) used = *invisible;
+     vec<int> C, Cnext;
+     for ( int v = 0; v < G.N( ); v++ )
+     {    if ( used[v] ) continue;
+          C.clear( ), Cnext.clear( );
+          Cnext.push_back(v);
+          while( Cnext.nonempty( ) )
+          {    int w = Cnext.back( );
+               Cnext.pop_back( );
+               if ( used[w] ) continue;
+               used[w] = True;
+               C.push_back(w);
+               Cnext.append( G.From(w) );
+               Cnext.append( G.To(w) );    }
+          Sort(C);
+          comp.push_back(C);    }    }
+
+// The equiv_rel version of ComponentsAlt used before.
+
+void SerialComponentsAlt( const digraph& G, vec< vec<int> >& comp )
+{    comp.clear( );
+     equiv_rel e( G.N( ) );
+     for ( int v = 0; v < G.N( ); v++ )
+     {    for ( int j = 0; j < G.From(v).isize( ); j++ )
+               e.Join( v, G.From(v)[j] );    }
+     for ( int x = 0; x < G.N( ); x++ )
+     {    if ( e.Representative(x) )
+          {    vec<int> o;
+               e.Orbit( x, o );
+               Sort(o);
+               comp.push_back(o);    }    }    }
+
+// Serial Kosaraju: finish order on G, then search the reverse graph in
+// reverse finish order.  Output sorted, as StronglyConnectedComponents is.
+
+void SerialSCC( const digraph& G, vec< vec<int> >& SCCs )
+{    SCCs.clear( );
+     const int n = G.N( );
+     vec<Bool> seen( n, False );
+     vec<int> order, call_v, call_j;
+     for ( int s = 0; s < n; s++ )
+     {    if ( seen[s] ) continue;
+          seen[s] = True;
+          call_v.push_back(s), call_j.push_back(0);
+          while ( call_v.nonempty( ) )
+          {    int v = call_v.back( ), &j = call_j.back( );
+               if ( j < G.From(v).isize( ) )
+               {    int w = G.From(v)[j++];
+                    if ( !seen[w] )
+                    {    seen[w] = True;
+                         call_v.push_back(w), call_j.push_back(0);    }
+                    continue;    }
+               order.push_back(v);
+               call_v.pop_back( ), call_j.pop_back( );    }    }
+     vec<Bool> done( n, False );
+     for ( int i = n - 1; i >= 0; i-- )
+     {    int s = order[i];
+          if ( done[s] ) continue;
+          vec<int> scc, stack = {s};
+          done[s] = True;
+          while ( stack.nonempty( ) )
+          {    int v = stack.back( );
+               stack.pop_back( );
+               scc.push_back(v);
+               for ( int j = 0; j < G.To(v).isize( ); j++ )
+               {    int u = G.To(v)[j];
+                    if ( !done[u] )
+                    {    done[u] = True;
+                         stack.push_back(u);    }    }    }
+          Sort(scc);
+          SCCs.push_back(scc);    }
+     Sort(SCCs);    }
+
+digraph RandomGraph( const int n, const int m, const int cycle )
+{    vec< vec<int> > from(n), to(n);
+     auto add = [&]( int a, int b ) { from[a].push_back(b), to[b].push_back(a); };
+     for ( int i = 0; i < m; i++ )
+          add( randomx( ) % n, randomx( ) % n );
+
+     // Optionally thread a long cycle through the graph, so that the forward-
+     // backward search has a large strongly connected piece to split.
+
+     for ( int v = 0; v + 1 < cycle && v + 1 < n; v++ )
+          add( v, v + 1 );
+     if ( cycle > 1 && cycle <= n ) add( cycle - 1, 0 );
+     for ( int v = 0; v < n; v++ )
+          Sort( from[v] ), Sort( to[v] );
+     return digraph( from, to );    }
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0;
+     for ( int it = 0; it < 300; it++ )
+     {    const int n = 1 + randomx( ) % ( it < 200 ? 50 : 30000 );
+          const int m = randomx( ) % ( 2*n + 1 );
+          const int cycle = ( it % 3 == 0 ? n / 2 : 0 );
+          digraph G = RandomGraph( n, m, cycle );
+          vec< vec<int> > a, b;
+          G.StronglyConnectedComponents(a), SerialSCC( G, b );
+          if ( a != b )
+          {    std::cout << "StronglyConnectedComponents differs, graph "
+                    << it << std::endl;
+               fails++;    }
+          G.Components(a), SerialComponents( G, b, NULL );
+          if ( a != b )
+          {    std::cout << "Components differs, graph " << it << std::endl;
+               fails++;    }
+          vec<Bool> invisible(n);
+          for ( int v = 0; v < n; v++ )
+               invisible[v] = ( randomx( ) % 5 == 0 );
+          G.Components( a, &invisible ), SerialComponents( G, b, &invisible );
+          if ( a != b )
+          {    std::cout << "Components with invisible differs, graph "
+                    << it << std::endl;
+               fails++;    }
+          G.ComponentsAlt(a), SerialComponentsAlt( G, b );
+          if ( a != b )
+          {    std::cout << "ComponentsAlt differs, graph " << it << std::endl;
+               fails++;    }    }
+     if ( fails > 0 ) return 1;
+     std::cout << "all graphs agree" << std::endl;
+     return 0;    }
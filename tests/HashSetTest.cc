@@ -0,0 +1,100 @@
+// HashSetTest: check the parallel bulk insertion of HashSet against inserting
+// the same values one at a time from one thread, as the dictionaries used to
+// be filled, including when the set starts too small and has to split.
+
+#include "CoreTools.h"
+#include "feudal/HashSet.h"
+#include "random/Random.h"
+
+namespace
+{
+
+struct Hasher
+{    typedef size_t argument_type;
+     size_t operator()( const size_t x ) const
+     {    return x * 0x9E3779B97F4A7C15ul;    }    };
+
+typedef HashSet<size_t,Hasher> Set;
+
+// The values of a hash set, sorted.
+
+vec<size_t> Contents( const Set& s )
+{    vec<size_t> v;
+     for ( const auto& hhs : s )
+     for ( auto x : hhs )
+          v.push_back(x);
+     Sort(v);
+     return v;    }
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0;
+     vec<size_t> keys;
+     for ( int i = 0; i < 2000000; i++ )
+          keys.push_back( ( size_t(randomx( )) << 32 ) ^ randomx( ) );
+     UniqueSort(keys);
+     auto keep = [&keys]( const size_t idx ) { return keys[idx] % 3 != 0; };
+
+     for ( size_t cap : { keys.size( ), keys.size( ) / 50 } )
+     for ( size_t blockSize : { 1ul << 22, 1000ul } )
+     {    Set oldSet(cap);
+          for ( size_t i = 0; i < keys.size( ); i++ )
+               if ( keep(i) ) oldSet.insertUniqueValueNoLocking( keys[i] );
+          Set set(cap);
+          set.insertUniqueValues( keys.size( ),
+               [&keys,&keep]( const size_t idx, size_t& val )
+               {    val = keys[idx];
+                    return keep(idx);    }, blockSize );
+          if ( Contents(set) != Contents(oldSet) || set.size( ) != oldSet.size( ) )
+          {    std::cout << "contents differ, capacity " << cap << ", blocks of "
+                    << blockSize << std::endl;
+               fails++;    }
+          if ( set.validateBinAssignments( ) != 0 )
+          {    std::cout << "values in the wrong inner set, capacity " << cap
+                    << std::endl;
+               fails++;    }
+          for ( size_t i = 0; i < keys.size( ); i++ )
+          {    if ( bool( set.lookup( keys[i] ) ) != keep(i) )
+               {    std::cout << "lookup wrong, capacity " << cap << std::endl;
+                    fails++;
+                    break;    }    }    }
+
+     // As step 2 of the contigger does it:  the values are made in a parallel
+     // region, and inserted after it, by all the threads.  Inserting from
+     // inside the region, where a nested one gets one thread, must still work.
+
+     omp_set_num_threads(4);
+     vec<size_t> made;
+     #pragma omp parallel
+     {
+          #pragma omp single
+          made = keys;
+     }
+     vec<Bool> inserted( omp_get_max_threads( ), False );
+     Set set( made.size( ) );
+     set.insertUniqueValues( made.size( ),
+          [&made,&inserted]( const size_t idx, size_t& val )
+          {    inserted[ omp_get_thread_num( ) ] = True;
+               val = made[idx];
+               return true;    } );
+     const int nInserting = std::count( inserted.begin( ), inserted.end( ), True );
+     if ( nInserting < 4 )
+     {    std::cout << "only " << nInserting << " threads inserted" << std::endl;
+          fails++;    }
+     Set nested( made.size( ) );
+     #pragma omp parallel
+     {
+          #pragma omp single
+          nested.insertUniqueValues( made.size( ),
+               [&made]( const size_t idx, size_t& val )
+               {    val = made[idx];
+                    return true;    } );
+     }
+     if ( Contents(set) != made || Contents(nested) != made )
+     {    std::cout << "contents differ when made in a parallel region"
+               << std::endl;
+          fails++;    }
+     if ( fails > 0 ) return 1;
+     std::cout << "bulk insertion agrees" << std::endl;
+     return 0;    }
@@ -0,0 +1,106 @@
+// HugePagesTest: check that asking for huge pages either takes effect or
+// falls back, and that hash sets, HugeBVecs and feudal containers hold the
+// same things on huge pages as on small ones, and as they did with the old
+// new[]-based hash set factory.
+
+#include "Basevector.h"
+#include "CoreTools.h"
+#include "feudal/HashSet.h"
+#include "feudal/HugeBVec.h"
+#include "random/Random.h"
+#include "system/HugePages.h"
+
+namespace
+{
+
+// The hash set factory as it was, allocating with new[].
+
+template <class T>
+class OldTFactory
+{
+public:
+    template <class X>
+    std::allocator<X> alloc(X*) const { return std::allocator<X>(); }
+
+    T* create( size_t nTs ) const { return new T[nTs]; }
+    void destroy( T* pTs, size_t nTs ) const { delete [] pTs; }
+};
+
+struct Hasher
+{    typedef size_t argument_type;
+     size_t operator()( const size_t x ) const
+     {    return x * 0x9E3779B97F4A7C15ul;    }    };
+
+// The values of a hash set, sorted.
+
+template <class S> vec<size_t> Contents( const S& s )
+{    vec<size_t> v;
+     for ( const auto& hhs : s )
+     for ( auto x : hhs )
+          v.push_back(x);
+     Sort(v);
+     return v;    }
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0;
+     if ( HugePages::enable(false) || HugePages::enabled( ) )
+     {    std::cout << "can't turn huge pages off" << std::endl;
+          fails++;    }
+     vec<size_t> keys;
+     for ( int i = 0; i < 3000000; i++ )
+          keys.push_back( ( size_t(randomx( )) << 32 ) ^ randomx( ) );
+     HashSet< size_t, Hasher, std::equal_to<size_t>, OldTFactory<size_t> >
+          oldSet( keys.size( ) );
+     for ( auto k : keys ) oldSet.add(k);
+     const vec<size_t> expect = Contents(oldSet);
+     const vecbvec reads = vecbvec( 1, bvec( 40000000 ) );
+     for ( Bool on : { False, True } )
+     {    const bool got = HugePages::enable(on);
+          if ( got && !on )
+          {    std::cout << "huge pages on when asked not to be" << std::endl;
+               fails++;    }
+          std::cout << "huge pages " << ( got ? "on" : "off" ) << std::endl;
+          const size_t advised = HugePages::advisedBytes( );
+
+          // A hash set big enough for its inner tables to change size on huge
+          // pages, and a single table big enough to be advised.
+
+          HashSet<size_t,Hasher> set( keys.size( ) );
+          for ( auto k : keys ) set.add(k);
+          if ( Contents(set) != expect )
+          {    std::cout << "hash sets differ" << std::endl;
+               fails++;    }
+          HopscotchHashSet<size_t,Hasher> table( 1 << 21 );
+          for ( int i = 0; i < 1000000; i++ ) table.add( keys[i] );
+          for ( int i = 0; i < 1000000; i++ )
+          {    if ( !table.lookup( keys[i] ) || table.lookup( keys[i] + 1 ) )
+               {    std::cout << "hopscotch table lookup wrong" << std::endl;
+                    fails++;
+                    break;    }    }
+
+          // A big HugeBVec and a big feudal copy.
+
+          HugeBVec hbv( 30000000 );
+          for ( size_t i = 0; i < hbv.size( ); i++ )
+               hbv.set( i, i % 7 % 4 );
+          for ( size_t i = 0; i < hbv.size( ); i++ )
+          {    if ( hbv[i] != i % 7 % 4 )
+               {    std::cout << "HugeBVec broken" << std::endl;
+                    fails++;
+                    break;    }    }
+          vecbvec copy( reads.begin( ), reads.end( ) );
+          if ( copy != reads )
+          {    std::cout << "feudal copy differs" << std::endl;
+               fails++;    }
+          if ( got != ( HugePages::advisedBytes( ) > advised ) )
+          {    std::cout << "advised " << HugePages::advisedBytes( ) - advised
+                    << " bytes with huge pages " << ( got ? "on" : "off" )
+                    << std::endl;
+               fails++;    }
+          std::cout << "on huge pages: " << HugePages::backedBytes( )
+               << " bytes" << std::endl;    }
+     if ( fails > 0 ) return 1;
+     std::cout << "huge pages behave" << std::endl;
+     return 0;    }
@@ -0,0 +1,108 @@
+// KMerRollerTest: check that rolling along a read gives the same kmers, reverse
+// complements and canonical forms as building each kmer from scratch, and that
+// batched dictionary lookups agree with looking up one kmer at a time.
+
+#include "Basevector.h"
+#include "CoreTools.h"
+#include "kmers/KMer.h"
+#include "kmers/ReadPather.h"
+#include "random/Random.h"
+
+namespace
+{
+
+bvec RandomRead( const int len )
+{    bvec b(len);
+     for ( int j = 0; j < len; j++ )
+          b.Set( j, randomx( ) % 4 );
+     return b;    }
+
+typedef bvec::const_iterator Itr;
+
+template <unsigned K> int CheckRoller( const vecbvec& reads )
+{    int fails = 0;
+     for ( const bvec& r : reads )
+     {    std::vector< KMer<K> > kmers;
+          KMer<K>::kmerize( r.begin( ), r.end( ), std::back_inserter(kmers) );
+          size_t n = 0;
+          for ( KMerRoller<K,Itr> roller( r.begin( ), r.end( ) ); roller;
+               ++roller, ++n )
+          {    KMer<K> fwd( r.begin( ) + n );
+               KMer<K> rc(fwd);
+               rc.rc( );
+               const bool rev = fwd.getCanonicalForm( ) == CanonicalForm::REV;
+               if ( roller.getOffset( ) != n || roller.getFwd( ) != fwd
+                    || roller.getRC( ) != rc || roller.isRev( ) != rev
+                    || roller.getCanonical( ) != ( rev ? rc : fwd )
+                    || n >= kmers.size( ) || kmers[n] != ( rev ? rc : fwd ) )
+               {    std::cout << "K=" << K << ": kmer " << n << " of a read of "
+                         << r.size( ) << " bases differs" << std::endl;
+                    return 1;    }    }
+          if ( n != ( r.size( ) < K ? 0 : r.size( ) - K + 1 )
+               || kmers.size( ) != n )
+          {    std::cout << "K=" << K << ": " << n << " kmers in a read of "
+                    << r.size( ) << " bases" << std::endl;
+               fails++;    }    }
+     return fails;    }
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0;
+     vecbvec reads;
+     for ( int len = 0; len <= 300; len++ )
+          reads.push_back( RandomRead(len) );
+     for ( int i = 0; i < 20; i++ )
+     {    bvec b = RandomRead(30);
+          bvec pal(b);
+          pal.ReverseComplement( );
+          b.append( pal.begin( ), pal.end( ) );
+          reads.push_back(b);    }
+     fails += CheckRoller<29>(reads);
+     fails += CheckRoller<32>(reads);
+     fails += CheckRoller<60>(reads);
+     fails += CheckRoller<101>(reads);
+     fails += CheckRoller<200>(reads);
+
+     // A dictionary holding about half the kmers of some reads.
+
+     const unsigned K = 60;
+     KmerDict<K> dict( 100000 );
+     for ( const bvec& r : reads )
+     for ( KMerRoller<K,Itr> roller( r.begin( ), r.end( ) ); roller; ++roller )
+          if ( randomx( ) % 2 ) dict.insertCanonical( roller.getCanonical( ) );
+     for ( const bvec& r : reads )
+     {    std::vector<const KmerDict<K>::Entry*> expect, got;
+          vec<Bool> revs;
+          for ( int j = 0; j + int(K) <= r.isize( ); j++ )
+          {    KMer<K> kmer( r.begin( ) + j );
+               expect.push_back( dict.findEntry(kmer) );
+               revs.push_back( kmer.getCanonicalForm( ) == CanonicalForm::REV );    }
+          size_t n = 0;
+          dict.findEntries( r.begin( ), r.end( ),
+               [&]( const KmerDict<K>::Entry* pEnt, bool rev )
+               {    got.push_back(pEnt);
+                    if ( rev != revs[n++] ) fails++;
+                    return true;    } );
+          if ( got != expect )
+          {    std::cout << "batched lookups differ for a read of " << r.size( )
+                    << " bases" << std::endl;
+               fails++;    }
+
+          // Stopping at the first hit.
+
+          size_t calls = 0;
+          dict.findEntries( r.begin( ), r.end( ),
+               [&]( const KmerDict<K>::Entry* pEnt, bool )
+               {    calls++;
+                    return !pEnt;    } );
+          auto hit = std::find_if( expect.begin( ), expect.end( ),
+               []( const KmerDict<K>::Entry* p ) { return p != 0; } );
+          size_t want = hit == expect.end( ) ? expect.size( )
+               : hit - expect.begin( ) + 1;
+          if ( calls != want )
+          {    std::cout << "didn't stop at the first hit" << std::endl;
+               fails++;    }    }
+     if ( fails > 0 ) return 1;
+     std::cout << "rolled kmers and batched lookups agree" << std::endl;
+     return 0;    }
@@ -0,0 +1,69 @@
+// KMerTest: dispatch to every K in the BigK table, and check there that the
+// word-at-a-time reverse complement and canonicalization of KMer agree with
+// doing it base by base, and with canonicalizing as it was done before.
+
+#include "CoreTools.h"
+#include "kmers/KMer.h"
+#include "paths/long/LargeKDispatcher.h"
+#include "random/Random.h"
+
+namespace
+{
+
+typedef std::vector<unsigned char> Bases;
+
+Bases RandomBases( const int n )
+{    Bases b(n);
+     for ( auto& x : b ) x = randomx( ) % 4;
+     return b;    }
+
+Bases RC( const Bases& b )
+{    Bases r( b.rbegin( ), b.rend( ) );
+     for ( auto& x : r ) x ^= 3;
+     return r;    }
+
+template <int K> struct CheckK
+{    void operator()( const int k, int& dispatched, int& fails )
+     {    dispatched = K;
+          for ( int it = 0; it < 20; it++ )
+          {    Bases b = RandomBases(K);
+               // every fourth even kmer is a palindrome
+               if ( K % 2 == 0 && it % 4 == 0 )
+               {    Bases r = RC(b);
+                    std::copy( r.begin( ) + K/2, r.end( ), b.begin( ) + K/2 );    }
+               KMer<K> kmer( b.begin( ) );
+               KMer<K> krc(kmer);
+               krc.rc( );
+               if ( krc != KMer<K>( RC(b).begin( ) ) )
+               {    std::cout << "rc wrong for K=" << K << std::endl;
+                    fails++;
+                    return;    }
+               KMer<K> old(kmer);
+               CanonicalForm oldForm = old.getCanonicalForm( );
+               if ( oldForm == CanonicalForm::REV ) old = krc;
+               KMer<K> canon(kmer);
+               if ( canon.canonicalize( ) != oldForm || canon != old )
+               {    std::cout << "canonicalization wrong for K=" << K
+                         << std::endl;
+                    fails++;
+                    return;    }    }    }    };
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0, n = 0;
+     for ( auto itr = BigK::begin( ); itr != BigK::end( ); ++itr, ++n )
+     {    int dispatched = -1;
+          BigK::dispatch<CheckK>( *itr, *itr, dispatched, fails );
+          if ( dispatched != *itr )
+          {    std::cout << "K=" << *itr << " dispatched to " << dispatched
+                    << std::endl;
+               fails++;    }    }
+     vec<unsigned> big = BigK::values( 200, 400 );
+     if ( big.empty( ) || big.front( ) != 200 || big.back( ) != 400 )
+     {    std::cout << "values out of range" << std::endl;
+          fails++;    }
+     if ( fails > 0 ) return 1;
+     std::cout << "all " << n << " K values dispatch, and kmers agree"
+          << std::endl;
+     return 0;    }
@@ -0,0 +1,586 @@
+// LinesTest: check the component-parallel FindLines (and the FindSomeCells it
+// shares components with) against the serial pass it replaced, on random graphs
+// made of chains of bubbles, cells and gaps together with their reverse
+// complements.  Then check that GFADump writes the same files whether it finds
+// the lines itself or is handed the lines FindLines or FinalFiles returned.
+
+#include <omp.h>
+#include "CoreTools.h"
+#include "Intvector.h"
+#include "ParallelVecUtilities.h"
+#include "VecUtilities.h"
+#include "graph/FindCells.h"
+#include "paths/HyperBasevector.h"
+#include "paths/long/ReadPath.h"
+#include "paths/long/large/FinalFiles.h"
+#include "paths/long/large/Lines.h"
+#include "GFADump.h"
+#include "random/Random.h"
+#include "system/SortInPlace.h"
+
+namespace
+{
+
+// The serial FindSomeCells and FindLines used before.
+
+void OldFindSomeCells( const digraph& G, const int max_cell_size,
+     const int max_depth, vec< std::pair<int,int> >& bounds )
+{
+     bounds.clear( );
+     #pragma omp parallel for
+     for ( int v = 0; v < G.N( ); v++ )
+     {    
+          // Consider only canonical cell entry vertices v.
+
+          if ( !G.To(v).solo( ) || G.From(v).size( ) <= 1 ) continue;
+          if ( Member( G.From(v), v ) ) continue;
+          
+          // Find vertices a bit downstream of the immediate successors of v.
+
+          int no = G.From(v).size( );
+          vec<vec<int>> down(no), downd(no);
+          for ( int j = 0; j < no; j++ )
+          {    down[j].push_back( G.From(v)[j] );
+               downd[j].push_back(0);
+               for ( int i = 0; i < down[j].isize( ); i++ )
+               {    if ( downd[j][i] == max_depth ) break;
+                    for ( int l = 0; l < G.From( down[j][i] ).isize( ); l++ )
+                    {    int w = G.From( down[j][i] )[l], d = downd[j][i] + 1;
+                         int p = Position( down[j], w );
+                         if ( p < 0 || downd[j][p] > d )
+                         {    down[j].push_back(w);
+                              downd[j].push_back(d);    }    }    }
+               UniqueSort( down[j] );    }
+
+          // Find candidates for canonical cell exit vertices w.
+
+          vec<int> ex;
+          Intersection( down, ex );
+          vec<Bool> to_del( ex.size( ), True );
+          for ( int i = 0; i < ex.isize( ); i++ )
+          {    int w = ex[i];
+               if ( !G.From(w).solo( ) || G.To(w).size( ) <= 1 ) continue;
+               if ( Member( G.To(w), w ) ) continue;
+               to_del[i] = False;    }
+          EraseIf( ex, to_del );
+
+          // Test candidates.
+
+          vec<int> ex2;
+          vec<vec<int>> xs;
+          for ( int i = 0; i < ex.isize( ); i++ )
+          {    int w = ex[i];
+
+               // Check for bounding of cell by v..w, and check cell size.
+
+               vec<int> x = {v};
+               Bool bad = False;
+               for ( int j = 0; j < x.isize( ); j++ )
+               {    if ( x.isize( ) > max_cell_size || G.From( x[j] ).empty( )
+                         || G.To( x[j] ).empty( ) )
+                    {    bad = True;
+                         break;    }
+                    if ( x[j] != w )
+                    {    for ( int l = 0; l < G.From( x[j] ).isize( ); l++ )
+                         {    int t = G.From( x[j] )[l];
+                              if ( t == v )
+                              {    bad = True;
+                                   break;    }
+                              if ( !Member( x, t ) ) x.push_back(t);    }    }
+                    if ( x[j] != v )
+                    {    for ( int l = 0; l < G.To( x[j] ).isize( ); l++ )
+                         {    int t = G.To( x[j] )[l];
+                              if ( t == w )
+                              {    bad = True;
+                                   break;    }
+                              if ( !Member( x, t ) ) x.push_back(t);    }    }    }
+               if ( bad || x.isize( ) > max_cell_size ) continue;
+
+               // Check for cycles.
+
+               for ( int j = 0; j < x.isize( ); j++ )
+               {    if (bad) break;
+                    if ( x[j] == w ) continue;
+                    vec<int> m = { x[j] };
+                    for ( int l = 0; l < m.isize( ); l++ )
+                    {    if (bad) break;
+                         for ( int r = 0; r < G.From( m[l] ).isize( ); r++ )
+                         {    int z = G.From( m[l] )[r];
+                              if ( z == x[j] )
+                              {    bad = True;
+                                   break;    }
+                              if ( z == w ) continue;
+                              if ( !Member( m, z ) ) m.push_back(z);    }    }    }
+               if (bad) continue;
+               xs.push_back(x);
+               ex2.push_back(w);    }
+
+          // Pick smallest.
+
+          if ( ex2.empty( ) ) continue;
+          vec<int> len( xs.size( ) ), ids( xs.size( ), vec<int>::IDENTITY );
+          for ( int i = 0; i < xs.isize( ); i++ )
+               len[i] = xs[i].size( );
+          SortSync( len, ids );
+          if ( ex2.size( ) >= 2 && len[0] == len[1] ) continue; // possible???
+          int w = ex2[ ids[0] ];
+          #pragma omp critical
+          {    bounds.push( v, w );    }    }
+     Sort(bounds);    }
+
+void OldFindLines( const HyperBasevector& hb, const vec<int>& inv,
+     vec<vec<vec<vec<int>>>>& lines, const int64_t max_cell_paths, const int max_depth )
+{    vec<int> to_left, to_right;
+     hb.ToLeft(to_left), hb.ToRight(to_right);
+
+     // Heuristics.
+
+     const int verts_mul = 2;
+
+     // Find some cells.  These do not include standard bubbles.
+
+     vec<vec<vec<int>>> xpaths;
+     vec< std::pair<int,int> > bounds;
+     {    int max_cell_verts = verts_mul * max_cell_paths;
+          vec< std::pair<int,int> > bounds0;
+          // std::cout << Date( ) << ": finding cells" << std::endl;
+          OldFindSomeCells( hb, max_cell_verts, max_depth, bounds0 );
+
+          // Symmetrize cells.
+
+          // std::cout << Date( ) << ": symmetrizing cells" << std::endl;
+          int nb = bounds0.size( );     
+          for ( int i = 0; i < nb; i++ )
+          {    int v = bounds0[i].first, w = bounds0[i].second;
+               int rv = to_right[ inv[ hb.IFrom(v,0) ] ];
+               int rw = to_left[ inv[ hb.ITo(w,0) ] ];
+               bounds0.push( rw, rv );    }
+          ParallelUniqueSort(bounds0);
+
+          // Find paths across cells.
+
+          xpaths.resize( bounds0.size( ) ); 
+          bounds = bounds0;
+          vec<Bool> xdel( xpaths.size( ), False );
+          #pragma omp parallel for
+          for ( int i = 0; i < bounds0.isize( ); i++ )
+          {    int v = bounds0[i].first, w = bounds0[i].second;
+               Bool OK = hb.EdgePaths( to_left, to_right, v, w, xpaths[i], -1, 
+                    max_cell_paths );
+               int64_t nxpaths = xpaths[i].size( );
+               if ( !OK || nxpaths > max_cell_paths ) xdel[i] = True;    }
+          EraseIf( xpaths, xdel ), EraseIf( bounds, xdel );    }
+
+     // Remove subset cells.
+
+     int nobj = hb.EdgeObjectCount( );
+     vec<Bool> used;
+     hb.Used(used);
+     VecIntVec contents( bounds.size( ) );
+     IntVec e;
+     for ( int i = 0; i < bounds.isize( ); i++ )
+     {    int v = bounds[i].first, w = bounds[i].second;
+          e.clear();
+          e.push_back(hb.IFrom(v,0)).push_back(hb.ITo(w,0));
+          for ( int64_t j = 0; j < xpaths[i].isize( ); j++ )
+            for ( int64_t k = 0; k < xpaths[i][j].isize( ); k++ )
+               e.push_back( xpaths[i][j][k] );
+          std::sort(e.begin(),e.end());
+          e.erase(std::unique(e.begin(),e.end()),e.end());
+          contents[i] = e;    }
+     VecIntVec cell_index;
+     invert(contents,cell_index,hb.EdgeObjectCount());
+     vec<Bool> xdel2( bounds.size( ), False );
+     for ( int e = 0; e < hb.EdgeObjectCount( ); e++ )
+     for ( unsigned j1 = 0; j1 < cell_index[e].size( ); j1++ )
+     {    int c1 = cell_index[e][j1];
+          if ( xdel2[c1] ) continue;
+          for ( unsigned j2 = 0; j2 < cell_index[e].size( ); j2++ )
+          {    if ( j1 == j2 ) continue;
+               int c2 = cell_index[e][j2];
+               if ( xdel2[c2] ) continue;
+               if ( bounds[j1].second == bounds[j2].first ) continue;
+               if ( bounds[j2].second == bounds[j1].first ) continue;
+               if ( contents[c1].size( ) >= contents[c2].size( ) ) continue;
+               if ( BinSubset( contents[c1], contents[c2] ) )
+                    xdel2[c1] = True;    }    }
+     cell_index.clear();
+     EraseIf( bounds, xdel2 );
+     EraseIf( xpaths, xdel2 );
+
+     // Add in gaps.
+
+     //vec<vec<int>> with a single empty element.
+     vec<vec<int>> x(1);
+     for ( int e = 0; e < nobj; e++ )
+     {    int v = to_right[e];
+          if ( !hb.To(v).solo( ) || !hb.From(v).solo( ) ) continue;
+          int f = hb.IFrom( v, 0 ), w = hb.From(v)[0];
+          if ( hb.EdgeLengthBases(f) != 0 ) continue;
+          if ( !hb.To(w).solo( ) || !hb.From(w).solo( ) ) continue;
+          bounds.push( v, w );
+          xpaths.push_back(x);    }
+
+     // Index bounds.
+
+     ParallelSortSync( bounds, xpaths );
+     vec< vec<int> > left_ind( hb.N( ) ), right_ind( hb.N( ) );
+     for ( int i = 0; i < bounds.isize( ); i++ )
+     {    left_ind[ bounds[i].first ].push_back(i);
+          right_ind[ bounds[i].second ].push_back(i);    }
+
+     // Please edge indices in order by length, largest first.
+
+     vec<int> ids( nobj, vec<int>::IDENTITY );
+     std::sort(ids.begin(),ids.end(),
+             [&hb](int i1,int i2)
+             {return hb.EdgeObject(i1).size()>hb.EdgeObject(i2).size();});
+
+     // Go through the edges and build lines.
+
+     vec<Bool> marked( nobj, False );
+     lines.clear( );
+     // #pragma omp parallel for // seems unsafe and doesn't save time
+     for ( int ie = 0; ie < nobj; ie++ )
+     {    int e = ids[ie];
+          if ( hb.EdgeLengthBases(e) == 0 ) continue;
+          if ( !used[e] ) continue;
+          if ( marked[e] ) continue;
+          marked[e] = True;
+
+          // Build line, extending first to the left, then to the right.
+
+          vec< vec< vec<int> > > line = {{{e}}};
+          Bool circle = False;
+          while(1)
+          {    int w = to_left[ line.front( )[0][0] ];
+               if ( !hb.From(w).solo( ) || !right_ind[w].solo( ) ) break;
+               int bid = right_ind[w][0];
+               int v = bounds[bid].first;
+               line.push_front( xpaths[bid] );
+               int eb = hb.ITo(v, 0);
+               line.push_front( {{eb}} );
+               marked[eb] = True;
+               for ( int64_t i = 0; i < xpaths[bid].isize( ); i++ )
+               for ( int64_t j = 0; j < xpaths[bid][i].isize( ); j++ )
+                    marked[ xpaths[bid][i][j] ] = True;
+               if ( eb == e ) 
+               {    circle = True;
+                    break;     }    }
+          if ( !circle )
+          {    while(1)
+               {    int v = to_right[ line.back( )[0][0] ];
+                    if ( !hb.To(v).solo( ) || !left_ind[v].solo( ) ) break;
+                    int bid = left_ind[v][0];
+                    int w = bounds[bid].second;
+                    int eb = hb.IFrom(w, 0);
+                    line.push_back( xpaths[bid], {{eb}} );
+                    if ( eb == e ) std::cout << "CIRCLE!" << std::endl;
+                    marked[eb] = True;
+                    for ( int64_t i = 0; i < xpaths[bid].isize( ); i++ )
+                    for ( int64_t j = 0; j < xpaths[bid][i].isize( ); j++ )
+                         marked[ xpaths[bid][i][j] ] = True;    }    }
+
+          // Generate reverse complement of line.
+
+          vec< vec< vec<int> > > liner(line);
+          liner.ReverseMe( );
+          for ( int64_t i = 0; i < liner.isize( ); i++ )
+          for ( int64_t j = 0; j < liner[i].isize( ); j++ )
+          {    liner[i][j].ReverseMe( );
+               for ( int64_t k = 0; k < liner[i][j].isize( ); k++ )
+                    liner[i][j][k] = inv[ liner[i][j][k] ];    }
+
+          // Save.
+
+          #pragma omp critical
+          {    lines.push_back( line, liner );    }    }
+
+     // Order paths.
+
+     #pragma omp parallel for
+     for ( int64_t i = 0; i < lines.isize( ); i++ )
+     {    for ( int64_t j = 0; j < lines[i].isize( ); j++ )
+               Sort( lines[i][j] );    }
+
+     // Remove lines having identical content.
+
+     sortInPlaceParallel(lines.begin(),lines.end());
+     Unique(lines);
+     size_t nLines = lines.size();
+     contents.clear().resize(nLines);
+     #pragma omp parallel for
+     for ( size_t i = 0; i < nLines; i++ )
+     {   vec<vec<vec<int>>> const& vvv = lines[i];
+         size_t res = 0;
+         for ( vec<vec<int>> const& vv : vvv )
+             for ( vec<int> const& v : vv )
+                 res += v.size();
+         IntVec iv;
+         iv.reserve(res);
+         for ( vec<vec<int>> const& vv : vvv )
+             for ( vec<int> const& v : vv )
+                 for ( int e : v )
+                     iv.push_back(e);
+         std::sort(iv.begin(),iv.end());
+         iv.erase(std::unique(iv.begin(),iv.end()),iv.end());
+         contents[i] = iv;
+     }
+
+     vec<int> ids2( nLines, vec<int>::IDENTITY );
+     ParallelSort( ids2,
+                 [&contents](int i1,int i2){return contents[i1]<contents[i2];});
+
+     vec<Bool> to_delete1( nLines, False );
+     for ( size_t i = 0; i != nLines; i++ )
+     {    int m = ids2[i];
+          IntVec const& probe = contents[m];
+          size_t j;
+          for ( j = i + 1; j != nLines; j++ )
+               if ( contents[ids2[j]] != probe ) break;
+          for ( size_t k = i+1; k != j; k++ )
+               m = std::min( m, ids2[k] );
+          for ( size_t k = i; k != j; k++ )
+               if ( ids2[k] != m ) to_delete1[ ids2[k] ] = True;
+          i = j - 1; }
+
+     EraseIf( lines, to_delete1 );
+
+     // Define line lengths in such a way that a subset line will have a smaller
+     // length.
+
+     vec<int> llen( lines.size( ), 0 );
+     // OLD DEFINITION
+     // FAILED ON SHOWING THAT
+     // 9545651 {{}} 8965780 {{}} 8965779 {{}} 9545652
+     // IS A SUBSET OF 
+     // 2820324 {{2820325},{2820326}} 2820327 {{2820328,11158223,2820323},
+     // {9545651,11194873,8965780,11187223,8965779,11187222,9545652}} 2820324
+     // THIS IS BECAUSE OF THE HETEROGENEOUS WAY WE HANDLE GAPS.
+     // for ( int i = 0; i < lines.isize( ); i++ )
+     // for ( int j = 0; j < lines[i].isize( ); j++ )
+     //      llen[i] += lines[i][j].size( );
+     // WAS IN GapToy.HG03642
+     // NEW DEFINITION
+     for ( int i = 0; i < lines.isize( ); i++ )
+     for ( int j = 0; j < lines[i].isize( ); j++ )
+     for ( int k = 0; k < lines[i][j].isize( ); k++ )
+          llen[i] += lines[i][j][k].size( );
+
+     // Remove subset lines.
+
+     ParallelReverseSortSync( llen, lines );
+     vec<Bool> to_delete( lines.size( ), False );
+     vec< vec<int> > lines_index(nobj);
+     for ( int i = 0; i < lines.isize( ); i++ )
+     for ( int j = 0; j < lines[i].isize( ); j++ )
+     for ( int k = 0; k < lines[i][j].isize( ); k++ )
+     for ( int l = 0; l < lines[i][j][k].isize( ); l++ )
+     {    int e = lines[i][j][k][l];
+          if ( lines_index[e].nonempty( ) && lines_index[e][0] == i ) continue;
+          lines_index[e].push_back(i);    }
+     for ( int e = 0; e < nobj; e++ )
+     {    if ( lines_index[e].size( ) > 1 )
+          {    
+               // XXX:
+               if ( llen[ lines_index[e][0] ] == llen[ lines_index[e][1] ] )
+               {    std::cout << "\nconflicting lines:\n";
+                    for ( int j = 0; j < 2; j++ )
+                    {    const vec<vec<vec<int>>>& line = lines[ lines_index[e][j] ];
+                         std::cout << "\n";
+                         for ( int i = 0; i < line.isize( ); i++ )
+                         {    if ( i > 0 ) std::cout << " ";
+                              if ( i % 2 == 0 ) std::cout << line[i][0][0];
+                              else
+                              {    std::cout << "{";
+                                   for ( int j = 0; j < line[i].isize( ); j++ )
+                                   {    if ( j > 0 ) std::cout << ",";
+                                        std::cout << "{" << printSeq( line[i][j] ) 
+                                             << "}";    }
+                                   std::cout << "}";    }    }
+                         std::cout << "\n";    }    }
+               ForceAssertGt( llen[ lines_index[e][0] ], llen[ lines_index[e][1] ] );
+
+               for ( int j = 1; j < lines_index[e].isize( ); j++ )
+                    to_delete[ lines_index[e][j] ] = True;    }    }
+     EraseIf( lines, to_delete );    }
+
+
+// An edge of a graph under construction.
+
+struct ProtoEdge
+{    int v, w;
+     bvec b;
+     int rc;    };
+
+bvec RandomBases( const int n )
+{    bvec b(n);
+     for ( int j = 0; j < n; j++ )
+          b.Set( j, randomx( ) % 4 );
+     return b;    }
+
+bvec RC( const bvec& b )
+{    bvec r(b);
+     r.ReverseComplement( );
+     return r;    }
+
+// Lay down one strand of a component, starting at vertex v: edges joined by
+// bubbles, cells with and without nested bubbles, and gaps.  Returns the vertex
+// the strand ends at.
+
+int AddStrand( vec<ProtoEdge>& edges, int& nv, int v, const int K )
+{    auto edge = [&]( const int x, const int y )
+     {    edges.push_back( ProtoEdge{ x, y, RandomBases( K + randomx( ) % 1000 ),
+               -1 } );    };
+     int ngadgets = randomx( ) % 6;
+     for ( int g = 0; g < ngadgets; g++ )
+     {    int w = nv++;
+          edge( v, w );
+          v = w;
+          switch ( randomx( ) % 5 )
+          {    case 0: // nothing: two edges in a row
+                    break;
+               case 1: // bubble with two or three branches
+               {    w = nv++;
+                    int nb = 2 + randomx( ) % 2;
+                    for ( int j = 0; j < nb; j++ )
+                         edge( v, w );
+                    v = w;
+                    break;    }
+               case 2: // cell v -> a -> b -> w, with shortcuts
+               {    int a = nv++, b = nv++;
+                    w = nv++;
+                    edge( v, a ), edge( v, b ), edge( a, b );
+                    edge( a, w ), edge( b, w );
+                    v = w;
+                    break;    }
+               case 3: // cell containing a bubble
+               {    int a = nv++;
+                    w = nv++;
+                    edge( v, a ), edge( v, w ), edge( a, w ), edge( a, w );
+                    v = w;
+                    break;    }
+               case 4: // gap
+               {    w = nv++;
+                    edges.push_back( ProtoEdge{ v, w, bvec( ), -1 } );
+                    v = w;
+                    break;    }    }    }
+     int w = nv++;
+     edge( v, w );
+     return w;    }
+
+// Build a graph of ncomps components and their reverse complements.  Some
+// components are their own reverse complement, joined through a palindromic
+// edge, and some end in a fork.  Vertex and edge ids are shuffled across
+// components.
+
+void RandomGraph( const int ncomps, const int K, HyperBasevector& hb,
+     vec<int>& inv )
+{    vec<ProtoEdge> edges;
+     int N = 0;
+     for ( int c = 0; c < ncomps; c++ )
+     {    vec<ProtoEdge> half;
+          int n = 1;
+          int last = AddStrand( half, n, 0, K );
+          Bool pal = ( randomx( ) % 4 == 0 );
+          if ( !pal && randomx( ) % 3 == 0 )
+          {    int x = n++, y = n++;
+               half.push_back( ProtoEdge{ last, x, RandomBases(K), -1 } );
+               half.push_back( ProtoEdge{ last, y, RandomBases(K+1), -1 } );    }
+          for ( const ProtoEdge& p : half )
+          {    int e = edges.size( );
+               edges.push_back( ProtoEdge{ N + p.v, N + p.w, p.b, e + 1 } );
+               edges.push_back( ProtoEdge{ N + n + p.w, N + n + p.v, RC(p.b), e } );    }
+          if (pal)
+          {    bvec b = RandomBases( K/2 + randomx( ) % 500 );
+               b.append( RC(b) );
+               edges.push_back( ProtoEdge{ N + last, N + n + last, b,
+                    int( edges.size( ) ) } );    }
+          N += 2*n;    }
+
+     vec<int> vperm( N, vec<int>::IDENTITY ), eperm( edges.size( ),
+          vec<int>::IDENTITY );
+     for ( int i = N - 1; i > 0; i-- )
+          std::swap( vperm[i], vperm[ randomx( ) % (i+1) ] );
+     for ( int i = edges.isize( ) - 1; i > 0; i-- )
+          std::swap( eperm[i], eperm[ randomx( ) % (i+1) ] );
+     vec<int> pos( edges.size( ) );
+     for ( int i = 0; i < edges.isize( ); i++ )
+          pos[ eperm[i] ] = i;
+     hb = HyperBasevector(K);
+     hb.AddVertices(N);
+     inv.resize( edges.size( ) );
+     for ( int i = 0; i < edges.isize( ); i++ )
+     {    const ProtoEdge& p = edges[ eperm[i] ];
+          hb.AddEdge( vperm[p.v], vperm[p.w], p.b );
+          inv[i] = pos[p.rc];    }    }
+
+String Slurp( const String& fn )
+{    std::ifstream in( fn.c_str( ) );
+     std::ostringstream s;
+     s << in.rdbuf( );
+     return s.str( );    }
+
+} // end of anonymous namespace
+
+int main( )
+{    const int K = 200, max_cell_paths = 50, max_depth = 10;
+     omp_set_num_threads(4);
+     int fails = 0;
+     HyperBasevector hb;
+     vec<int> inv;
+     for ( int it = 0; it < 100; it++ )
+     {    RandomGraph( 1 + it % 40, K, hb, inv );
+          vec<vec<int>> comps;
+          hb.Components(comps);
+          vec< std::pair<int,int> > bounds_old, bounds_new;
+          OldFindSomeCells( hb, 2*max_cell_paths, max_depth, bounds_old );
+          FindSomeCells( hb, 2*max_cell_paths, max_depth, comps, bounds_new );
+          if ( bounds_new != bounds_old )
+          {    std::cout << "graph " << it << ": FindSomeCells found "
+                    << bounds_new.size( ) << " cells, the serial version "
+                    << bounds_old.size( ) << std::endl;
+               fails++;    }
+          vec<vec<vec<vec<int>>>> lines_old, lines_new;
+          OldFindLines( hb, inv, lines_old, max_cell_paths, max_depth );
+          FindLines( hb, inv, lines_new, max_cell_paths, max_depth );
+          if ( lines_new != lines_old )
+          {    std::cout << "graph " << it << ": FindLines found "
+                    << lines_new.size( ) << " lines, the serial version "
+                    << lines_old.size( ) << std::endl;
+               fails++;    }    }
+
+     // GFADump and FinalFiles on the last graph.
+
+     const String dir = "LinesTest.tmp";
+     Mkdir777(dir);
+     vec<vec<vec<vec<int>>>> lines, final_lines;
+     FindLines( hb, inv, lines, max_cell_paths, max_depth );
+     ReadPathVec paths;
+     FinalFiles( hb, inv, paths, { "C" }, { 0 }, dir, "a", max_cell_paths,
+          max_depth, vecbasevector( ), &final_lines );
+     vec<vec<vec<vec<int>>>> sorted(lines);
+     SortLines( sorted, hb, inv );
+     if ( final_lines != sorted )
+     {    std::cout << "FinalFiles returned other lines than FindLines"
+               << std::endl;
+          fails++;    }
+     GFADump( dir + "/found", hb, inv, paths, max_cell_paths, max_depth, true );
+     GFADump( dir + "/lines", hb, inv, paths, max_cell_paths, max_depth, true,
+          &lines );
+     GFADump( dir + "/final", hb, inv, paths, max_cell_paths, max_depth, true,
+          &final_lines );
+     for ( String suffix : { "_lines.gfa", "_raw.gfa" } )
+     {    String found = Slurp( dir + "/found" + suffix );
+          if ( found.empty( ) || Slurp( dir + "/lines" + suffix ) != found
+               || Slurp( dir + "/final" + suffix ) != found )
+          {    std::cout << "GFADump with precomputed lines differs in "
+                    << suffix << std::endl;
+               fails++;    }    }
+     for ( const String& f : AllFiles(dir) )
+          Remove( dir + "/" + f );
+     Rmdir(dir);
+
+     if ( fails > 0 ) return 1;
+     std::cout << "parallel lines, cells and GFA dumps agree" << std::endl;
+     return 0;    }
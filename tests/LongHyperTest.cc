@@ -0,0 +1,77 @@
+// LongHyperTest: check that the reads expanded once for all K2 floors, and
+// the K2 chosen from them, match what LongHyper computed on each call before.
+
+#include "CoreTools.h"
+#include "efasta/EfastaTools.h"
+#include "paths/long/LongHyper.h"
+#include "paths/long/LongProtoTools.h"
+#include "random/Random.h"
+
+namespace
+{
+
+// Random corrected reads in EFASTA, some with ambiguous bases and some empty.
+
+void RandomCorrected( const int n, VecEFasta& corrected )
+{    const char* bases = "ACGT";
+     corrected.clear( );
+     for ( int i = 0; i < n; i++ )
+     {    String s;
+          if ( randomx( ) % 8 != 0 )
+          {    const int L = 50 + randomx( ) % 400;
+               for ( int j = 0; j < L; j++ )
+               {    if ( randomx( ) % 100 == 0 )
+                    {    s += "{";
+                         s += bases[ randomx( ) % 2 ];
+                         s += ",";
+                         s += bases[ 2 + randomx( ) % 2 ];
+                         s += "}";    }
+                    else s += bases[ randomx( ) % 4 ];    }    }
+          corrected.push_back( efasta(s) );    }    }
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0;
+     long_logging logc( "", "" );
+     logc.STATUS_LOGGING = False;
+     logc.MIN_LOGGING = False;
+     for ( int it = 0; it < 50; it++ )
+     {    VecEFasta corrected;
+          RandomCorrected( 1 + randomx( ) % 40, corrected );
+          Bool any = False;
+          for ( size_t i = 0; i < corrected.size( ); i++ )
+               if ( corrected[i].size( ) > 0 ) any = True;
+          if ( !any ) continue;
+          long_heuristics heur( "" );
+          long_hyper_reads reads( corrected, heur, logc );
+
+          // The expansion, as LongHyper did it.
+
+          vecbasevector correctedv;
+          vec< triple<int,int,int> > origin;
+          for ( size_t id = 0; id < corrected.size( ); id++ )
+          {    vec<basevector> b;
+               corrected[id].ExpandTo(b);
+               for ( int j = 0; j < b.isize( ); j++ )
+               {    correctedv.push_back_reserve( b[j] );
+                    origin.push( id, j, b.size( ) );    }    }
+          if ( reads.correctedv != correctedv || reads.origin != origin )
+          {    std::cout << "expansion differs, case " << it << std::endl;
+               fails++;    }
+
+          // K2 for each floor, as LongHyper chose it.
+
+          for ( int floor : { 0, 100, 128, 144, 172, 200 } )
+          for ( int force : { -1, 96 } )
+          {    heur.K2_FLOOR = floor, heur.K2_FORCE = force;
+               int K2 = SelectK2( corrected, heur.K2frac, logc, heur );
+               K2 = Max( K2, heur.K2_FLOOR );
+               if ( heur.K2_FORCE >= 0 ) K2 = heur.K2_FORCE;
+               if ( reads.K2(heur) != K2 )
+               {    std::cout << "K2 differs, case " << it << ", floor "
+                         << floor << std::endl;
+                    fails++;    }    }    }
+     if ( fails > 0 ) return 1;
+     std::cout << "expansions and K2 agree" << std::endl;
+     return 0;    }
@@ -0,0 +1,42 @@
+// MemoryGovernorTest: check how batch counts follow the memory advisory,
+// including when the budget is already used up.
+
+#include "CoreTools.h"
+#include "system/MemoryGovernor.h"
+
+int main( )
+{    int fails = 0;
+     auto check = [&fails]( const bool ok, const char* what )
+     {    if ( !ok )
+          {    std::cout << "failed: " << what << std::endl;
+               fails++;    }    };
+     // Plenty of room: a job within the budget is one batch, a bigger job is
+     // split, and maxBatches caps the count.
+
+     SetMaxMemory(0);
+     const size_t budget = MemoryGovernor::budget( );
+     check( budget > 0, "budget left under the physical memory" );
+     check( MemoryGovernor::planningBudget( ) >= budget / 2,
+          "planning budget is the budget when there is room" );
+     check( MemoryGovernor::nBatches( budget/2 ) == 1, "small job is one batch" );
+     check( MemoryGovernor::nBatches( budget/2 * 5 ) == 3, "big job is split" );
+     check( MemoryGovernor::nBatches( 1000*budget, 10 ) == 10,
+          "maxBatches caps the count" );
+     check( MemoryGovernor::nBatches(0) == 1, "empty job is one batch" );
+
+     // No room left: batches are sized to half the advisory, rather than the
+     // job being cut into as many batches as allowed.
+
+     SetMaxMemory( MemUsageBytes( ) / 2 );
+     check( MemoryGovernor::budget( ) == 0, "budget is used up" );
+     check( MemoryGovernor::planningBudget( ) == GetMaxMemory( ) / 2,
+          "planning budget falls back to half the advisory" );
+     check( MemoryGovernor::nBatches( GetMaxMemory( ), 255 ) == 2,
+          "used-up budget does not force the maximum batch count" );
+
+     // Phase only reads the high-water mark.
+
+     {    MemoryGovernor::Phase phase( "test phase" );    }
+     if ( fails > 0 ) return 1;
+     std::cout << "batch counts as expected" << std::endl;
+     return 0;    }
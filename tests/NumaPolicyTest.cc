@@ -0,0 +1,120 @@
+// NumaPolicyTest: check that the NUMA policies parse, take effect or fall
+// back, and leave the feudal containers holding what they held under the
+// default policy, for blocks both above and below the first-touch size.
+
+#include "Basevector.h"
+#include "CoreTools.h"
+#include "feudal/Mempool.h"
+#include "random/Random.h"
+#include "system/NumaPolicy.h"
+#include <omp.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+
+vecbvec RandomReads( const int n, const int len )
+{    vecbvec reads;
+     reads.reserve(n);
+     for ( int i = 0; i < n; i++ )
+     {    bvec b(len);
+          for ( int j = 0; j < len; j++ )
+               b.Set( j, randomx( ) % 4 );
+          reads.push_back(b);    }
+     return reads;    }
+
+// The kernel's policy mode for the calling thread: 3 is interleaved.
+
+int ThreadMode( )
+{    int mode = -1;
+#ifdef SYS_get_mempolicy
+     if ( syscall( SYS_get_mempolicy, &mode, nullptr, 0, nullptr, 0 ) != 0 )
+          mode = -1;
+#endif
+     return mode;    }
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0;
+     omp_set_num_threads(4);
+     for ( auto p : { NumaPolicy::DEFAULT, NumaPolicy::INTERLEAVE,
+          NumaPolicy::FIRST_TOUCH } )
+     {    NumaPolicy::Policy q;
+          if ( !NumaPolicy::parse( NumaPolicy::name(p), q ) || q != p )
+          {    std::cout << "can't parse " << NumaPolicy::name(p) << std::endl;
+               fails++;    }    }
+     NumaPolicy::Policy q = NumaPolicy::INTERLEAVE;
+     if ( NumaPolicy::parse( "spread", q ) || q != NumaPolicy::INTERLEAVE )
+     {    std::cout << "parsed a bad name" << std::endl;
+          fails++;    }
+     if ( NumaPolicy::nNodes( ) < 1 )
+     {    std::cout << "no NUMA nodes" << std::endl;
+          fails++;    }
+
+     // Copies made under each policy must match the original.  The big copy
+     // is one preallocated Mempool block, big enough to be touched, as is the
+     // block taken from a pool directly.
+
+     const vecbvec reads = RandomReads( 500000, 150 );
+     for ( auto p : { NumaPolicy::FIRST_TOUCH, NumaPolicy::INTERLEAVE,
+          NumaPolicy::DEFAULT } )
+     {    NumaPolicy::Policy got = NumaPolicy::set(p);
+          if ( got != p && !( p == NumaPolicy::INTERLEAVE
+               && got == NumaPolicy::DEFAULT ) )
+          {    std::cout << "asked for " << NumaPolicy::name(p) << ", got "
+                    << NumaPolicy::name(got) << std::endl;
+               fails++;    }
+          if ( NumaPolicy::get( ) != got )
+          {    std::cout << "get disagrees with set" << std::endl;
+               fails++;    }
+
+          // Every thread of the pool must have the policy, not just this one.
+
+          const int want = ( got == NumaPolicy::INTERLEAVE ? 3 : 0 );
+          int wrong = 0;
+          #pragma omp parallel reduction(+:wrong)
+          wrong += ( ThreadMode( ) != want && ThreadMode( ) != -1 );
+          if ( wrong > 0 )
+          {    std::cout << wrong << " threads lack the policy "
+                    << NumaPolicy::name(got) << std::endl;
+               fails++;    }
+          vecbvec copy( reads.begin( ), reads.end( ) );
+          vecbvec small( reads.begin( ), reads.begin( ) + 100 );
+          if ( copy != reads || small != vecbvec( reads.begin( ),
+               reads.begin( ) + 100 ) )
+          {    std::cout << "copy differs under " << NumaPolicy::name(got)
+                    << std::endl;
+               fails++;    }
+          Mempool pool;
+          pool.ref( );
+          const size_t big = 2 * NumaPolicy::MIN_TOUCH_BYTES;
+          char* block = (char*) pool.allocate( big, 1 );
+          for ( size_t i = 0; i < big; i += 4096 )
+               block[i] = char(i/4096);
+          for ( size_t i = 0; i < big; i += 4096 )
+               if ( block[i] != char(i/4096) )
+               {    std::cout << "big block broken" << std::endl;
+                    fails++;
+                    break;    }
+          pool.free( block, big );
+          pool.deref( );    }
+
+     // The policy can't be changed from inside a parallel region.
+
+     NumaPolicy::set( NumaPolicy::FIRST_TOUCH );
+     NumaPolicy::Policy inside = NumaPolicy::DEFAULT;
+     #pragma omp parallel num_threads(2)
+     {
+          #pragma omp single
+          inside = NumaPolicy::set( NumaPolicy::DEFAULT );
+     }
+     if ( inside != NumaPolicy::FIRST_TOUCH
+          || NumaPolicy::get( ) != NumaPolicy::FIRST_TOUCH )
+     {    std::cout << "policy changed inside a parallel region" << std::endl;
+          fails++;    }
+     NumaPolicy::set( NumaPolicy::DEFAULT );
+     if ( fails > 0 ) return 1;
+     std::cout << "NUMA policies behave" << std::endl;
+     return 0;    }
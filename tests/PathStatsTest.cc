@@ -0,0 +1,150 @@
+// PathStatsTest: check the statistics gathered by ScanPairs against the
+// serial loops they replaced in FragDist, ComputeCoverage, GetLineNpairs and
+// Simplify, on random graphs and paths.
+
+#include "CoreTools.h"
+#include "paths/HyperBasevector.h"
+#include "paths/long/ReadPath.h"
+#include "paths/long/large/PathStats.h"
+#include "random/Random.h"
+
+namespace
+{
+
+// The fragment size loop of FragDist.
+
+vec<double> SerialFragCounts( const HyperBasevector& hb, const vec<int>& inv,
+     const ReadPathVec& paths )
+{    const int width = 10;
+     const int max_sep = 1000;
+     const int min_edge = 10000;
+     vec<double> count( max_sep/width, 0 );
+     for ( int64_t id1 = 0; id1 < (int64_t) paths.size( ); id1 += 2 )
+     {    int64_t id2 = id1 + 1;
+          if ( paths[id1].size( ) == 0 || paths[id2].size( ) == 0 ) continue;
+          int e1 = paths[id1][0], e2 = inv[ paths[id2][0] ];
+          int epos1 = paths[id1].getOffset( );
+          if ( e1 != e2 ) continue;
+          if ( hb.EdgeLengthBases(e1) < min_edge ) continue;
+          int epos2 = hb.EdgeLengthBases(e2) - paths[id2].getOffset( );
+          int len = epos2 - epos1;
+          if ( len < 0 || len >= max_sep ) continue;
+          count[ len/width ]++;    }
+     return count;    }
+
+// The pair counting loop of ComputeCoverage.
+
+vec<vec<int>> SerialLineNpairs( const vec<int>& inv, const ReadPathVec& paths,
+     const vec<int>& tol, const int nlines, const vec<int64_t>& subsam_starts )
+{    int ns = subsam_starts.size( );
+     vec<vec<int>> npairs( ns, vec<int>( nlines, 0 ) );
+     vec<int> e;
+     for ( int64_t pid = 0; pid < (int64_t) paths.size( ) / 2; pid++ )
+     {    int64_t id1 = 2*pid, id2 = 2*pid+1;
+          e.clear( );
+          for ( int64_t j = 0; j < (int64_t) paths[id1].size( ); j++ )
+               e.push_back( tol[ paths[id1][j] ], tol[ inv[ paths[id1][j] ] ] );
+          for ( int64_t j = 0; j < (int64_t) paths[id2].size( ); j++ )
+               e.push_back( tol[ paths[id2][j] ], tol[ inv[ paths[id2][j] ] ] );
+          UniqueSort(e);
+          int ss;
+          for ( ss = 0; ss < ns; ss++ )
+               if ( ss == ns - 1 || 2*pid < subsam_starts[ss+1] ) break;
+          for ( int64_t j = 0; j < e.isize( ); j++ )
+               npairs[ss][ e[j] ]++;    }
+     return npairs;    }
+
+// The two support loops of Simplify.
+
+void SerialSupport( const vec<int>& inv, const ReadPathVec& paths,
+     vec<int>& in, vec<int>& out )
+{    in.resize_and_set( inv.size( ), 0 );
+     out.resize_and_set( inv.size( ), 0 );
+     for ( int64_t id = 0; id < (int64_t) paths.size( ); id++ )
+     {    for ( int64_t j = 0; j < (int64_t) paths[id].size( ); j++ )
+          {    int e = paths[id][j];
+               if ( j >= 1 ) in[e]++;
+               if ( inv[e] >= 0 && j < (int64_t) paths[id].size( ) - 1 )
+                    in[ inv[e] ]++;    }    }
+     for ( int64_t id = 0; id < (int64_t) paths.size( ); id++ )
+     {    for ( int64_t j = 0; j < (int64_t) paths[id].size( ); j++ )
+          {    int e = paths[id][j];
+               if ( j < (int64_t) paths[id].size( ) - 1 ) out[e]++;
+               if ( inv[e] >= 0 && j >= 1 ) out[ inv[e] ]++;    }    }    }
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0;
+     const int K = 200;
+     for ( int it = 0; it < 20; it++ )
+     {
+          // A random graph, with edges of up to 15 kb, paired up by the
+          // involution, save for some self-involutes.
+
+          const int nv = 1 + randomx( ) % 100, ne = 2 + 2 * ( randomx( ) % 100 );
+          HyperBasevector hb(K);
+          hb.AddVertices(nv);
+          for ( int e = 0; e < ne; e++ )
+          {    bvec b( K + randomx( ) % 15000 );
+               hb.AddEdge( randomx( ) % nv, randomx( ) % nv, b );    }
+          vec<int> inv( ne );
+          for ( int e = 0; e < ne; e += 2 )
+          {    if ( randomx( ) % 10 == 0 ) inv[e] = e, inv[e+1] = e+1;
+               else inv[e] = e+1, inv[e+1] = e;    }
+
+          // Random pairs of paths, often with the mate on the involute of the
+          // first edge, and an unpaired last read on odd iterations.
+
+          const int64_t npaths = 2 * ( randomx( ) % 25000 ) + it % 2;
+          ReadPathVec paths( npaths );
+          for ( int64_t id = 0; id < npaths; id++ )
+          {    int n = randomx( ) % 5;
+               for ( int j = 0; j < n; j++ )
+                    paths[id].push_back( randomx( ) % ne );
+               if ( id % 2 == 1 && n > 0 && !paths[id-1].empty( )
+                    && randomx( ) % 2 )
+               {    int e = inv[ paths[id-1][0] ];
+                    paths[id][0] = e;
+                    int len = hb.EdgeLengthBases(e);
+                    paths[id].setOffset( len - paths[id-1].getOffset( )
+                         - randomx( ) % 1100 );    }
+               else paths[id].setOffset( randomx( ) % 15000 );    }
+
+          // Random lines and subsamples.
+
+          const int nlines = 1 + randomx( ) % ne;
+          vec<int> tol( ne );
+          for ( int e = 0; e < ne; e++ )
+               tol[e] = randomx( ) % nlines;
+          vec<int64_t> subsam_starts = { 0 };
+          if ( it % 3 != 0 )
+               subsam_starts.push_back( npaths/3 & ~1, npaths/2 & ~1 );
+
+          FragSizeStat frag_sizes( hb, inv );
+          LinePairStat line_pairs( inv, tol, nlines, subsam_starts );
+          EdgeSupportStat support(inv);
+          ScanPairs( paths, { &frag_sizes, &line_pairs, &support } );
+
+          ReadPathVec even( paths );
+          even.resize( npaths & ~1 );
+          if ( frag_sizes.counts( ) != SerialFragCounts( hb, inv, even ) )
+          {    std::cout << "fragment sizes differ, iteration " << it << std::endl;
+               fails++;    }
+          if ( it % 2 == 0
+               && line_pairs.npairs( )
+                    != SerialLineNpairs( inv, paths, tol, nlines, subsam_starts ) )
+          {    std::cout << "line pairs differ, iteration " << it << std::endl;
+               fails++;    }
+          vec<int> total = SerialLineNpairs( inv, paths, tol, nlines, { 0 } )[0];
+          if ( it % 2 == 0 && line_pairs.total( ) != total )
+          {    std::cout << "line pair totals differ, iteration " << it << std::endl;
+               fails++;    }
+          vec<int> in, out;
+          SerialSupport( inv, paths, in, out );
+          if ( support.in( ) != in || support.out( ) != out )
+          {    std::cout << "edge support differs, iteration " << it << std::endl;
+               fails++;    }    }
+     if ( fails > 0 ) return 1;
+     std::cout << "pair statistics agree" << std::endl;
+     return 0;    }
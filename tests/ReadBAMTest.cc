@@ -0,0 +1,120 @@
+// ReadBAMTest: write an unaligned BAM of known pairs, in BGZF blocks small
+// enough that records straddle them, and check that BAMReader gives the
+// pairs back.
+
+#include "CoreTools.h"
+#include "bam/ReadBAM.h"
+#include "random/Random.h"
+#include <cstdint>
+#include <fstream>
+#include <zlib.h>
+
+namespace
+{
+
+template <class T> void Put( std::string& s, T val )
+{    s.append( reinterpret_cast<char const*>(&val), sizeof(val) );    }
+
+// One unmapped record.
+
+void PutRecord( std::string& bam, String const& name, basevector const& b,
+     qvec const& q, uint16_t flags )
+{    std::string rec;
+     Put<int32_t>( rec, -1 ), Put<int32_t>( rec, -1 );
+     Put<uint8_t>( rec, name.size( ) + 1 ), Put<uint8_t>( rec, 0 );
+     Put<uint16_t>( rec, 4680 ), Put<uint16_t>( rec, 0 ), Put<uint16_t>( rec, flags );
+     Put<uint32_t>( rec, b.size( ) );
+     Put<int32_t>( rec, -1 ), Put<int32_t>( rec, -1 ), Put<int32_t>( rec, 0 );
+     rec.append( name.c_str( ), name.size( ) + 1 );
+     static const uint8_t code[4] = { 1, 2, 4, 8 };
+     for ( size_t i = 0; i < b.size( ); i += 2 )
+     {    uint8_t x = code[ b[i] ] << 4;
+          if ( i + 1 < b.size( ) ) x |= code[ b[i+1] ];
+          rec.push_back(x);    }
+     rec.append( reinterpret_cast<char const*>( &q[0] ), q.size( ) );
+     rec.append( "XTZfoo", 7 );
+     Put<uint32_t>( bam, rec.size( ) );
+     bam += rec;    }
+
+// One BGZF block holding the given bytes.
+
+void PutBlock( std::ofstream& out, char const* data, size_t len )
+{    std::vector<uint8_t> zbuf( 70000 );
+     z_stream zs;
+     zs.zalloc = nullptr, zs.zfree = nullptr, zs.opaque = nullptr;
+     deflateInit2( &zs, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY );
+     zs.next_in = (uint8_t*) data, zs.avail_in = len;
+     zs.next_out = &zbuf[0], zs.avail_out = zbuf.size( );
+     deflate( &zs, Z_FINISH );
+     size_t zlen = zs.total_out;
+     deflateEnd( &zs );
+     std::string hdr;
+     Put<uint16_t>( hdr, 0x8b1f ), Put<uint8_t>( hdr, 8 ), Put<uint8_t>( hdr, 4 );
+     Put<uint32_t>( hdr, 0 ), Put<uint8_t>( hdr, 0 ), Put<uint8_t>( hdr, 0xff );
+     Put<uint16_t>( hdr, 6 ), Put<uint16_t>( hdr, 0x4342 ), Put<uint16_t>( hdr, 2 );
+     Put<uint16_t>( hdr, hdr.size( ) + 2 + zlen + 8 - 1 );
+     Put<uint32_t>( hdr, crc32( 0, (uint8_t const*) data, len ) );
+     out.write( hdr.data( ), hdr.size( ) - 4 );
+     out.write( (char const*) &zbuf[0], zlen );
+     out.write( hdr.data( ) + hdr.size( ) - 4, 4 );
+     Put<uint32_t>( hdr, len );
+     out.write( hdr.data( ) + hdr.size( ) - 4, 4 );    }
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0;
+     const String bamFile = "ReadBAMTest.tmp.bam";
+     for ( int it = 0; it < 4; it++ )
+     {    const int npairs = ( it == 0 ? 1 : 3000 * it );
+          vecbasevector bases;
+          vec<qvec> quals;
+          bases.reserve( 2 * npairs );
+          std::string bam( "BAM\1", 4 );
+          Put<uint32_t>( bam, 0 ), Put<uint32_t>( bam, 0 );
+          for ( int p = 0; p < npairs; p++ )
+          {    String name = "r" + ToString( 1000000 + p );
+               for ( int end = 0; end < 2; end++ )
+               {    const int L = 1 + randomx( ) % 250;
+                    basevector b(L);
+                    qvec q(L);
+                    for ( int i = 0; i < L; i++ )
+                    {    b.Set( i, randomx( ) % 4 );
+                         q[i] = randomx( ) % 41;    }
+                    uint16_t flags = 0x1 | 0x4 | 0x8 | ( end == 0 ? 0x40 : 0x80 );
+                    if ( randomx( ) % 4 == 0 ) flags |= 0x10;
+                    PutRecord( bam, name, b, q, flags );
+                    if ( flags & 0x10 )
+                    {    b.ReverseComplement( );
+                         q.ReverseMe( );    }
+                    bases.push_back(b);
+                    quals.push_back(q);    }    }
+
+          // Cut the stream into blocks of random size, with an occasional
+          // empty block, and the usual empty block at the end.
+
+          std::ofstream out( bamFile.c_str( ), std::ios::binary );
+          for ( size_t pos = 0; pos < bam.size( ); )
+          {    size_t len = std::min( bam.size( ) - pos,
+                    size_t( 1 + randomx( ) % ( it < 2 ? 300 : 65536 ) ) );
+               PutBlock( out, bam.data( ) + pos, len );
+               if ( randomx( ) % 50 == 0 ) PutBlock( out, "", 0 );
+               pos += len;    }
+          PutBlock( out, "", 0 );
+          out.close( );
+
+          vecbvec b2;
+          VecPQVec q2;
+          BAMReader( ).readBAM( bamFile, &b2, &q2 );
+          Bool ok = ( b2.size( ) == bases.size( ) && q2.size( ) == quals.size( ) );
+          for ( size_t i = 0; ok && i < bases.size( ); i++ )
+          {    qvec q;
+               q2[i].unpack(&q);
+               if ( b2[i] != bases[i] || q != quals[i] ) ok = False;    }
+          if ( !ok )
+          {    std::cout << "reads differ, case " << it << std::endl;
+               fails++;    }    }
+     Remove(bamFile);
+     if ( fails > 0 ) return 1;
+     std::cout << "all reads agree" << std::endl;
+     return 0;    }
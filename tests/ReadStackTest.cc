@@ -0,0 +1,154 @@
+// ReadStackTest: check StackMatrix against the vector-per-row storage that
+// readstack used before, and the one-pass QualSums against the per-column
+// loops it replaced.
+
+#include "CoreTools.h"
+#include "paths/long/ReadStack.h"
+#include "VecUtilities.h"
+#include "random/Random.h"
+
+namespace
+{
+
+typedef vec< vec<signed char> > OldRows;
+
+Bool Same( const StackQualMatrix& m, const OldRows& rows )
+{    if ( m.Rows( ) != rows.isize( ) ) return False;
+     for ( int i = 0; i < m.Rows( ); i++ )
+     {    if ( rows[i].isize( ) != m.Cols( ) ) return False;
+          if ( !std::equal( rows[i].begin( ), rows[i].end( ), m[i] ) ) return False;    }
+     return True;    }
+
+void RandomRows( const int nrows, const int ncols, StackQualMatrix& m,
+     OldRows& rows )
+{    m.assign( nrows, ncols, -1 );
+     rows.assign( nrows, vec<signed char>( ncols, -1 ) );
+     for ( int i = 0; i < nrows; i++ )
+     for ( int j = 0; j < ncols; j++ )
+          rows[i][j] = m[i][j] = randomx( ) % 50 - 1;    }
+
+// The row operations, as readstack did them on one vector per row.
+
+int CheckMatrix( )
+{    int fails = 0;
+     auto check = [&fails]( const Bool ok, const char* what )
+     {    if ( !ok )
+          {    std::cout << "StackMatrix differs: " << what << std::endl;
+               fails++;    }    };
+     for ( int it = 0; it < 500; it++ )
+     {    const int nrows = randomx( ) % 20, ncols = 1 + randomx( ) % 30;
+          StackQualMatrix m;
+          OldRows rows;
+          RandomRows( nrows, ncols, m, rows );
+          check( Same( m, rows ), "assign" );
+
+          const int n = randomx( ) % 4;
+          m.AppendRows( n, -1 );
+          rows.resize( nrows + n, vec<signed char>( ncols, -1 ) );
+          check( Same( m, rows ), "AppendRows" );
+
+          vec<Bool> to_remove( m.Rows( ) );
+          for ( int i = 0; i < m.Rows( ); i++ )
+               to_remove[i] = ( randomx( ) % 3 == 0 );
+          m.EraseRows(to_remove);
+          EraseIf( rows, to_remove );
+          check( Same( m, rows ), "EraseRows" );
+
+          vec<int> perm( m.Rows( ), vec<int>::IDENTITY );
+          std::random_shuffle( perm.begin( ), perm.end( ) );
+          m.PermuteRows(perm);
+          PermuteVec( rows, perm );
+          check( Same( m, rows ), "PermuteRows" );
+
+          m.ReverseRows( );
+          for ( auto& r : rows )
+               std::reverse( r.begin( ), r.end( ) );
+          check( Same( m, rows ), "ReverseRows" );
+
+          // Widen, then append another matrix, as Merge does.
+
+          const int left = randomx( ) % 5, right = randomx( ) % 5;
+          m.Widen( left, right, -1 );
+          for ( auto& r : rows )
+          {    vec<signed char> w( left, -1 );
+               w.append(r);
+               w.resize( w.size( ) + right, -1 );
+               r = w;    }
+          check( Same( m, rows ), "Widen" );
+          StackQualMatrix m2;
+          OldRows rows2;
+          const int ncols2 = 1 + randomx( ) % m.Cols( );
+          RandomRows( randomx( ) % 5, ncols2, m2, rows2 );
+          const int left2 = randomx( ) % ( m.Cols( ) - ncols2 + 1 );
+          m.AppendRows( m2, left2, -1 );
+          for ( auto const& r : rows2 )
+          {    vec<signed char> w( left2, -1 );
+               w.append(r);
+               w.resize( m.Cols( ), -1 );
+               rows.push_back(w);    }
+          check( Same( m, rows ), "AppendRows of a matrix" );
+
+          const int start = randomx( ) % m.Cols( );
+          const int stop = start + 1 + randomx( ) % ( m.Cols( ) - start );
+          m.SubCols( start, stop );
+          for ( auto& r : rows )
+               r.assign( r.begin( ) + start, r.begin( ) + stop );
+          check( Same( m, rows ), "SubCols" );    }
+     return fails;    }
+
+// The per-column sums that Consensus1 (q0 = 0.1) and CorrectAll (q0 = 0)
+// computed before, one column at a time.
+
+void OldQualSums( const readstack& s, const double q0, vec<double>& sums,
+     vec<int>& top )
+{    sums.assign( 4 * s.Cols( ), 0. );
+     top.assign( 4 * s.Cols( ), 0 );
+     for ( int i = 0; i < s.Cols( ); i++ )
+     {    for ( int j = 0; j < s.Rows( ); j++ )
+          {    if ( s.Qual( j, i ) < 0 ) continue;
+               double q = s.Qual( j, i );
+               if ( q <= 2 ) q = Min( q, 0.2 );
+               if ( q == 0 ) q = q0;
+               int b = s.Base( j, i );
+               sums[ 4*i + b ] += q;
+               top[ 4*i + b ] = Max( top[ 4*i + b ], s.Qual( j, i ) );    }    }    }
+
+int CheckSums( )
+{    int fails = 0;
+     for ( int it = 0; it < 200; it++ )
+     {    const int nr = 2 + randomx( ) % 60, nc = 50 + randomx( ) % 200;
+          readstack s( nr, nc );
+          basevector truth(nc);
+          for ( int c = 0; c < nc; c++ )
+               truth.Set( c, randomx( ) % 4 );
+          for ( int i = 0; i < nr; i++ )
+          {    int a = randomx( ) % nc / 3, b = nc - randomx( ) % nc / 3;
+               for ( int c = a; c < b; c++ )
+               {    s.SetBase( i, c, randomx( ) % 20 ? truth[c] : randomx( ) % 4 );
+                    s.SetQual( i, c, randomx( ) % 45 );    }    }
+          for ( double q0 : { 0.1, 0.0 } )
+          {    vec<double> sums, old_sums;
+               vec<int> top, old_top;
+               s.QualSums( q0, sums, &top );
+               OldQualSums( s, q0, old_sums, old_top );
+               if ( sums != old_sums || top != old_top )
+               {    std::cout << "QualSums differs, stack " << it << std::endl;
+                    fails++;    }    }
+          basevector con;
+          s.ColumnConsensuses1(con);
+          for ( int c = 0; c < nc; c++ )
+          {    if ( con[c] != s.ColumnConsensus1(c) )
+               {    std::cout << "ColumnConsensuses1 differs, stack " << it
+                         << std::endl;
+                    fails++;
+                    break;    }    }    }
+     return fails;    }
+
+} // end of anonymous namespace
+
+int main( )
+{    readstack::init_LUTs( );
+     int fails = CheckMatrix( ) + CheckSums( );
+     if ( fails > 0 ) return 1;
+     std::cout << "stacks agree" << std::endl;
+     return 0;    }
@@ -0,0 +1,53 @@
+// RepathTest: check that places spilled to sorted runs and merged back come out
+// the same as when they are all sorted and uniqued in memory, as RepathInMemory
+// did before it could spill.
+
+#include "CoreTools.h"
+#include "paths/long/large/Repath.h"
+#include "random/Random.h"
+#include "system/MemoryGovernor.h"
+
+int main( )
+{    MemoryGovernor::setSpillDir( "/tmp" );
+     int fails = 0;
+     for ( int it = 0; it < 50; it++ )
+     {    const int nplaces = randomx( ) % 20000;
+          const int nruns = 1 + randomx( ) % 8;
+          const int nedges = 1 + randomx( ) % 100;
+          std::vector< std::vector<int> > all;
+          for ( int i = 0; i < nplaces; i++ )
+          {    std::vector<int> p( 1 + randomx( ) % 4 );
+               for ( auto& e : p ) e = randomx( ) % nedges;
+               all.push_back(p);    }
+
+          // Spill the places in rounds, each sorted and uniqued, leaving the
+          // last round in memory to be spilled too, as RepathInMemory does.
+
+          vec<String> runs;
+          std::vector< std::vector<int> > places;
+          for ( int r = 0; r < nruns; r++ )
+          {    int start = (int64_t) nplaces * r / nruns;
+               int stop = (int64_t) nplaces * (r+1) / nruns;
+               places.assign( all.begin( ) + start, all.begin( ) + stop );
+               std::sort( places.begin( ), places.end( ) );
+               places.erase( std::unique( places.begin( ), places.end( ) ),
+                    places.end( ) );
+               runs.push_back( MemoryGovernor::spillFile( "places" ) );
+               SpillPlaces( places, runs.back( ) );
+               if ( !places.empty( ) )
+               {    std::cout << "places not freed by SpillPlaces" << std::endl;
+                    fails++;    }    }
+          MergePlaceRuns( runs, places );
+          for ( const auto& fn : runs )
+          {    if ( IsRegularFile(fn) )
+               {    std::cout << "run file " << fn << " not removed" << std::endl;
+                    fails++;    }    }
+
+          std::sort( all.begin( ), all.end( ) );
+          all.erase( std::unique( all.begin( ), all.end( ) ), all.end( ) );
+          if ( places != all )
+          {    std::cout << "merged places differ, case " << it << std::endl;
+               fails++;    }    }
+     if ( fails > 0 ) return 1;
+     std::cout << "merged places agree" << std::endl;
+     return 0;    }
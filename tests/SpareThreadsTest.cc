@@ -0,0 +1,77 @@
+// SpareThreadsTest: check that Loans never hand out more threads than have
+// been donated, even when many threads borrow at once, and that every
+// borrowed thread is back in the pool once the Loans are gone.
+
+#include "CoreTools.h"
+#include "system/SpareThreads.h"
+#include <atomic>
+#include <omp.h>
+
+int main( )
+{    int fails = 0;
+     const int nthreads = 8, ndonors = 3, rounds = 20000;
+     const int oldLevels = omp_get_max_active_levels( );
+     {    SpareThreads::Pool pool;
+          std::atomic<int> onLoan(0), maxOnLoan(0), ready(0), tooMany(0);
+          #pragma omp parallel num_threads(nthreads)
+          {    SpareThreads::enter( );
+               const int t = omp_get_thread_num( );
+
+               // The first few threads donate themselves at once; the rest
+               // borrow and return as fast as they can.
+
+               if ( t < ndonors ) SpareThreads::donate( );
+               ++ready;
+               while ( ready.load( ) < omp_get_num_threads( ) );
+               if ( t >= ndonors )
+               {    for ( int r = 0; r < rounds; r++ )
+                    {    SpareThreads::Loan loan( 1 + ( r + t ) % 4 );
+                         if ( loan.threads( ) < 1 || loan.threads( ) > 4 )
+                              ++tooMany;
+                         int now = ( onLoan += loan.threads( ) - 1 );
+                         int seen = maxOnLoan.load( );
+                         while ( now > seen
+                              && !maxOnLoan.compare_exchange_weak( seen, now ) );
+                         onLoan -= loan.threads( ) - 1;    }    }    }
+          if ( maxOnLoan > ndonors )
+          {    std::cout << "borrowed " << maxOnLoan << " threads, but only "
+                    << ndonors << " were donated" << std::endl;
+               fails++;    }
+          if ( tooMany > 0 )
+          {    std::cout << "a loan exceeded its maximum" << std::endl;
+               fails++;    }
+          if ( SpareThreads::donated( ) != ndonors )
+          {    std::cout << SpareThreads::donated( ) << " threads in the pool "
+                    << "after all loans returned, expected " << ndonors
+                    << std::endl;
+               fails++;    }
+
+          // A nested region run on a loan gets the team it asked for.
+
+          #pragma omp parallel num_threads(2)
+          {    SpareThreads::enter( );
+               #pragma omp barrier
+               if ( omp_get_thread_num( ) == 1 ) SpareThreads::donate( );
+               #pragma omp barrier
+               if ( omp_get_thread_num( ) == 0 )
+               {    SpareThreads::Loan loan(8);
+                    int team = 0;
+                    #pragma omp parallel num_threads(loan.threads( )) \
+                         if(loan.threads( ) > 1)
+                    {
+                         #pragma omp atomic
+                         team++;    }
+                    if ( team != loan.threads( ) )
+                    {    std::cout << "nested team of " << team << ", loan of "
+                              << loan.threads( ) << std::endl;
+                         fails++;    }    }    }    }
+
+     // Destroying the pool empties it and restores the nesting limit.
+
+     if ( SpareThreads::donated( ) != 0
+          || omp_get_max_active_levels( ) != oldLevels )
+     {    std::cout << "pool not reset on destruction" << std::endl;
+          fails++;    }
+     if ( fails > 0 ) return 1;
+     std::cout << "all loans returned" << std::endl;
+     return 0;    }
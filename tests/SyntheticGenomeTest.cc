@@ -0,0 +1,82 @@
+// SyntheticGenomeTest: check that the simulated genome and reads are fixed by
+// the seed, that the haplotypes differ at about the requested rate, and that
+// every read is its source with exactly the low-quality bases changed.
+
+#include "CoreTools.h"
+#include "paths/simulation/SyntheticGenome.h"
+
+int main( )
+{    int fails = 0;
+     genome_params gp;
+     gp.size = 200000, gp.het = .01, gp.ploidy = 3, gp.repeat_frac = .1;
+     read_params rp;
+     rp.coverage = 10, rp.read_len = 100, rp.error_rate = .01;
+
+     vecbvec haps, haps2;
+     vecbvec bases, bases2;
+     vecqvec quals, quals2;
+     vec<sim_pair> origins;
+     RNGen rng(7), rng2(7);
+     SimulateGenome( gp, rng, haps );
+     SimulatePairs( haps, rp, rng, bases, quals, &origins );
+     SimulateGenome( gp, rng2, haps2 );
+     SimulatePairs( haps2, rp, rng2, bases2, quals2 );
+     if ( haps != haps2 || bases != bases2 || quals != quals2 )
+     {    std::cout << "same seed, different output" << std::endl;
+          fails++;    }
+     RNGen rng3(8);
+     SimulateGenome( gp, rng3, haps2 );
+     if ( haps == haps2 )
+     {    std::cout << "different seed, same genome" << std::endl;
+          fails++;    }
+
+     if ( haps.size( ) != 3 || haps[0].size( ) != gp.size
+          || haps[2].size( ) != gp.size )
+     {    std::cout << "wrong haplotypes" << std::endl;
+          fails++;    }
+     else
+     {    for ( int h = 1; h < 3; h++ )
+          {    int64_t diffs = 0;
+               for ( size_t i = 0; i < gp.size; i++ )
+                    if ( haps[h][i] != haps[0][i] ) diffs++;
+               double rate = double(diffs) / gp.size;
+               if ( rate < .008 || rate > .012 )
+               {    std::cout << "haplotype " << h << " differs at rate "
+                         << rate << std::endl;
+                    fails++;    }    }    }
+
+     // Each read against its source, and the fragment lengths.
+
+     size_t npairs = std::lround( rp.coverage * gp.size / ( 2 * rp.read_len ) );
+     if ( origins.size( ) != npairs || bases.size( ) != 2 * npairs
+          || quals.size( ) != 2 * npairs )
+     {    std::cout << "wrong number of reads" << std::endl;
+          return 1;    }
+     int bad = 0;
+     double lensum = 0;
+     for ( size_t p = 0; p < npairs; p++ )
+     {    const sim_pair& sp = origins[p];
+          lensum += sp.len;
+          bvec frag( haps[sp.hap], sp.start, sp.len );
+          if (sp.rc) frag.ReverseComplement( );
+          for ( int end = 0; end < 2; end++ )
+          {    if ( end == 1 ) frag.ReverseComplement( );
+               const bvec& b = bases[ 2*p + end ];
+               const qvec& q = quals[ 2*p + end ];
+               if ( b.isize( ) != rp.read_len || int( q.size( ) ) != rp.read_len )
+               {    bad++;
+                    continue;    }
+               for ( int i = 0; i < rp.read_len; i++ )
+                    if ( ( b[i] != frag[i] ) != ( q[i] < 16 ) ) bad++;    }    }
+     if ( bad > 0 )
+     {    std::cout << bad << " read bases disagree with their source"
+               << std::endl;
+          fails++;    }
+     double mean = lensum / npairs;
+     if ( mean < rp.insert_mean - 5 || mean > rp.insert_mean + 5 )
+     {    std::cout << "mean fragment length " << mean << std::endl;
+          fails++;    }
+
+     if ( fails > 0 ) return 1;
+     std::cout << "genome and reads as specified" << std::endl;
+     return 0;    }
@@ -0,0 +1,123 @@
+// UnsatTest: check the neighborhoods and the union-find cluster merging of
+// Unsat against the code they replaced, on random graphs and clusters.
+
+#include "CoreTools.h"
+#include "Equiv.h"
+#include "paths/HyperBasevector.h"
+#include "paths/long/large/Unsat.h"
+#include "random/Random.h"
+
+namespace
+{
+
+// The neighborhoods as computed before, growing the list with duplicates.
+
+vec<int> OldNhood( const HyperBasevector& hb, const vec<int>& to_left,
+     const vec<int>& to_right, const int e, const int radius )
+{    vec<int> x = {e};
+     for ( int r = 0; r < radius; r++ )
+     {    vec<int> x2 = x;
+          for ( int l = 0; l < x.isize( ); l++ )
+          {    int w = to_right[ x[l] ];
+               for ( int j = 0; j < hb.From(w).isize( ); j++ )
+                    x2.push_back( hb.IFrom( w, j ) );    }
+          x = x2;
+          for ( int l = 0; l < x.isize( ); l++ )
+          {    int w = to_left[ x[l] ];
+               for ( int j = 0; j < hb.To(w).isize( ); j++ )
+                    x2.push_back( hb.ITo( w, j ) );    }
+          x = x2;    }
+     UniqueSort(x);
+     return x;    }
+
+// The serial equiv_rel merge used before.
+
+void OldMergeClusters( const vec< vec< std::pair<int,int> > >& x,
+     vec< vec< std::pair<int,int> > >& y, const vec< vec<int> >& n, const int N )
+{    vec< vec<int> > ind1(N), ind2(N);
+     for ( int i = 0; i < x.isize( ); i++ )
+     for ( int j = 0; j < x[i].isize( ); j++ )
+     {    ind1[ x[i][j].first ].push_back(i);
+          ind2[ x[i][j].second ].push_back(i);    }
+     for ( int i = 0; i < N; i++ )
+     {    UniqueSort( ind1[i] ), UniqueSort( ind2[i] );    }
+     equiv_rel e( x.size( ) );
+     for ( int i = 0; i < x.isize( ); i++ )
+     {    vec<int> s1, s2, t1, t2;
+          for ( int j = 0; j < x[i].isize( ); j++ )
+          {    s1.push_back( x[i][j].first );
+               s2.push_back( x[i][j].second );    }
+          UniqueSort(s1), UniqueSort(s2);
+          vec<int> ss1, ss2;
+          for ( int j = 0; j < s1.isize( ); j++ )
+               ss1.append( n[ s1[j] ] );
+          for ( int j = 0; j < s2.isize( ); j++ )
+               ss2.append( n[ s2[j] ] );
+          UniqueSort(ss1), UniqueSort(ss2);
+          for ( int j = 0; j < ss1.isize( ); j++ )
+               t1.append( ind1[ ss1[j] ] );
+          for ( int j = 0; j < ss2.isize( ); j++ )
+               t2.append( ind2[ ss2[j] ] );
+          UniqueSort(t1), UniqueSort(t2);
+          vec<int> t = Intersection( t1, t2 );
+          for ( auto c : t )
+               e.Join( t[0], c );    }
+     vec< vec< std::pair<int,int> > > z;
+     vec<int> reps;
+     e.OrbitReps(reps);
+     for ( int j = 0; j < reps.isize( ); j++ )
+     {    vec<int> o;
+          e.Orbit( reps[j], o );
+          vec< std::pair<int,int> > m;
+          for ( int l = 0; l < o.isize( ); l++ )
+               m.append( x[ o[l] ] );
+          UniqueSort(m);
+          z.push_back(m);    }
+     Sort(z);
+     y = z;    }
+
+} // end of anonymous namespace
+
+int main( )
+{    int fails = 0;
+     const int K = 5;
+     for ( int it = 0; it < 200; it++ )
+     {
+          // A random graph, sparse enough that neighborhoods don't cover it.
+
+          const int nv = 2 + randomx( ) % ( it < 100 ? 20 : 2000 );
+          const int ne = 1 + randomx( ) % ( 3 * nv / 2 );
+          HyperBasevector hb(K);
+          hb.AddVertices(nv);
+          for ( int e = 0; e < ne; e++ )
+               hb.AddEdge( randomx( ) % nv, randomx( ) % nv, bvec(K) );
+          vec<int> to_left, to_right;
+          hb.ToLeft(to_left), hb.ToRight(to_right);
+
+          const int radius = 1 + randomx( ) % 3;
+          vec< vec<int> > n( ne );
+          for ( int e = 0; e < ne; e++ )
+          {    n[e] = Nhood( hb, to_left, to_right, e, radius );
+               if ( n[e] != OldNhood( hb, to_left, to_right, e, radius ) )
+               {    std::cout << "neighborhoods differ, iteration " << it
+                         << ", edge " << e << std::endl;
+                    fails++;
+                    break;    }    }
+
+          // Random clusters of one to three links.
+
+          vec< vec< std::pair<int,int> > > xs( randomx( ) % ( 2 * ne + 1 ) );
+          for ( auto& x : xs )
+          {    int m = 1 + randomx( ) % 3;
+               for ( int j = 0; j < m; j++ )
+                    x.push( randomx( ) % ne, randomx( ) % ne );
+               Sort(x);    }
+          vec< vec< std::pair<int,int> > > ys, old_ys;
+          MergeClusters( xs, ys, n, ne );
+          OldMergeClusters( xs, old_ys, n, ne );
+          if ( ys != old_ys )
+          {    std::cout << "clusters differ, iteration " << it << std::endl;
+               fails++;    }    }
+     if ( fails > 0 ) return 1;
+     std::cout << "neighborhoods and clusters agree" << std::endl;
+     return 0;    }